@@ -144,6 +144,7 @@ typedef struct PyConfig {
     int tracemalloc;
     int import_time;
     int no_debug_ranges;
+    int specialization_stats;
     int show_ref_count;
     int dump_refs;
     wchar_t *dump_refs_file;
@@ -168,6 +168,13 @@ struct _ts {
     _PyStackChunk *datastack_chunk;
     PyObject **datastack_top;
     PyObject **datastack_limit;
+
+    /* GIL statistics of this thread: total time spent waiting for the GIL
+       in take_gil() and holding it, in nanoseconds (a _PyTime_t), and
+       number of times it released it because of a drop request. */
+    int64_t gil_wait_time;
+    int64_t gil_hold_time;
+    uint64_t gil_forced_drops;
     /* XXX signal handlers should also be here */
 
 };
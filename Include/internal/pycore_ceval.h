@@ -34,6 +34,11 @@ PyAPI_FUNC(void) _PyEval_SetCoroutineOriginTrackingDepth(
 
 void _PyEval_Fini(void);
 
+/* Sampled dynamic execution profile, see sys._setdxpsampling() */
+extern int _PyEval_SetDXPSampling(int interval);
+extern PyObject *_PyEval_GetDXPSamples(void);
+extern void _PyEval_FiniDXPSampling(PyInterpreterState *interp);
+
 
 extern PyObject* _PyEval_GetBuiltins(PyThreadState *tstate);
 extern PyObject *_PyEval_BuiltinsFromGlobals(
@@ -66,6 +71,10 @@ extern void _PyEval_FiniGIL(PyInterpreterState *interp);
 
 extern void _PyEval_ReleaseLock(PyThreadState *tstate);
 
+extern void _PyEval_SetSwitchPolicy(int policy);
+extern int _PyEval_GetSwitchPolicy(void);
+extern PyObject *_PyEval_GetGILStats(PyThreadState *tstate);
+
 extern void _PyEval_DeactivateOpCache(void);
 
 
@@ -10,7 +10,9 @@ extern "C" {
 
 typedef struct {
     int32_t cache_count;
-    int32_t _; /* Force 8 byte size */
+    /* Number of specialization misses in this code object, only counted
+       while specialization stats are enabled. Also forces 8 byte size. */
+    uint32_t miss_count;
 } _PyEntryZero;
 
 typedef struct {
@@ -42,6 +44,15 @@ typedef struct {
     uint16_t defaults_len;
 } _PyCallCache;
 
+/* Maximum number of keyword arguments handled by the specialized
+ * CALL_FUNCTION_KW and CALL_METHOD_KW instructions */
+#define KWCALL_MAX_KEYWORDS 8
+
+typedef struct {
+    /* Index into localsplus of the parameter bound by each keyword */
+    uint8_t slots[KWCALL_MAX_KEYWORDS];
+} _PyKwCallCache;
+
 /* Add specialized versions of entries to this union.
  *
  * Do not break the invariant: sizeof(SpecializedCacheEntry) == 8
@@ -59,6 +70,7 @@ typedef union {
     _PyLoadGlobalCache load_global;
     _PyObjectCache obj;
     _PyCallCache call;
+    _PyKwCallCache kwcall;
 } SpecializedCacheEntry;
 
 #define INSTRUCTIONS_PER_ENTRY (sizeof(SpecializedCacheEntry)/sizeof(_Py_CODEUNIT))
@@ -270,25 +282,25 @@ int _Py_Specialize_LoadMethod(PyObject *owner, _Py_CODEUNIT *instr, PyObject *na
 int _Py_Specialize_BinarySubscr(PyObject *sub, PyObject *container, _Py_CODEUNIT *instr, SpecializedCacheEntry *cache);
 int _Py_Specialize_StoreSubscr(PyObject *container, PyObject *sub, _Py_CODEUNIT *instr);
 int _Py_Specialize_CallFunction(PyObject *callable, _Py_CODEUNIT *instr, int nargs, SpecializedCacheEntry *cache, PyObject *builtins);
+int _Py_Specialize_CallMethod(PyObject *meth, _Py_CODEUNIT *instr, int nargs, SpecializedCacheEntry *cache);
+int _Py_Specialize_CallFunctionKw(PyObject *callable, PyObject *kwnames, _Py_CODEUNIT *instr, int nargs, SpecializedCacheEntry *cache, PyObject *consts);
+int _Py_Specialize_CallMethodKw(PyObject *meth, PyObject *self, PyObject *kwnames, _Py_CODEUNIT *instr, int nargs, SpecializedCacheEntry *cache, PyObject *consts);
 void _Py_Specialize_BinaryOp(PyObject *lhs, PyObject *rhs, _Py_CODEUNIT *instr,
                              SpecializedCacheEntry *cache);
-
-#define PRINT_SPECIALIZATION_STATS 0
-#define PRINT_SPECIALIZATION_STATS_DETAILED 0
+void _Py_Specialize_CompareOp(PyObject *lhs, PyObject *rhs, _Py_CODEUNIT *instr,
+                              SpecializedCacheEntry *cache);
+void _Py_Specialize_ForIter(PyObject *iter, _Py_CODEUNIT *instr,
+                            SpecializedCacheEntry *cache);
+void _Py_Specialize_UnpackSequence(PyObject *seq, _Py_CODEUNIT *instr,
+                                   SpecializedCacheEntry *cache);
+
+/* Specialization stats are always compiled in, but only collected while
+ * _Py_SpecializationStatsEnabled is set: by "-X specialization_stats",
+ * PYTHONSPECIALIZATIONSTATS or _opcode.set_specialization_stats(). */
 #define PRINT_SPECIALIZATION_STATS_TO_FILE 0
 
-#ifdef Py_DEBUG
-#define COLLECT_SPECIALIZATION_STATS 1
-#define COLLECT_SPECIALIZATION_STATS_DETAILED 1
-#else
-#define COLLECT_SPECIALIZATION_STATS PRINT_SPECIALIZATION_STATS
-#define COLLECT_SPECIALIZATION_STATS_DETAILED PRINT_SPECIALIZATION_STATS_DETAILED
-#endif
-
 #define SPECIALIZATION_FAILURE_KINDS 20
 
-#if COLLECT_SPECIALIZATION_STATS
-
 typedef struct _stats {
     uint64_t specialization_success;
     uint64_t specialization_failure;
@@ -297,22 +309,38 @@ typedef struct _stats {
     uint64_t miss;
     uint64_t deopt;
     uint64_t unquickened;
-#if COLLECT_SPECIALIZATION_STATS_DETAILED
     uint64_t specialization_failure_kinds[SPECIALIZATION_FAILURE_KINDS];
-#endif
 } SpecializationStats;
 
+PyAPI_DATA(int) _Py_SpecializationStatsEnabled;
 extern SpecializationStats _specialization_stats[256];
-#define STAT_INC(opname, name) _specialization_stats[opname].name++
-#define STAT_DEC(opname, name) _specialization_stats[opname].name--
+#define STAT_INC(opname, name) \
+    do { \
+        if (_Py_SpecializationStatsEnabled) { \
+            _specialization_stats[opname].name++; \
+        } \
+    } while (0)
+#define STAT_DEC(opname, name) \
+    do { \
+        if (_Py_SpecializationStatsEnabled) { \
+            _specialization_stats[opname].name--; \
+        } \
+    } while (0)
+
+/* Count a specialization miss against the code object being executed */
+#define CODE_STAT_MISS(code) \
+    do { \
+        if (_Py_SpecializationStatsEnabled) { \
+            _Py_RecordSpecializationMiss(code); \
+        } \
+    } while (0)
+
+void _Py_RecordSpecializationMiss(PyCodeObject *code);
 void _Py_PrintSpecializationStats(void);
+PyAPI_FUNC(void) _Py_ClearSpecializationStats(void);
 
 PyAPI_FUNC(PyObject*) _Py_GetSpecializationStats(void);
-
-#else
-#define STAT_INC(opname, name) ((void)0)
-#define STAT_DEC(opname, name) ((void)0)
-#endif
+PyAPI_FUNC(PyObject*) _Py_GetSpecializationHotspots(void);
 
 
 #ifdef __cplusplus
@@ -17,6 +17,13 @@ typedef struct {
     PyObject *me_value; /* This field is only meaningful for combined tables */
 } PyDictKeyEntry;
 
+/* Entry of a compact table: the hash of the key is the one cached in the
+   str object. */
+typedef struct {
+    PyObject *me_key;
+    PyObject *me_value;
+} PyDictCompactEntry;
+
 /* _Py_dict_lookup() returns index of entry which can be used like DK_ENTRIES(dk)[index].
  * -1 when no entry found, -3 when compare raises error.
  */
@@ -32,7 +39,10 @@ int _PyDict_SetItem_Take2(PyDictObject *op, PyObject *key, PyObject *value);
 typedef enum {
     DICT_KEYS_GENERAL = 0,
     DICT_KEYS_UNICODE = 1,
-    DICT_KEYS_SPLIT = 2
+    DICT_KEYS_SPLIT = 2,
+    /* Combined table of exact str keys made by dict.compact(), whose
+       entries are PyDictCompactEntry.  See dictobject.c. */
+    DICT_KEYS_COMPACT = 3
 } DictKeysKind;
 
 /* See dictobject.c for actual layout of DictKeysObject */
@@ -45,6 +55,10 @@ struct _dictkeysobject {
     /* Kind of keys */
     uint8_t dk_kind;
 
+    /* 1 if dk_ctrl follows dk_indices and the table is probed by groups of
+       slots, 0 otherwise.  See dictobject.c. */
+    uint8_t dk_grouped;
+
     /* Version number -- Reset to 0 by any modification to keys */
     uint32_t dk_version;
 
@@ -69,8 +83,12 @@ struct _dictkeysobject {
        Dynamically sized, SIZEOF_VOID_P is minimum. */
     char dk_indices[];  /* char is required to avoid strict aliasing. */
 
-    /* "PyDictKeyEntry dk_entries[dk_usable];" array follows:
-       see the DK_ENTRIES() macro */
+    /* If dk_grouped, "uint8_t dk_ctrl[dk_size];" array follows.
+
+       "PyDictKeyEntry dk_entries[dk_usable];" array follows:
+       see the DK_ENTRIES() macro.  If dk_kind is DICT_KEYS_COMPACT, it is
+       "PyDictCompactEntry dk_entries[dk_nentries];" instead, see the
+       DK_COMPACT_ENTRIES() macro. */
 };
 
 /* This must be no more than 16, for the order vector to fit in 64 bits */
@@ -97,7 +115,9 @@ struct _dictvalues {
             2 : sizeof(int32_t))
 #endif
 #define DK_ENTRIES(dk) \
-    ((PyDictKeyEntry*)(&((int8_t*)((dk)->dk_indices))[DK_SIZE(dk) * DK_IXSIZE(dk)]))
+    ((PyDictKeyEntry*)(&((int8_t*)((dk)->dk_indices))[ \
+        DK_SIZE(dk) * (DK_IXSIZE(dk) + (dk)->dk_grouped)]))
+#define DK_COMPACT_ENTRIES(dk) ((PyDictCompactEntry*)DK_ENTRIES(dk))
 
 extern uint64_t _pydict_global_version;
 
@@ -105,6 +125,11 @@ extern uint64_t _pydict_global_version;
 
 PyObject *_PyObject_MakeDictFromInstanceAttributes(PyObject *obj, PyDictValues *values);
 
+/* Advance a dict items iterator without creating the (key, value) tuple.
+ * Stores new references in *pkey and *pvalue and returns 1, returns 0 when
+ * the iterator is exhausted, or -1 with an exception set. */
+int _PyDictIter_NextItem(PyObject *iter, PyObject **pkey, PyObject **pvalue);
+
 #ifdef __cplusplus
 }
 #endif
@@ -115,8 +115,32 @@ struct gc_generation {
     int threshold; /* collection threshold */
     int count; /* count of allocations or collections of younger
                   generations */
+    int base_threshold; /* threshold set by gc.set_threshold(), which
+                           adaptive thresholds don't go below */
 };
 
+/* Phases of a collection, timed by gc_collect_main() */
+enum gc_phase {
+    GC_PHASE_REFS,          /* update_refs() and subtract_refs() */
+    GC_PHASE_UNREACHABLE,   /* move_unreachable() */
+    GC_PHASE_WEAKREFS,      /* handle_weakrefs() */
+    GC_PHASE_FINALIZE,      /* finalize_garbage() */
+    GC_PHASE_DELETE,        /* delete_garbage() */
+    GC_NUM_PHASES
+};
+
+/* Durations of collections in seconds */
+struct gc_durations {
+    /* the whole collections */
+    double total;
+    /* each phase of the collections, which don't add up to total */
+    double phases[GC_NUM_PHASES];
+};
+
+/* Collections are counted by duration in buckets of this many powers of
+   two microseconds, see gc_pause_bucket() in Modules/gcmodule.c. */
+#define GC_PAUSE_BUCKETS 24
+
 /* Running stats per generation */
 struct gc_generation_stats {
     /* total number of collections */
@@ -125,6 +149,10 @@ struct gc_generation_stats {
     Py_ssize_t collected;
     /* total number of uncollectable objects (put into gc.garbage) */
     Py_ssize_t uncollectable;
+    /* total duration of the collections */
+    struct gc_durations durations;
+    /* histogram of the durations of the collections */
+    Py_ssize_t pauses[GC_PAUSE_BUCKETS];
 };
 
 struct _gc_runtime_state {
@@ -142,6 +170,13 @@ struct _gc_runtime_state {
     /* a permanent generation which won't be collected */
     struct gc_generation permanent_generation;
     struct gc_generation_stats generation_stats[NUM_GENERATIONS];
+    /* durations of the last collection, for gc.callbacks */
+    struct gc_durations last_durations;
+    /* true if thresholds adapt to the collections, see adapt_threshold() */
+    int adaptive;
+    /* number of threads marking full collections, see
+       deduce_unreachable_parallel() in Modules/gcmodule.c */
+    int parallel;
     /* true if we are currently running the collector */
     int collecting;
     /* list of uncollectable objects */
@@ -159,6 +194,16 @@ struct _gc_runtime_state {
        collections, and are awaiting to undergo a full collection for
        the first time. */
     Py_ssize_t long_lived_pending;
+    /* Maximum duration of an automatic collection of the oldest
+       generation in seconds, or 0.0 to collect it all at once.  See
+       fill_increment() in Modules/gcmodule.c. */
+    double incremental_budget;
+    /* Number of objects of the old generation examined by increments
+       since the last full collection. */
+    Py_ssize_t incremental_swept;
+    /* Measured speed of incremental collections, in references per
+       second, or 0.0 before the first one. */
+    double incremental_rate;
 };
 
 extern void _PyGC_InitState(struct _gc_runtime_state *);
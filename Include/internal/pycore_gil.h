@@ -20,9 +20,44 @@ extern "C" {
 #undef FORCE_SWITCHING
 #define FORCE_SWITCHING
 
+/* GIL scheduling policies, see sys._setswitchpolicy(). */
+#define _Py_GIL_POLICY_INTERVAL 0
+#define _Py_GIL_POLICY_IO 1
+
+/* Number of buckets of the GIL wait time histogram: bucket 0 counts waits
+   shorter than 1 microsecond, bucket i waits in [2**(i-1), 2**i)
+   microseconds, and the last bucket longer waits. */
+#define _Py_GIL_WAIT_BUCKETS 24
+
+/* GIL contention statistics, see sys._getgilstats().  Protected by the
+   GIL mutex. */
+struct _gil_stats {
+    /* Number of times the GIL was taken after waiting for it. */
+    unsigned long long contended;
+    /* Number of drop requests: after a wait of `interval` microseconds
+       timed out, and by prioritized threads. */
+    unsigned long long timeout_requests;
+    unsigned long long priority_requests;
+    /* Number of times the GIL was released because of a drop request
+       (forced), or by a thread running a blocking call or finishing
+       (voluntary). */
+    unsigned long long forced_drops;
+    unsigned long long voluntary_drops;
+    /* Total time spent waiting for and holding the GIL (_PyTime_t). */
+    int64_t wait_time;
+    int64_t hold_time;
+    unsigned long long wait_histogram[_Py_GIL_WAIT_BUCKETS];
+};
+
 struct _gil_runtime_state {
     /* microseconds (the Python API uses seconds, though) */
     unsigned long interval;
+    /* Scheduling policy: one of the _Py_GIL_POLICY_* constants. */
+    int policy;
+    /* Number of threads returning from a blocking call which wait for
+       the GIL on prio_cond (only with _Py_GIL_POLICY_IO).  Protected by
+       the mutex. */
+    int prio_waiters;
     /* Last PyThreadState holding / having held the GIL. This helps us
        know whether anyone else was scheduled after we dropped the GIL. */
     _Py_atomic_address last_holder;
@@ -31,11 +66,18 @@ struct _gil_runtime_state {
     _Py_atomic_int locked;
     /* Number of GIL switches since the beginning. */
     unsigned long switch_number;
+    /* When the GIL was last taken (_PyTime_t), to account hold time. */
+    int64_t hold_start;
+    struct _gil_stats stats;
     /* This condition variable allows one or several threads to wait
        until the GIL is released. In addition, the mutex also protects
        the above variables. */
     PyCOND_T cond;
     PyMUTEX_T mutex;
+    /* Condition variable on which prioritized threads wait, so that
+       dropping the GIL wakes one of them rather than a thread waiting
+       on cond. */
+    PyCOND_T prio_cond;
 #ifdef FORCE_SWITCHING
     /* This condition variable helps the GIL-releasing thread wait for
        a GIL-awaiting thread to be scheduled and take the GIL. */
@@ -38,9 +38,21 @@ struct _ceval_state {
     _Py_atomic_int eval_breaker;
     /* Request for dropping the GIL */
     _Py_atomic_int gil_drop_request;
+    /* Sampled dynamic execution profile, see sys._setdxpsampling().  The
+       countdown is the number of instructions left until the next sample,
+       or 0 if sampling is disabled or paused. */
+    int dxp_sample_countdown;
+    int dxp_sample_interval;
+    int dxp_nsamples;
+    struct _dxp_sample *dxp_samples;
     struct _pending_calls pending;
+    /* The GIL of the interpreter, set by _PyEval_InitGIL(): the GIL of the
+       runtime, shared with the main interpreter, or own_gil. */
+    struct _gil_runtime_state *gil;
 #ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
-    struct _gil_runtime_state gil;
+    /* GIL of an isolated subinterpreter, so that it can run in parallel
+       with the other interpreters. */
+    struct _gil_runtime_state own_gil;
 #endif
 };
 
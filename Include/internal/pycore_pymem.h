@@ -99,6 +99,18 @@ PyAPI_DATA(struct _PyTraceMalloc_Config) _Py_tracemalloc_config;
 void *_PyObject_VirtualAlloc(size_t size);
 void _PyObject_VirtualFree(void *, size_t size);
 
+#ifdef WITH_PYMALLOC
+/* Return the occupancy of pymalloc's structures as a dict,
+ * see sys._obmalloc_stats() */
+extern PyObject *_PyObject_GetMallocStats(void);
+
+/* Hand empty pools and arenas back to the OS, see sys._obmalloc_trim() */
+extern void _PyObject_TrimMalloc(void);
+/* Set how often this is done automatically, 0 disables it.
+ * Return the previous value. */
+extern Py_ssize_t _PyObject_SetMallocTrimInterval(Py_ssize_t interval);
+#endif
+
 
 #ifdef __cplusplus
 }
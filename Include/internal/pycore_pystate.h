@@ -154,6 +154,13 @@ PyAPI_FUNC(PyThreadState *) _PyThreadState_Swap(
     struct _gilstate_runtime_state *gilstate,
     PyThreadState *newts);
 
+PyAPI_FUNC(PyThreadState *) _PyThreadState_SwapInterpreter(
+    PyThreadState *tstate,
+    int *switch_gil);
+PyAPI_FUNC(void) _PyThreadState_SwapBack(
+    PyThreadState *save_tstate,
+    int switch_gil);
+
 PyAPI_FUNC(PyStatus) _PyInterpreterState_Enable(_PyRuntimeState *runtime);
 
 #ifdef HAVE_FORK
@@ -27,9 +27,9 @@ struct _ceval_runtime_state {
        the main thread of the main interpreter can handle signals: see
        _Py_ThreadCanHandleSignals(). */
     _Py_atomic_int signals_pending;
-#ifndef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
+    /* The GIL of the main interpreter, shared by the subinterpreters which
+       don't have their own: see _PyEval_InitGIL(). */
     struct _gil_runtime_state gil;
-#endif
 };
 
 /* GIL state */
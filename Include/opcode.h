@@ -135,29 +135,52 @@ extern "C" {
 #define CALL_FUNCTION_LEN                39
 #define CALL_FUNCTION_ISINSTANCE         40
 #define CALL_FUNCTION_PY_SIMPLE          41
-#define JUMP_ABSOLUTE_QUICK              42
-#define LOAD_ATTR_ADAPTIVE               43
-#define LOAD_ATTR_INSTANCE_VALUE         44
-#define LOAD_ATTR_WITH_HINT              45
-#define LOAD_ATTR_SLOT                   46
-#define LOAD_ATTR_MODULE                 47
-#define LOAD_GLOBAL_ADAPTIVE             48
-#define LOAD_GLOBAL_MODULE               55
-#define LOAD_GLOBAL_BUILTIN              56
-#define LOAD_METHOD_ADAPTIVE             57
-#define LOAD_METHOD_CACHED               58
-#define LOAD_METHOD_CLASS                59
-#define LOAD_METHOD_MODULE               62
-#define LOAD_METHOD_NO_DICT              63
-#define STORE_ATTR_ADAPTIVE              64
-#define STORE_ATTR_INSTANCE_VALUE        65
-#define STORE_ATTR_SLOT                  66
-#define STORE_ATTR_WITH_HINT             67
-#define LOAD_FAST__LOAD_FAST             75
-#define STORE_FAST__LOAD_FAST            76
-#define LOAD_FAST__LOAD_CONST            77
-#define LOAD_CONST__LOAD_FAST            78
-#define STORE_FAST__STORE_FAST           79
+#define CALL_FUNCTION_KW_ADAPTIVE        42
+#define CALL_FUNCTION_KW_BUILTIN         43
+#define CALL_FUNCTION_KW_PY              44
+#define CALL_METHOD_ADAPTIVE             45
+#define CALL_METHOD_PY_EXACT_ARGS        46
+#define CALL_METHOD_KW_ADAPTIVE          47
+#define CALL_METHOD_KW_BUILTIN           48
+#define CALL_METHOD_KW_PY                55
+#define COMPARE_OP_ADAPTIVE              56
+#define COMPARE_OP_FLOAT_JUMP            57
+#define COMPARE_OP_INT_JUMP              58
+#define COMPARE_OP_STR_JUMP              59
+#define FOR_ITER_ADAPTIVE                62
+#define FOR_ITER_LIST                    63
+#define FOR_ITER_TUPLE                   64
+#define FOR_ITER_RANGE                   65
+#define FOR_ITER_DICT_ITEMS              66
+#define JUMP_ABSOLUTE_QUICK              67
+#define LOAD_ATTR_ADAPTIVE               75
+#define LOAD_ATTR_INSTANCE_VALUE         76
+#define LOAD_ATTR_WITH_HINT              77
+#define LOAD_ATTR_SLOT                   78
+#define LOAD_ATTR_MODULE                 79
+#define LOAD_ATTR_PROPERTY               80
+#define LOAD_ATTR_CLASS                  81
+#define LOAD_GLOBAL_ADAPTIVE             87
+#define LOAD_GLOBAL_MODULE               88
+#define LOAD_GLOBAL_BUILTIN             123
+#define LOAD_METHOD_ADAPTIVE            127
+#define LOAD_METHOD_CACHED              128
+#define LOAD_METHOD_CLASS               134
+#define LOAD_METHOD_MODULE              140
+#define LOAD_METHOD_NO_DICT             143
+#define STORE_ATTR_ADAPTIVE             150
+#define STORE_ATTR_INSTANCE_VALUE       151
+#define STORE_ATTR_SLOT                 153
+#define STORE_ATTR_WITH_HINT            154
+#define UNPACK_SEQUENCE_ADAPTIVE        158
+#define UNPACK_SEQUENCE_LIST            159
+#define UNPACK_SEQUENCE_TUPLE           167
+#define UNPACK_SEQUENCE_TWO_TUPLE       168
+#define LOAD_FAST__LOAD_FAST            169
+#define STORE_FAST__LOAD_FAST           170
+#define LOAD_FAST__LOAD_CONST           171
+#define LOAD_CONST__LOAD_FAST           172
+#define STORE_FAST__STORE_FAST          173
 #define DO_TRACING                      255
 #ifdef NEED_OPCODE_JUMP_TABLES
 static uint32_t _PyOpcode_RelativeJump[8] = {
@@ -0,0 +1,236 @@
+"""Subquadratic algorithms on huge ints, used by longobject.c.
+
+The C implementations of str(int), int(str) and divmod() use the
+schoolbook algorithms, which take time quadratic in the number of digits.
+For very large values longobject.c calls the functions below instead.
+They are divide-and-conquer algorithms whose cost is dominated by a few
+big multiplications, so they inherit the subquadratic complexity of the
+underlying multiplication (Karatsuba and Toom-3 for int, number-theoretic
+transform for libmpdec's Decimal).  At the sizes where they are used, the
+overhead of running in Python is negligible.
+
+This is a private module; do not use it directly.
+"""
+
+try:
+    import _decimal
+except ImportError:
+    _decimal = None
+
+# Inputs at or below these sizes are handed back to the C implementation,
+# which is fastest there.  Both must stay well below the cutoffs in
+# longobject.c, or the recursion would never bottom out.
+_BITLIM = 256       # for int -> Decimal, in bits
+_DIGLIM = 1000      # for int <-> str, in decimal digits
+_DIVLIM = 4000      # for divmod(), quotient size in bits
+
+# log10(2), slightly rounded up
+_LOG10_2 = 0.30102999566398125
+
+
+def _int_to_decimal(n):
+    """Convert an int to an exact Decimal (needs the _decimal module).
+
+    n is split in halves along a binary boundary, both halves are
+    converted recursively and recombined as hi * 2**w + lo using
+    Decimal arithmetic.  The powers of 2 are cached, so each one is only
+    computed once.
+    """
+    D = _decimal.Decimal
+    D2 = D(2)
+    pow2 = {}
+
+    def w2pow(w):
+        result = pow2.get(w)
+        if result is None:
+            if w <= _BITLIM:
+                result = D2 ** w
+            elif w - 1 in pow2:
+                result = pow2[w - 1] * D2
+            else:
+                w2 = w >> 1
+                result = w2pow(w2) * w2pow(w - w2)
+            pow2[w] = result
+        return result
+
+    def inner(n, w):
+        if w <= _BITLIM:
+            return D(n)
+        w2 = w >> 1
+        hi = n >> w2
+        lo = n - (hi << w2)
+        return inner(lo, w2) + inner(hi, w - w2) * w2pow(w2)
+
+    with _decimal.localcontext() as ctx:
+        ctx.prec = _decimal.MAX_PREC
+        ctx.Emax = _decimal.MAX_EMAX
+        ctx.Emin = _decimal.MIN_EMIN
+        ctx.traps[_decimal.Inexact] = True
+        if n < 0:
+            return -inner(-n, (-n).bit_length())
+        return inner(n, n.bit_length())
+
+
+def _int_to_str_divmod(n):
+    """Convert a non-negative int to a decimal str using only int ops.
+
+    Fallback for builds without _decimal: n is split with divmod() by a
+    power of 10 and both halves are converted recursively, zero padded
+    to their exact width.
+    """
+    pow10 = {}
+
+    def w10pow(w):
+        result = pow10.get(w)
+        if result is None:
+            result = pow10[w] = 10 ** w
+        return result
+
+    def inner(n, w):
+        # n < 10**w; return exactly w digits
+        if w <= _DIGLIM:
+            return str(n).zfill(w)
+        w2 = w >> 1
+        hi, lo = divmod(n, w10pow(w2))
+        return inner(hi, w - w2) + inner(lo, w2)
+
+    w = int(n.bit_length() * _LOG10_2) + 1
+    return inner(n, w).lstrip('0') or '0'
+
+
+def int_to_decimal_string(n):
+    """Asymptotically fast str(n) for an int n."""
+    if _decimal is not None:
+        return str(_int_to_decimal(n))
+    if n < 0:
+        return '-' + _int_to_str_divmod(-n)
+    return _int_to_str_divmod(n)
+
+
+def int_from_string(s):
+    """Asymptotically fast int(s, 10).
+
+    s must only contain ASCII decimal digits and single underscores
+    between them (longobject.c has already validated it).  The digit
+    string is split in halves and recombined as hi * 10**w + lo, where
+    10**w is computed as 5**w << w to keep the multiplications small.
+    """
+    s = s.replace('_', '')
+    pow5 = {}
+
+    def w5pow(w):
+        result = pow5.get(w)
+        if result is None:
+            if w <= _DIGLIM:
+                result = 5 ** w
+            elif w - 1 in pow5:
+                result = pow5[w - 1] * 5
+            else:
+                w2 = w >> 1
+                result = w5pow(w2) * w5pow(w - w2)
+            pow5[w] = result
+        return result
+
+    def inner(a, b):
+        if b - a <= _DIGLIM:
+            return int(s[a:b])
+        mid = (a + b + 1) >> 1
+        return inner(mid, b) + ((inner(a, mid) * w5pow(b - mid)) << (b - mid))
+
+    return inner(0, len(s))
+
+
+def _div2n1n(a, b, n):
+    """Divide a by b, where b has exactly n bits and 0 <= a < b << n.
+
+    This is the recursive division of Burnikel and Ziegler, "Fast
+    Recursive Division" (MPI-I-98-1-022, 1998): with b split in halves
+    b1, b2 of n/2 bits, each half of the quotient is a 3-by-2 division,
+    which in turn costs one n/2-bit recursive division and one
+    multiplication.
+    """
+    if a.bit_length() - n <= _DIVLIM:
+        return divmod(a, b)
+    pad = n & 1
+    if pad:
+        a <<= 1
+        b <<= 1
+        n += 1
+    half = n >> 1
+    mask = (1 << half) - 1
+    b1, b2 = b >> half, b & mask
+    q1, r = _div3n2n(a >> n, (a >> half) & mask, b, b1, b2, half)
+    q2, r = _div3n2n(r, a & mask, b, b1, b2, half)
+    if pad:
+        r >>= 1
+    return q1 << half | q2, r
+
+
+def _div3n2n(a12, a3, b, b1, b2, n):
+    """Divide (a12 << n) + a3 by b = (b1 << n) + b2, for _div2n1n().
+
+    The quotient is estimated from a12 // b1, which is at most 2 too
+    large since b1 has its top bit set.
+    """
+    if a12 >> n == b1:
+        q, r = (1 << n) - 1, a12 - (b1 << n) + b1
+    else:
+        q, r = _div2n1n(a12, b1, n)
+    r = (r << n | a3) - q * b2
+    while r < 0:
+        q -= 1
+        r += b
+    return q, r
+
+
+def _divmod_pos(a, b):
+    """divmod() for a >= 0 and b > 0.
+
+    Schoolbook long division in base 2**n, where b has n bits, so that
+    each step is a 2n-by-n bit division for _div2n1n().  a is cut into
+    base 2**n digits, and the quotient digits are joined, by recursive
+    halving, which keeps both linear in the number of multiplications.
+    """
+    n = b.bit_length()
+    ndigits = -(-a.bit_length() // n)
+    a_digits = [0] * ndigits
+
+    def split(x, lo, hi):
+        if lo + 1 == hi:
+            a_digits[lo] = x
+            return
+        mid = (lo + hi) >> 1
+        shift = (mid - lo) * n
+        upper = x >> shift
+        split(x - (upper << shift), lo, mid)
+        split(upper, mid, hi)
+
+    if ndigits:
+        split(a, 0, ndigits)
+
+    q_digits = [0] * ndigits
+    r = 0
+    for i in reversed(range(ndigits)):
+        q_digits[i], r = _div2n1n((r << n) + a_digits[i], b, n)
+
+    def join(lo, hi):
+        if lo + 1 == hi:
+            return q_digits[lo]
+        mid = (lo + hi) >> 1
+        return (join(mid, hi) << ((mid - lo) * n)) + join(lo, mid)
+
+    return (join(0, ndigits) if ndigits else 0), r
+
+
+def int_divmod(a, b):
+    """Asymptotically fast divmod(a, b) for ints a and b."""
+    if b == 0:
+        raise ZeroDivisionError('integer division or modulo by zero')
+    if b < 0:
+        q, r = int_divmod(-a, -b)
+        return q, -r
+    if a < 0:
+        # With ~a == -a - 1 >= 0: ~a == q*b + r gives a == ~q*b + (b + ~r).
+        q, r = _divmod_pos(~a, b)
+        return ~q, b + ~r
+    return _divmod_pos(a, b)
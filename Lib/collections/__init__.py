@@ -1167,6 +1167,9 @@ def copy(self):
         c.update(self)
         return c
 
+    def compact(self):
+        self.data.compact()
+
     @classmethod
     def fromkeys(cls, iterable, value=None):
         d = cls()
@@ -248,12 +248,31 @@ def jabs_op(name, op):
     "CALL_FUNCTION_LEN",
     "CALL_FUNCTION_ISINSTANCE",
     "CALL_FUNCTION_PY_SIMPLE",
+    "CALL_FUNCTION_KW_ADAPTIVE",
+    "CALL_FUNCTION_KW_BUILTIN",
+    "CALL_FUNCTION_KW_PY",
+    "CALL_METHOD_ADAPTIVE",
+    "CALL_METHOD_PY_EXACT_ARGS",
+    "CALL_METHOD_KW_ADAPTIVE",
+    "CALL_METHOD_KW_BUILTIN",
+    "CALL_METHOD_KW_PY",
+    "COMPARE_OP_ADAPTIVE",
+    "COMPARE_OP_FLOAT_JUMP",
+    "COMPARE_OP_INT_JUMP",
+    "COMPARE_OP_STR_JUMP",
+    "FOR_ITER_ADAPTIVE",
+    "FOR_ITER_LIST",
+    "FOR_ITER_TUPLE",
+    "FOR_ITER_RANGE",
+    "FOR_ITER_DICT_ITEMS",
     "JUMP_ABSOLUTE_QUICK",
     "LOAD_ATTR_ADAPTIVE",
     "LOAD_ATTR_INSTANCE_VALUE",
     "LOAD_ATTR_WITH_HINT",
     "LOAD_ATTR_SLOT",
     "LOAD_ATTR_MODULE",
+    "LOAD_ATTR_PROPERTY",
+    "LOAD_ATTR_CLASS",
     "LOAD_GLOBAL_ADAPTIVE",
     "LOAD_GLOBAL_MODULE",
     "LOAD_GLOBAL_BUILTIN",
@@ -266,6 +285,10 @@ def jabs_op(name, op):
     "STORE_ATTR_INSTANCE_VALUE",
     "STORE_ATTR_SLOT",
     "STORE_ATTR_WITH_HINT",
+    "UNPACK_SEQUENCE_ADAPTIVE",
+    "UNPACK_SEQUENCE_LIST",
+    "UNPACK_SEQUENCE_TUPLE",
+    "UNPACK_SEQUENCE_TWO_TUPLE",
     # Super instructions
     "LOAD_FAST__LOAD_FAST",
     "STORE_FAST__LOAD_FAST",
@@ -341,6 +341,45 @@ def reference_find(p, s):
                 self.checkequal(reference_find(p, text),
                                 text, 'find', p)
 
+    def test_find_count_short_needle(self):
+        """Cover the vectorized path for needles of up to 32 characters."""
+        def reference_find(p, s, start=0):
+            for i in range(start, len(s) - len(p) + 1):
+                if s.startswith(p, i):
+                    return i
+            return -1
+
+        def reference_count(p, s):
+            count = 0
+            i = reference_find(p, s)
+            while i >= 0:
+                count += 1
+                i = reference_find(p, s, i + len(p))
+            return count
+
+        rr = random.randrange
+        choices = random.choices
+        for _ in range(300):
+            p = ''.join(choices('abc', k=rr(1, 36)))
+            text = ''.join(choices('abc', k=rr(100)))
+            right = ''.join(choices('abc', k=rr(50)))
+            text = text[:rr(len(text) + 1)] + p + right
+            with self.subTest(p=p, text=text):
+                self.checkequal(reference_find(p, text), text, 'find', p)
+                self.checkequal(reference_find(p, text, 3),
+                                text, 'find', p, 3)
+                self.checkequal(reference_count(p, text), text, 'count', p)
+                self.checkequal(reference_count(p, text[1:-1]),
+                                text, 'count', p, 1, -1)
+
+        # Many candidates whose first and last characters match
+        for k in (1, 5, 20):
+            p = 'a' * k + 'b' + 'a' * 10
+            text = 'a' * 5000 + p + 'a' * 5000
+            self.checkequal(5000, text, 'find', p)
+            self.checkequal(1, text, 'count', p)
+            self.checkequal(0, text, 'count', p + 'a' * 5000 + 'b')
+
     def test_find_shift_table_overflow(self):
         """When the table of 8-bit shifts overflows."""
         N = 2**8 + 100
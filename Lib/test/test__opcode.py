@@ -1,5 +1,8 @@
 import dis
+import textwrap
+from test import support
 from test.support.import_helper import import_module
+from test.support.script_helper import assert_python_ok
 import unittest
 import opcode
 
@@ -91,6 +94,91 @@ def test_specialization_stats(self):
             for v in stats['load_attr']['specialization_failure_kinds']:
                 self.assertIsInstance(v, int)
 
+    def test_specialization_hotspots(self):
+        class A:
+            pass
+        class B:
+            x = 1
+        def f(objs):
+            for o in objs:
+                o.x
+        a = A()
+        a.x = 1
+
+        old = _opcode.set_specialization_stats(True)
+        try:
+            _opcode.clear_specialization_stats()
+            # The LOAD_ATTR specialized for A instances misses on B instances
+            f([a] * 100 + [B()] * 100)
+            hotspots = _opcode.get_specialization_hotspots()
+            self.assertIn(f.__code__, [code for code, _ in hotspots])
+            for code, misses in hotspots:
+                self.assertGreater(misses, 0)
+            self.assertEqual(hotspots, sorted(hotspots, key=lambda h: -h[1]))
+            self.assertGreater(
+                _opcode.get_specialization_stats()['load_attr']['miss'], 0)
+
+            _opcode.clear_specialization_stats()
+            self.assertNotIn(f.__code__,
+                             [code for code, _ in _opcode.get_specialization_hotspots()])
+        finally:
+            _opcode.set_specialization_stats(old)
+            _opcode.clear_specialization_stats()
+
+    @support.cpython_only
+    def test_specialization_hotspots_in_subinterpreter(self):
+        class A:
+            pass
+        class B:
+            x = 1
+        def f(objs):
+            for o in objs:
+                o.x
+        a = A()
+        a.x = 1
+
+        old = _opcode.set_specialization_stats(True)
+        try:
+            _opcode.clear_specialization_stats()
+            f([a] * 100 + [B()] * 100)
+            # Only the main interpreter sees or clears its hot spots.
+            ret = support.run_in_subinterp(textwrap.dedent('''
+                import _opcode
+                def g(objs):
+                    for o in objs:
+                        o.real
+                g([1] * 100 + [1.0] * 100)
+                assert _opcode.get_specialization_hotspots() == []
+                _opcode.clear_specialization_stats()
+                '''))
+            self.assertEqual(ret, 0)
+            self.assertIn(f.__code__,
+                          [code for code, _ in _opcode.get_specialization_hotspots()])
+        finally:
+            _opcode.set_specialization_stats(old)
+            _opcode.clear_specialization_stats()
+
+    def test_specialization_stats_disabled(self):
+        old = _opcode.set_specialization_stats(False)
+        try:
+            self.assertFalse(_opcode.set_specialization_stats(False))
+            _opcode.clear_specialization_stats()
+            for i in range(100):
+                len(())
+            for family in _opcode.get_specialization_stats().values():
+                self.assertEqual(family['hit'], 0)
+        finally:
+            _opcode.set_specialization_stats(old)
+
+    def test_specialization_stats_option(self):
+        code = "for i in range(100): len(())"
+        for args, env in ((('-X', 'specialization_stats'), {}),
+                          ((), {'PYTHONSPECIALIZATIONSTATS': '1'})):
+            with self.subTest(args=args, env=env):
+                res = assert_python_ok(*args, '-c', code, **env)
+                self.assertIn(b'call_function.hit', res.err)
+                self.assertIn(b'load_attr.miss', res.err)
+
 
 if __name__ == "__main__":
     unittest.main()
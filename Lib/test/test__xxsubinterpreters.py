@@ -801,6 +801,35 @@ def f():
 
         self.assertEqual(out, 'it worked!')
 
+    def test_in_threads_concurrently(self):
+        # Each interpreter takes its own GIL, if it has one, while running
+        # the script, and gives it back afterwards.
+        ids = [self.id, interpreters.create()]
+        files = []
+        threads = []
+        for id in ids:
+            script, file = _captured_script(dedent('''
+                total = 0
+                for i in range(100_000):
+                    total += i
+                print(total, end="")
+                '''))
+            files.append(file)
+            threads.append(threading.Thread(target=interpreters.run_string,
+                                            args=(id, script)))
+        for file in files:
+            self.addCleanup(file.close)
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        for file in files:
+            self.assertEqual(file.read(), str(sum(range(100_000))))
+        # The interpreters can still be used, and destroyed.
+        for id in ids:
+            interpreters.run_string(id, 'pass')
+        interpreters.destroy(ids[1])
+
     def test_create_thread(self):
         subinterp = interpreters.create(isolated=False)
         script, file = _captured_script("""
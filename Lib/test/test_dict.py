@@ -856,6 +856,240 @@ def __eq__(self, other):
         resizing = True
         d[9] = 6
 
+    def test_big_str_keys(self):
+        # Big dicts of str keys are probed by groups of slots.
+        n = 5000
+        d = {str(i): i for i in range(n)}
+        self.assertEqual([d[str(i)] for i in range(n)], list(range(n)))
+        self.assertNotIn(str(n), d)
+        for i in range(0, n, 2):
+            del d[str(i)]
+        for i in range(n):
+            self.assertEqual(str(i) in d, i % 2 == 1)
+        # Reuse the dummy slots.
+        for i in range(0, n, 4):
+            d[str(i)] = -i
+        self.assertEqual(len(d), n // 2 + n // 4)
+        self.assertEqual(d["4"], -4)
+        self.assertEqual(d.popitem(), (str(n - 4), 4 - n))
+
+        # Keys which are not exact strs, in a table made for strs.
+        class S(str):
+            pass
+        self.assertEqual(d[S("7")], 7)
+        class Colliding:
+            def __init__(self, value):
+                self.value = value
+            def __hash__(self):
+                return hash(self.value)
+            def __eq__(self, other):
+                return other == self.value
+        self.assertEqual(d[Colliding("9")], 9)
+        d[1] = "one"
+        d[Colliding(2)] = "two"
+        self.assertEqual(d[1], "one")
+        self.assertEqual(d[2], "two")
+        self.assertEqual(d["1"], 1)
+        del d[1]
+        self.assertNotIn(1, d)
+
+        c = d.copy()
+        self.assertEqual(c, d)
+        self.assertEqual(dict(d), d)
+        for key in list(d)[10:]:
+            del d[key]
+        d["x"] = "x"
+        self.assertEqual(len(d), 11)
+
+    def test_big_str_keys_mutated_by_eq(self):
+        # A comparison deletes a key matched in the same group of slots.
+        d = {str(i): i for i in range(5000)}
+        armed = False
+        class Key:
+            def __hash__(self):
+                return 12345
+            def __eq__(self, other):
+                nonlocal armed
+                if armed:
+                    armed = False
+                    del d[victim]
+                return self is other
+        first = Key()
+        victim = Key()
+        d[first] = 1
+        d[victim] = 2
+        armed = True
+        self.assertNotIn(Key(), d)
+        self.assertFalse(armed)
+        self.assertNotIn(victim, d)
+        self.assertEqual(d[first], 1)
+
+    def test_compact(self):
+        n = 5000
+        items = [(str(i), i) for i in range(n)]
+        d = dict(items)
+        d.compact()
+        self.assertEqual(list(d.items()), items)
+        self.assertEqual(list(d), [k for k, v in items])
+        self.assertEqual(list(d.values()), list(range(n)))
+        self.assertEqual(list(reversed(d.items())), items[::-1])
+        self.assertEqual([d[str(i)] for i in range(n)], list(range(n)))
+        self.assertNotIn(str(n), d)
+        class S(str):
+            pass
+        self.assertEqual(d[S("7")], 7)
+        self.assertEqual(d.copy(), d)
+        self.assertEqual(dict(d), d)
+        c = {}
+        c.update(d)
+        self.assertEqual(c, d)
+
+        # Deletions and value changes keep the dict compact.
+        for i in range(0, n, 2):
+            del d[str(i)]
+        self.assertEqual(d.popitem(), (str(n - 1), n - 1))
+        d["1"] = "one"
+        self.assertEqual(len(d), n // 2 - 1)
+        self.assertEqual(d["1"], "one")
+        self.assertEqual(list(d)[:3], ["1", "3", "5"])
+        d.compact()
+        self.assertEqual(list(d)[:3], ["1", "3", "5"])
+        self.assertEqual(d["3"], 3)
+
+        # New keys grow it back.
+        d["x"] = "x"
+        d[1] = 1
+        self.assertEqual(len(d), n // 2 + 1)
+        self.assertEqual(d["x"], "x")
+        self.assertEqual(d[1], 1)
+        self.assertEqual(d["3"], 3)
+
+        d = {i: i for i in range(n)}
+        for i in range(n - 10):
+            del d[i]
+        d.compact()
+        self.assertEqual(d, {i: i for i in range(n - 10, n)})
+        d = {str(i): i for i in range(n)}
+        for i in range(0, n, 2):
+            del d[str(i)]
+        it = reversed(d)
+        next(it)
+        d.compact()
+        self.assertRaises(RuntimeError, next, it)
+
+        # compact() renumbers the entries without changing the size, which
+        # must not go unnoticed by the iterators.
+        for key in str, int:
+            for view in dict.keys, dict.values, dict.items:
+                for order in iter, reversed:
+                    with self.subTest(key=key, view=view, order=order):
+                        d = {key(i): i for i in range(n)}
+                        for i in range(0, n, 2):
+                            del d[key(i)]
+                        it = order(view(d))
+                        for i in range(1000):
+                            next(it)
+                        d.compact()
+                        self.assertEqual(it.__length_hint__(), 0)
+                        self.assertRaises(RuntimeError, list, it)
+                        self.assertRaises(RuntimeError, next, it)
+        d = {}
+        d.compact()
+        self.assertEqual(d, {})
+
+        # Instance dicts
+        class C:
+            pass
+        obj = C()
+        for i in range(n):
+            setattr(obj, f"a{i}", i)
+        def get():
+            return obj.a1
+        def set(value):
+            obj.a1 = value
+        for i in range(100):
+            self.assertEqual(get(), 1)
+            set(1)
+        obj.__dict__.compact()
+        for i in range(100):
+            self.assertEqual(get(), 1)
+            set(1)
+
+    def test_compact_mutated_by_eq(self):
+        # A comparison deletes the keys matched after it in the same
+        # group of slots.  Such a match is likely within a few hundred
+        # tries.
+        class S(str):
+            __hash__ = str.__hash__
+            def __eq__(self, other):
+                for key in list(d):
+                    if key != other:
+                        del d[key]
+                return False
+        for i in range(500):
+            keys = [f"{i}-{j}" for j in range(2000)]
+            d = dict.fromkeys(keys)
+            d.compact()
+            self.assertNotIn(S(keys[1000]), d)
+            self.assertEqual(list(d), [keys[1000]])
+
+    @support.cpython_only
+    def test_compact_sizeof(self):
+        d = {str(i): i for i in range(5000)}
+        size = sys.getsizeof(d)
+        d.compact()
+        self.assertLess(sys.getsizeof(d), size * 0.8)
+        d = {i: i for i in range(5000)}
+        size = sys.getsizeof(d)
+        d.compact()
+        self.assertLessEqual(sys.getsizeof(d), size)
+
+    def test_presized_construction(self):
+        # dict(), dict.fromkeys() and update() of an empty dict make room
+        # for all the items at once from the length hint of the argument.
+        class Hinted:
+            def __init__(self, items, hint):
+                self.items = items
+                self.hint = hint
+            def __iter__(self):
+                return iter(self.items)
+            def __length_hint__(self):
+                return self.hint
+        pairs = [(str(i % 100), i) for i in range(2000)]
+        expected = {}
+        for k, v in pairs:
+            expected[k] = v
+        keys = [k for k, v in pairs]
+        for hint in (0, 1, 50, 2000, 10**5):
+            self.assertEqual(dict(Hinted(pairs, hint)), expected)
+            d = {}
+            d.update(Hinted(pairs, hint))
+            self.assertEqual(d, expected)
+            self.assertEqual(dict.fromkeys(Hinted(keys, hint)),
+                             dict.fromkeys(expected))
+            d = dict(Hinted(pairs, hint))
+            d["x"] = 1
+            del d["0"]
+            self.assertEqual(len(d), 100)
+        self.assertEqual(dict(zip(range(1000), range(1000, 2000)))[999], 1999)
+
+        class BadHint(Hinted):
+            def __length_hint__(self):
+                raise ZeroDivisionError
+        self.assertRaises(ZeroDivisionError, dict, BadHint(pairs, 0))
+        self.assertRaises(ZeroDivisionError, dict.fromkeys, BadHint(keys, 0))
+
+    @support.cpython_only
+    def test_presized_construction_sizeof(self):
+        class Hinted:
+            def __iter__(self):
+                return ((i % 10, i) for i in range(1000))
+            def __length_hint__(self):
+                return 10**5
+        # Many duplicate keys don't leave a big table behind.
+        self.assertLess(sys.getsizeof(dict(Hinted())),
+                        sys.getsizeof({i: i for i in range(100)}))
+
     def test_empty_presized_dict_in_freelist(self):
         # Bug #3537: if an empty but presized dict with a size larger
         # than 7 was in the freelist, it triggered an assertion failure
@@ -1575,6 +1809,31 @@ def __hash__(self):
         self.assertEqual(dict_getitem_knownhash(d, k1, hash(k1)), 1)
         self.assertRaises(Exc, dict_getitem_knownhash, d, k2, hash(k2))
 
+    # Test _PyDict_Reserve()
+    @support.cpython_only
+    def test_reserve(self):
+        _testcapi = import_helper.import_module('_testcapi')
+        dict_reserve = _testcapi.dict_reserve
+
+        d = {'a': 1}
+        size = sys.getsizeof(d)
+        dict_reserve(d, 1000)
+        self.assertGreater(sys.getsizeof(d), size)
+        self.assertEqual(d, {'a': 1})
+        size = sys.getsizeof(d)
+        for i in range(1000):
+            d[i] = i
+        self.assertEqual(sys.getsizeof(d), size)
+        self.assertEqual(len(d), 1001)
+        # There is room already
+        dict_reserve(d, 0)
+        self.assertEqual(sys.getsizeof(d), size)
+
+        # not a dict
+        self.assertRaises(SystemError, dict_reserve, [], 1)
+        # negative number of items
+        self.assertRaises(SystemError, dict_reserve, {}, -1)
+
 
 from test import mapping_tests
 
@@ -387,6 +387,7 @@ class InitConfigTests(EmbeddingTestsMixin, unittest.TestCase):
         'tracemalloc': 0,
         'import_time': 0,
         'no_debug_ranges': 0,
+        'specialization_stats': 0,
         'show_ref_count': 0,
         'dump_refs': 0,
         'malloc_stats': 0,
@@ -1,7 +1,7 @@
 import unittest
 import unittest.mock
 from test.support import (verbose, refcount_test,
-                          cpython_only)
+                          cpython_only, disable_gc)
 from test.support.import_helper import import_module
 from test.support.os_helper import temp_dir, TESTFN, unlink
 from test.support.script_helper import assert_python_ok, make_script
@@ -80,6 +80,9 @@ def __tp_del__(self):
     # been released in release mode: with NDEBUG defined.
     BUILD_WITH_NDEBUG = (not hasattr(sys, 'gettotalrefcount'))
 
+# The phases of collections timed by gc.get_stats() and gc.callbacks
+PHASES = {"refs", "unreachable", "weakrefs", "finalize", "delete"}
+
 ### Tests
 ###############################################################################
 
@@ -761,10 +764,14 @@ def test_get_stats(self):
         for st in stats:
             self.assertIsInstance(st, dict)
             self.assertEqual(set(st),
-                             {"collected", "collections", "uncollectable"})
+                             {"collected", "collections", "uncollectable",
+                              "duration", "phases"})
             self.assertGreaterEqual(st["collected"], 0)
             self.assertGreaterEqual(st["collections"], 0)
             self.assertGreaterEqual(st["uncollectable"], 0)
+            self.assertGreaterEqual(st["duration"], 0.0)
+            self.assertEqual(set(st["phases"]), PHASES)
+            self.assertLessEqual(sum(st["phases"].values()), st["duration"])
         # Check that collection counts are incremented correctly
         if gc.isenabled():
             self.addCleanup(gc.enable)
@@ -780,6 +787,26 @@ def test_get_stats(self):
         self.assertEqual(new[0]["collections"], old[0]["collections"] + 1)
         self.assertEqual(new[1]["collections"], old[1]["collections"])
         self.assertEqual(new[2]["collections"], old[2]["collections"] + 1)
+        self.assertGreater(new[2]["duration"], old[2]["duration"])
+
+    def test_get_pause_histogram(self):
+        hist = gc.get_pause_histogram()
+        self.assertEqual([limit for limit, count in hist[:3]],
+                         [1e-6, 2e-6, 4e-6])
+        self.assertEqual(hist[-1][0], float('inf'))
+        self.assertEqual(sum(count for limit, count in hist),
+                         sum(st["collections"] for st in gc.get_stats()))
+        for generation in range(3):
+            hist = gc.get_pause_histogram(generation)
+            self.assertEqual(sum(count for limit, count in hist),
+                             gc.get_stats()[generation]["collections"])
+        self.assertRaises(ValueError, gc.get_pause_histogram, 3)
+
+        old = [count for limit, count in gc.get_pause_histogram(2)]
+        gc.collect()
+        new = [count for limit, count in gc.get_pause_histogram(2)]
+        self.assertEqual(sum(new), sum(old) + 1)
+        self.assertEqual(sum(new[1:]), sum(old[1:]) + 1)
 
     def test_freeze(self):
         gc.freeze()
@@ -787,6 +814,130 @@ def test_freeze(self):
         gc.unfreeze()
         self.assertEqual(gc.get_freeze_count(), 0)
 
+    def test_incremental(self):
+        self.assertEqual(gc.get_incremental(), 0.0)
+        self.assertRaises(ValueError, gc.set_incremental, -1.0)
+        self.assertRaises(ValueError, gc.set_incremental, float('nan'))
+        self.assertRaises(TypeError, gc.set_incremental, '1')
+        self.addCleanup(gc.set_incremental, gc.get_incremental())
+        self.addCleanup(gc.set_threshold, *gc.get_threshold())
+        gc.set_incremental(0.001)
+        self.assertEqual(gc.get_incremental(), 0.001)
+
+        # Put cyclic trash in the oldest generation.  Automatic collections
+        # find it by collecting increments of the generation, while full
+        # collections are still a long way off.
+        a = C1055820(666)
+        wr = weakref.ref(a)
+        gc.collect()
+        del a
+        full = gc.get_stats()[2]["collections"]
+        self.addCleanup(gc.disable)
+        gc.enable()
+        gc.set_threshold(1, 1, 1)
+        junk = []
+        for i in range(100_000):
+            if wr() is None:
+                break
+            junk.append([])
+        self.assertIsNone(wr())
+        self.assertGreater(gc.get_stats()[2]["collections"], full)
+
+    def test_incremental_oversized_cycle(self):
+        self.addCleanup(gc.set_incremental, gc.get_incremental())
+        self.addCleanup(gc.set_threshold, *gc.get_threshold())
+        # The smallest budget makes increments as small as they can be.
+        gc.set_incremental(1e-9)
+
+        # A container too big for an increment is left to full collections,
+        # which happen once the increments swept the old generation.
+        a = C1055820(666)
+        a.junk = [a] * 10_000
+        wr = weakref.ref(a)
+        gc.collect()
+        del a
+        self.addCleanup(gc.disable)
+        gc.enable()
+        gc.set_threshold(1, 1, 1)
+        junk = []
+        for i in range(1_000_000):
+            if wr() is None:
+                break
+            junk.append([])
+        self.assertIsNone(wr())
+
+    def test_adaptive_thresholds(self):
+        self.assertFalse(gc.get_adaptive())
+        self.addCleanup(gc.set_threshold, *gc.get_threshold())
+        self.addCleanup(gc.set_adaptive, False)
+        gc.set_threshold(100, 10, 10)
+        # Collections of the oldest generation only adapt to the fraction
+        # of garbage they find, not to their duration, so explicit ones
+        # give the same thresholds on slow and fast machines.
+        with disable_gc():
+            gc.collect()
+            gc.set_adaptive(True)
+            self.assertTrue(gc.get_adaptive())
+            self.assertEqual(gc.get_threshold(), (100, 10, 10))
+
+            # Collections which find no garbage are useless.
+            for i in range(5):
+                gc.collect()
+            self.assertEqual(gc.get_threshold(), (100, 10, 160))
+
+            # Cyclic garbage makes them useful again.
+            junk = [[] for i in range(len(gc.get_objects()))]
+            for l in junk:
+                l.append(l)
+            del junk, l
+            gc.collect()
+            self.assertEqual(gc.get_threshold(), (100, 10, 80))
+
+        gc.set_adaptive(False)
+        self.assertFalse(gc.get_adaptive())
+        self.assertEqual(gc.get_threshold(), (100, 10, 10))
+
+    def test_parallel(self):
+        self.assertEqual(gc.get_parallel(), 1)
+        self.addCleanup(gc.set_parallel, 1)
+        for threads in (0, -1, 257):
+            with self.assertRaises(ValueError):
+                gc.set_parallel(threads)
+        try:
+            gc.set_parallel(4)
+        except ValueError:
+            self.skipTest("parallel collections are not supported")
+        self.assertEqual(gc.get_parallel(), 4)
+
+        # Enough objects for several blocks of work.
+        gc.collect()
+        class A:
+            pass
+        keep = []
+        refs = []
+        for i in range(100_000):
+            a = A()
+            a.a = a
+            if i % 2:
+                keep.append(a)
+            else:
+                refs.append(weakref.ref(a))
+        chain = []
+        link = chain
+        for i in range(10_000):
+            link.append([])
+            link = link[0]
+        del a, link
+        self.assertGreaterEqual(gc.collect(), 50_000)
+        self.assertTrue(all(r() is None for r in refs))
+        self.assertTrue(all(a.a is a for a in keep))
+        depth = 0
+        link = chain
+        while link:
+            link = link[0]
+            depth += 1
+        self.assertEqual(depth, 10_000)
+
     def test_get_objects(self):
         gc.collect()
         l = []
@@ -1117,6 +1268,13 @@ def test_collect(self):
             self.assertTrue("generation" in info)
             self.assertTrue("collected" in info)
             self.assertTrue("uncollectable" in info)
+            if v[1] == "stop":
+                self.assertGreater(info["duration"], 0.0)
+                self.assertEqual(set(info["phases"]), PHASES)
+                self.assertLessEqual(sum(info["phases"].values()),
+                                     info["duration"])
+            else:
+                self.assertNotIn("duration", info)
 
     def test_collect_generation(self):
         self.preclean()
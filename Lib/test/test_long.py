@@ -12,6 +12,10 @@
 BASE = 2 ** SHIFT
 MASK = BASE - 1
 KARATSUBA_CUTOFF = 70   # from longobject.c
+TOOM3_CUTOFF = 400      # from longobject.c
+DIVMOD_DC_CUTOFF_BITS = 9000    # from longobject.c
+TO_DECIMAL_DC_CUTOFF_BITS = 30000       # from longobject.c
+FROM_DECIMAL_DC_CUTOFF = 6000           # from longobject.c
 
 # Max number of base BASE digits to use in test cases.  Doubling
 # this will more than double the runtime.
@@ -204,6 +208,24 @@ def test_division(self):
         self.check_division(710031681576388032, 26769404391308)
         self.check_division(1933622614268221, 30212853348836)
 
+    def test_huge_division(self):
+        # Big enough for longobject.c to switch to the Burnikel-Ziegler
+        # division in _pylong; results are checked with multiplication.
+        digits = [DIVMOD_DC_CUTOFF_BITS // SHIFT + 2,
+                  3 * DIVMOD_DC_CUTOFF_BITS // SHIFT + 1]
+        for leny in digits:
+            for lenq in digits + [1, 5 * DIVMOD_DC_CUTOFF_BITS // SHIFT]:
+                x = self.getran(leny + lenq)
+                y = self.getran(leny)
+                self.check_division(x, y)
+                self.check_division(x, -y)
+                self.check_division(x * y, y)
+                self.check_division(x * y - 1, y)
+        # Dividends just below a multiple of a sparse divisor.
+        y = (1 << 20000) + 1
+        self.check_division(y * y - 1, y)
+        self.check_division((y << 20000) - 1, y)
+
 
 
     def test_karatsuba(self):
@@ -229,6 +251,36 @@ def test_karatsuba(self):
                          1)
                     self.assertEqual(x, y)
 
+    def test_toom3(self):
+        digits = list(range(TOOM3_CUTOFF, TOOM3_CUTOFF + 4))
+        digits.extend([TOOM3_CUTOFF * 3 // 2 + 1, TOOM3_CUTOFF * 10 + 7])
+        for adigits in digits:
+            for bdigits in digits:
+                if bdigits < adigits:
+                    continue
+                with self.subTest(adigits=adigits, bdigits=bdigits):
+                    # Products of long strings of 1 bits, see test_karatsuba.
+                    abits, bbits = adigits * SHIFT, bdigits * SHIFT
+                    a = (1 << abits) - 1
+                    b = (1 << bbits) - 1
+                    self.assertEqual(a * b, (1 << (abits + bbits)) -
+                                            (1 << abits) - (1 << bbits) + 1)
+                    self.assertEqual(a * a, (1 << (2 * abits)) -
+                                            (1 << (abits + 1)) + 1)
+                    # Random operands.  The products are checked modulo
+                    # one-digit primes, which needs no multiplication, and
+                    # then with the division, which does at these sizes.
+                    x = self.getran(adigits)
+                    y = self.getran(bdigits)
+                    p = x * y
+                    for m in (7, 8191, 32749):
+                        self.assertEqual(p % m, (x % m) * (y % m) % m)
+                    self.assertEqual(p, y * x)
+                    self.assertEqual(p // y, x)
+                    self.assertEqual(p % y, 0)
+                    self.assertEqual(x * x, (-x) * (-x))
+                    self.assertEqual(x * x // x, x)
+
     def check_bitop_identities_1(self, x):
         eq = self.assertEqual
         with self.subTest(x=x):
@@ -394,6 +446,51 @@ def __trunc__(self):
                 return 1729
         self.assertEqual(int(LongTrunc()), 1729)
 
+    def test_huge_decimal_conversion(self):
+        # Sizes on each side of the cutoffs where longobject.c switches to
+        # the divide-and-conquer algorithms in _pylong: str() switches
+        # above TO_DECIMAL_DC_CUTOFF_BITS bits, int() above
+        # FROM_DECIMAL_DC_CUTOFF decimal digits.
+        to_decimal_digits = int(TO_DECIMAL_DC_CUTOFF_BITS * math.log10(2))
+        for ndigits in (FROM_DECIMAL_DC_CUTOFF, FROM_DECIMAL_DC_CUTOFF + 1,
+                        to_decimal_digits - 5, to_decimal_digits + 5, 40000):
+            p = 10 ** (ndigits - 1)
+            self.assertEqual(str(p), '1' + '0' * (ndigits - 1))
+            self.assertEqual(str(-p - 7), '-1' + '0' * (ndigits - 2) + '7')
+            self.assertEqual(int('1' + '0' * (ndigits - 1)), p)
+            self.assertEqual(int('-' + '9' * ndigits), -10 * p + 1)
+            for n in random.randrange(p, 10 * p), -random.randrange(p, 10 * p):
+                s = str(n)
+                self.assertEqual(len(s), ndigits + (n < 0))
+                self.assertEqual(int(s), n)
+                self.assertEqual(int(s.encode()), n)
+                self.assertEqual(int('  %s\n' % s), n)
+                self.assertEqual(int(s[0] + '_'.join(s[1:]) if n < 0
+                                     else '_'.join(s)), n)
+                self.assertEqual('%d' % n, s)
+                self.assertEqual(b'%d' % n, s.encode())
+                self.assertEqual(f'<{n}>', '<%s>' % s)
+        s = '1' * 7000
+        self.assertRaises(ValueError, int, s + '__1')
+        self.assertRaises(ValueError, int, s + '_')
+        self.assertRaises(ValueError, int, s + 'x')
+
+    @support.cpython_only
+    def test_huge_decimal_conversion_small_ints(self):
+        self.assertIs(int('0' * 7000), 0)
+        self.assertIs(int('-' + '0' * 7000 + '5'), -5)
+        self.assertIs(int('0' * 7000 + '5'), 5)
+        self.assertIs(int('-' + '0' * 7000), 0)
+
+    @support.cpython_only
+    def test_pylong_without_decimal(self):
+        import _pylong
+        with support.swap_attr(_pylong, '_decimal', None):
+            for bits in 1, 10000, 100000:
+                n = random.getrandbits(bits)
+                self.assertEqual(_pylong.int_to_decimal_string(n), str(n))
+                self.assertEqual(_pylong.int_to_decimal_string(-n), str(-n))
+
     def check_float_conversion(self, n):
         # Check that int -> float conversion behaviour matches
         # that of the pure Python version above.
@@ -1,3 +1,5 @@
+import gc
+import operator
 import unittest
 
 class TestLoadAttrCache(unittest.TestCase):
@@ -21,3 +23,307 @@ def f(o):
         Descriptor.__set__ = lambda *args: None
 
         self.assertEqual(f(o), 2)
+
+
+class TestForIterSpecialization(unittest.TestCase):
+    def test_range_loop_variable_is_not_shared(self):
+        def f():
+            seen = []
+            for i in range(1000, 1100):
+                seen.append(i)
+            return seen
+
+        for _ in range(100):
+            self.assertEqual(f(), list(range(1000, 1100)))
+
+    def test_dict_items_mutated_during_iteration(self):
+        def f(d, grow):
+            total = 0
+            for k, v in d.items():
+                total += v
+                if grow:
+                    d[k + 1000] = v
+            return total
+
+        for _ in range(100):
+            self.assertEqual(f({1: 2, 3: 4}, False), 6)
+        with self.assertRaises(RuntimeError):
+            f({1: 2}, True)
+
+
+class TestCompareOpSpecialization(unittest.TestCase):
+    OPS = {
+        "<": operator.lt, "<=": operator.le, "==": operator.eq,
+        "!=": operator.ne, ">": operator.gt, ">=": operator.ge,
+    }
+
+    def make_functions(self, op):
+        # f() jumps with POP_JUMP_IF_FALSE, g() with POP_JUMP_IF_TRUE.
+        ns = {}
+        exec(f"def f(a, b):\n"
+             f"    if a {op} b:\n"
+             f"        return True\n"
+             f"    return False\n"
+             f"def g(a, b):\n"
+             f"    if not a {op} b:\n"
+             f"        return False\n"
+             f"    return True\n", ns)
+        return ns["f"], ns["g"]
+
+    def check_both_directions(self, values, ops=OPS):
+        for op in ops:
+            with self.subTest(op=op, values=values):
+                f, g = self.make_functions(op)
+                expected = self.OPS[op]
+                for _ in range(100):
+                    for a in values:
+                        for b in values:
+                            self.assertIs(f(a, b), expected(a, b))
+                            self.assertIs(g(a, b), expected(a, b))
+
+    def test_int_compare_and_jump(self):
+        self.check_both_directions([-5, -1, 0, 1, 7])
+
+    def test_float_compare_and_jump(self):
+        self.check_both_directions([-2.5, -0.0, 0.0, 1.0, 3.25])
+
+    def test_str_compare_and_jump(self):
+        self.check_both_directions(["", "a", "ab", "b"], ops=("==", "!="))
+
+    def test_type_change_after_optimization(self):
+        class Ordered:
+            def __init__(self, v):
+                self.v = v
+            def __lt__(self, other):
+                return self.v < other.v
+
+        for op in ("<", "=="):
+            with self.subTest(op=op):
+                f, g = self.make_functions(op)
+                expected = self.OPS[op]
+                for _ in range(100):
+                    self.assertIs(f(1, 2), expected(1, 2))
+                    self.assertIs(g(1, 2), expected(1, 2))
+                nan = float("nan")
+                cases = [(1.5, 2), (2, 1.5), (1.0, 1.0), (nan, nan),
+                         (2**100, 2**100 + 1), (-2**100, 1), ("a", "a"),
+                         (True, False), (Ordered(1), Ordered(2))]
+                for a, b in cases:
+                    self.assertIs(f(a, b), bool(expected(a, b)))
+                    self.assertIs(g(a, b), bool(expected(a, b)))
+                if op == "<":
+                    with self.assertRaises(TypeError):
+                        f(1, "1")
+                for _ in range(100):
+                    self.assertIs(f(2, 1), expected(2, 1))
+                    self.assertIs(g(2, 1), expected(2, 1))
+
+
+class TestUnpackSequenceSpecialization(unittest.TestCase):
+    def test_two_tuple(self):
+        def f(t):
+            a, b = t
+            return b, a
+
+        for _ in range(100):
+            self.assertEqual(f((1, 2)), (2, 1))
+        self.assertEqual(f([3, 4]), (4, 3))
+        self.assertEqual(f("xy"), ("y", "x"))
+        self.assertEqual(f(iter((5, 6))), (6, 5))
+        msg = r"too many values to unpack \(expected 2\)"
+        with self.assertRaisesRegex(ValueError, msg):
+            f((1, 2, 3))
+        msg = r"not enough values to unpack \(expected 2, got 1\)"
+        with self.assertRaisesRegex(ValueError, msg):
+            f((1,))
+        with self.assertRaises(TypeError):
+            f(None)
+        self.assertEqual(f((7, 8)), (8, 7))
+
+    def test_tuple(self):
+        def f(t):
+            a, b, c = t
+            return c, b, a
+
+        for _ in range(100):
+            self.assertEqual(f((1, 2, 3)), (3, 2, 1))
+        self.assertEqual(f([4, 5, 6]), (6, 5, 4))
+        msg = r"too many values to unpack \(expected 3\)"
+        with self.assertRaisesRegex(ValueError, msg):
+            f((1, 2, 3, 4))
+        msg = r"not enough values to unpack \(expected 3, got 2\)"
+        with self.assertRaisesRegex(ValueError, msg):
+            f((1, 2))
+        self.assertEqual(f((7, 8, 9)), (9, 8, 7))
+
+    def test_list(self):
+        def f(l):
+            a, b, c = l
+            return c, b, a
+
+        for _ in range(100):
+            self.assertEqual(f([1, 2, 3]), (3, 2, 1))
+        self.assertEqual(f((4, 5, 6)), (6, 5, 4))
+        msg = r"too many values to unpack \(expected 3\)"
+        with self.assertRaisesRegex(ValueError, msg):
+            f([1, 2, 3, 4])
+        msg = r"not enough values to unpack \(expected 3, got 0\)"
+        with self.assertRaisesRegex(ValueError, msg):
+            f([])
+        self.assertEqual(f([7, 8, 9]), (9, 8, 7))
+
+
+class TestKwCallSpecialization(unittest.TestCase):
+    def test_kwdefaults_mutated_after_optimization(self):
+        def g(a, *, b, c=3):
+            return a, b, c
+
+        def f():
+            return g(1, b=2)
+
+        for _ in range(100):
+            self.assertEqual(f(), (1, 2, 3))
+        g.__kwdefaults__['c'] = 4
+        self.assertEqual(f(), (1, 2, 4))
+        del g.__kwdefaults__['c']
+        with self.assertRaisesRegex(TypeError, "keyword-only argument: 'c'"):
+            f()
+
+    def test_defaults_changed_after_optimization(self):
+        def g(a, b=2, c=3):
+            return a, b, c
+
+        def f():
+            return g(1, c=5)
+
+        for _ in range(100):
+            self.assertEqual(f(), (1, 2, 5))
+        g.__defaults__ = (7, 8)
+        self.assertEqual(f(), (1, 7, 5))
+        g.__defaults__ = None
+        with self.assertRaises(TypeError):
+            f()
+
+    def test_method_and_function_on_same_instruction(self):
+        class C:
+            def m(self, x=0, *, y):
+                return self, x, y
+
+        def f(o):
+            return o.m(y=1)
+
+        c = C()
+        for _ in range(100):
+            self.assertEqual(f(c), (c, 0, 1))
+        c.m = lambda x=0, *, y: (None, x, y)
+        self.assertEqual(f(c), (None, 0, 1))
+
+
+class TestCallMethodSpecialization(unittest.TestCase):
+    def test_method_code_replaced_after_optimization(self):
+        class C:
+            def m(self, x):
+                return x
+
+        def f(o):
+            return o.m(1)
+
+        c = C()
+        for _ in range(100):
+            self.assertEqual(f(c), 1)
+        C.m.__code__ = (lambda self, x: x + 2).__code__
+        self.assertEqual(f(c), 3)
+        C.m = lambda self: None
+        with self.assertRaises(TypeError):
+            f(c)
+
+
+class TestLoadAttrPropertyAndClass(unittest.TestCase):
+    def test_property_getter_replaced_after_optimization(self):
+        class C:
+            @property
+            def p(self):
+                return 1
+
+        def f(o):
+            return o.p
+
+        c = C()
+        for _ in range(100):
+            self.assertEqual(f(c), 1)
+        C.p.fget.__code__ = (lambda self: 2).__code__
+        self.assertEqual(f(c), 2)
+        C.p = property(lambda self: 3)
+        self.assertEqual(f(c), 3)
+        del C.p
+        with self.assertRaises(AttributeError):
+            f(c)
+
+    def test_property_reinitialized_after_optimization(self):
+        def getter(self):
+            return 1
+
+        class C:
+            p = property(getter)
+
+        def f(o):
+            return o.p
+
+        c = C()
+        for _ in range(100):
+            self.assertEqual(f(c), 1)
+        C.__dict__['p'].__init__(lambda self: 2)
+        del getter
+        gc.collect()
+        self.assertEqual(f(c), 2)
+        C.__dict__['p'].__init__(None)
+        with self.assertRaises(AttributeError):
+            f(c)
+
+    def test_property_getter_raises(self):
+        class C:
+            @property
+            def p(self):
+                raise KeyError(self)
+
+        def f(o):
+            return o.p
+
+        for _ in range(100):
+            c = C()
+            with self.assertRaises(KeyError) as cm:
+                f(c)
+            self.assertIs(cm.exception.args[0], c)
+
+    def test_class_attribute_changed_after_optimization(self):
+        class C:
+            x = 1
+
+        class D(C):
+            pass
+
+        def f(cls):
+            return cls.x
+
+        for _ in range(100):
+            self.assertEqual(f(D), 1)
+        C.x = 2
+        self.assertEqual(f(D), 2)
+        D.x = 3
+        self.assertEqual(f(D), 3)
+        self.assertEqual(f(C), 2)
+
+    def test_metaclass_attribute_added_after_optimization(self):
+        class Meta(type):
+            pass
+
+        class C(metaclass=Meta):
+            x = 1
+
+        def f(cls):
+            return cls.x
+
+        for _ in range(100):
+            self.assertEqual(f(C), 1)
+        Meta.x = property(lambda cls: 2)
+        self.assertEqual(f(C), 2)
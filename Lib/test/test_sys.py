@@ -15,6 +15,8 @@
 from test.support import threading_helper
 from test.support import import_helper
 import textwrap
+import threading
+import time
 import unittest
 import warnings
 
@@ -206,6 +208,113 @@ def test_switchinterval(self):
         finally:
             sys.setswitchinterval(orig)
 
+    def test_switchpolicy(self):
+        self.assertRaises(TypeError, sys._setswitchpolicy)
+        self.assertRaises(TypeError, sys._setswitchpolicy, 1)
+        self.assertRaises(ValueError, sys._setswitchpolicy, "fifo")
+        orig = sys._getswitchpolicy()
+        self.assertEqual(orig, "interval")
+        try:
+            for policy in "io", "interval", "io":
+                sys._setswitchpolicy(policy)
+                self.assertEqual(sys._getswitchpolicy(), policy)
+        finally:
+            sys._setswitchpolicy(orig)
+
+    @threading_helper.reap_threads
+    def test_switchpolicy_threads(self):
+        # Threads blocking on I/O and CPU-bound threads make progress
+        # with every policy.
+        orig = sys._getswitchpolicy()
+        self.addCleanup(sys._setswitchpolicy, orig)
+        for policy in "interval", "io":
+            with self.subTest(policy=policy):
+                sys._setswitchpolicy(policy)
+                done = threading.Event()
+                counts = [0, 0]
+                def cpu():
+                    while not done.is_set():
+                        counts[0] += 1
+                def io():
+                    for i in range(20):
+                        time.sleep(0.0001)
+                        counts[1] += 1
+                threads = [threading.Thread(target=cpu),
+                           threading.Thread(target=io)]
+                with threading_helper.start_threads(threads[:1]):
+                    threads[1].start()
+                    threads[1].join()
+                    done.set()
+                self.assertGreater(counts[0], 0)
+                self.assertEqual(counts[1], 20)
+
+    @threading_helper.reap_threads
+    def test_getgilwaittime(self):
+        self.assertIsInstance(sys._getgilwaittime(), float)
+        result = []
+        done = threading.Event()
+        def cpu():
+            while not done.is_set():
+                pass
+        def waiter():
+            before = sys._getgilwaittime()
+            deadline = time.monotonic() + 0.1
+            while time.monotonic() < deadline:
+                pass
+            result.append(sys._getgilwaittime() - before)
+        old_interval = sys.getswitchinterval()
+        self.addCleanup(sys.setswitchinterval, old_interval)
+        sys.setswitchinterval(1e-4)
+        t = threading.Thread(target=cpu)
+        with threading_helper.start_threads([t]):
+            w = threading.Thread(target=waiter)
+            w.start()
+            w.join()
+            done.set()
+        # The waiting thread had to wait for the CPU-bound one.
+        self.assertGreater(result[0], 0.0)
+
+    @threading_helper.reap_threads
+    def test_getgilstats(self):
+        keys = {'switches', 'contended', 'timeout_requests',
+                'priority_requests', 'forced_drops', 'voluntary_drops',
+                'wait_time', 'hold_time', 'wait_histogram', 'thread'}
+        before = sys._getgilstats()
+        self.assertEqual(set(before), keys)
+        self.assertEqual(set(before['thread']),
+                         {'wait_time', 'hold_time', 'forced_drops'})
+        self.assertEqual(sum(before['wait_histogram']), before['contended'])
+
+        old_interval = sys.getswitchinterval()
+        self.addCleanup(sys.setswitchinterval, old_interval)
+        sys.setswitchinterval(1e-4)
+        thread_stats = []
+        def cpu():
+            deadline = time.monotonic() + 0.1
+            while time.monotonic() < deadline:
+                pass
+            thread_stats.append(sys._getgilstats()['thread'])
+        threads = [threading.Thread(target=cpu) for i in range(2)]
+        with threading_helper.start_threads(threads):
+            pass
+        after = sys._getgilstats()
+
+        for key in keys - {'wait_histogram', 'thread'}:
+            self.assertGreaterEqual(after[key], before[key], key)
+        # The two threads had to take turns.
+        self.assertGreater(after['switches'], before['switches'])
+        self.assertGreater(after['contended'], before['contended'])
+        self.assertGreater(after['timeout_requests'],
+                           before['timeout_requests'])
+        self.assertGreater(after['forced_drops'], before['forced_drops'])
+        self.assertGreater(after['wait_time'], before['wait_time'])
+        self.assertEqual(sum(after['wait_histogram']), after['contended'])
+        self.assertGreater(after['hold_time'] - before['hold_time'],
+                           sum(t['hold_time'] for t in thread_stats))
+        for t in thread_stats:
+            self.assertGreater(t['hold_time'], 0.0)
+        self.assertTrue(any(t['forced_drops'] for t in thread_stats))
+
     def test_recursionlimit(self):
         self.assertRaises(TypeError, sys.getrecursionlimit, 42)
         oldlimit = sys.getrecursionlimit()
@@ -841,6 +950,74 @@ def test_debugmallocstats(self):
         # The function has no parameter
         self.assertRaises(TypeError, sys._debugmallocstats, True)
 
+    def test_obmalloc_stats(self):
+        stats = sys._obmalloc_stats()
+        if stats is None:
+            self.skipTest("pymalloc is not in use")
+        self.assertGreater(stats['arenas'], 0)
+        self.assertEqual(len(stats['arena_usage']),
+                         stats['arena_size'] // stats['pool_size'] + 1)
+        self.assertEqual(sum(stats['arena_usage']), stats['arenas'])
+        self.assertEqual(stats['arenas'],
+                         stats['arenas_allocated_total'] -
+                         stats['arenas_reclaimed'])
+        self.assertLessEqual(stats['arenas'], stats['arenas_highwater'])
+        total = sum(stats[key] for key in (
+            'allocated_bytes', 'available_bytes', 'free_pool_bytes',
+            'pool_header_bytes', 'quantization_bytes',
+            'arena_alignment_bytes'))
+        self.assertEqual(total, stats['arenas'] * stats['arena_size'])
+
+        allocated = 0
+        for size_class in stats['size_classes']:
+            self.assertGreater(size_class['pools'], 0)
+            self.assertLessEqual(size_class['full_pools'], size_class['pools'])
+            self.assertLessEqual(size_class['size'],
+                                 stats['small_block_threshold'])
+            allocated += size_class['blocks'] * size_class['size']
+        self.assertEqual(allocated, stats['allocated_bytes'])
+
+        # Allocating many small objects shows up in the stats
+        def blocks():
+            return sum(size_class['blocks']
+                       for size_class in sys._obmalloc_stats()['size_classes'])
+        before = blocks()
+        floats = [float(i) for i in range(10_000)]
+        self.assertGreaterEqual(blocks() - before, 10_000)
+        del floats
+
+    def test_obmalloc_trim(self):
+        if sys._obmalloc_stats() is None:
+            self.skipTest("pymalloc is not in use")
+        old_interval = sys._set_obmalloc_trim_interval(0)
+        self.addCleanup(sys._set_obmalloc_trim_interval, old_interval)
+        self.assertEqual(sys._set_obmalloc_trim_interval(100), 0)
+        self.assertEqual(sys._obmalloc_stats()['trim_interval'], 100)
+        self.assertEqual(sys._set_obmalloc_trim_interval(0), 100)
+        self.assertRaises(ValueError, sys._set_obmalloc_trim_interval, -1)
+
+        # Leave a few objects in many pools, so that the arenas stay
+        # allocated but most of their pools are empty
+        floats = [float(i) for i in range(200_000)]
+        kept = floats[::2000]
+        del floats
+        sys._obmalloc_trim()
+        stats = sys._obmalloc_stats()
+        self.assertLessEqual(stats['trimmed_pools'], stats['free_pools'])
+        if sys.platform == 'linux':
+            self.assertGreater(stats['trimmed_pools'], 0)
+        total = sum(stats[key] for key in (
+            'allocated_bytes', 'available_bytes', 'free_pool_bytes',
+            'pool_header_bytes', 'quantization_bytes',
+            'arena_alignment_bytes'))
+        self.assertEqual(total, stats['arenas'] * stats['arena_size'])
+
+        # Trimmed pools can be used again
+        floats = [float(i) for i in range(200_000)]
+        self.assertEqual(sum(floats), sum(range(200_000)))
+        self.assertEqual(kept, [float(i) for i in range(0, 200_000, 2000)])
+        del floats
+
     @unittest.skipUnless(hasattr(sys, "getallocatedblocks"),
                          "sys.getallocatedblocks unavailable on this build")
     def test_getallocatedblocks(self):
@@ -882,6 +1059,62 @@ def test_getallocatedblocks(self):
         c = sys.getallocatedblocks()
         self.assertIn(c, range(b - 50, b + 50))
 
+    def test_dxp_sampling(self):
+        def f(n):
+            total = 0
+            for i in range(n):
+                total += i
+            return total
+
+        sys._getdxpsamples()
+        old = sys._setdxpsampling(3)
+        try:
+            self.assertEqual(sys._setdxpsampling(5), 3)
+            f(1000)
+        finally:
+            self.assertEqual(sys._setdxpsampling(old), 5)
+        samples = sys._getdxpsamples()
+        self.assertTrue(samples)
+        for code, prev_op, op in samples:
+            self.assertIsInstance(code, type(f.__code__))
+            self.assertIn(prev_op, range(256))
+            self.assertIn(op, range(256))
+        self.assertIn(f.__code__, [code for code, _, _ in samples])
+        if not old:
+            self.assertEqual(sys._getdxpsamples(), [])
+        self.assertRaises(ValueError, sys._setdxpsampling, -1)
+
+    def test_dxp_sampling_buffer_is_bounded(self):
+        sys._getdxpsamples()
+        old = sys._setdxpsampling(1)
+        try:
+            for i in range(100_000):
+                pass
+            samples = sys._getdxpsamples()
+            # Draining the full buffer resumes sampling.
+            for i in range(100):
+                pass
+        finally:
+            sys._setdxpsampling(old)
+        self.assertGreater(len(samples), 0)
+        self.assertLess(len(samples), 100_000)
+        self.assertTrue(sys._getdxpsamples())
+
+    def test_dxp_sampling_per_interpreter(self):
+        sys._getdxpsamples()
+        # The subinterpreter exits with samples left in its buffer.
+        code = textwrap.dedent("""
+            import sys
+            sys._setdxpsampling(1)
+            for i in range(100):
+                pass
+            assert sys._getdxpsamples()
+            for i in range(100):
+                pass
+        """)
+        self.assertEqual(support.run_in_subinterp(code), 0)
+        self.assertEqual(sys._getdxpsamples(), [])
+
     def test_is_finalizing(self):
         self.assertIs(sys.is_finalizing(), False)
         # Don't use the atexit module because _Py_Finalizing is only set
@@ -1287,13 +1520,13 @@ def inner():
         # dictionary-itemview
         check({}.items(), size('P'))
         # dictionary iterator
-        check(iter({}), size('P2nPn'))
+        check(iter({}), size('PnPnPn'))
         # dictionary-keyiterator
-        check(iter({}.keys()), size('P2nPn'))
+        check(iter({}.keys()), size('PnPnPn'))
         # dictionary-valueiterator
-        check(iter({}.values()), size('P2nPn'))
+        check(iter({}.values()), size('PnPnPn'))
         # dictionary-itemiterator
-        check(iter({}.items()), size('P2nPn'))
+        check(iter({}.items()), size('PnPnPn'))
         # dictproxy
         class C(object): pass
         check(C.__dict__, size('P'))
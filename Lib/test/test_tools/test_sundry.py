@@ -51,11 +51,36 @@ def test_sundry_windows(self):
             import_tool(name)
 
     def test_analyze_dxp_import(self):
-        if hasattr(sys, 'getdxp'):
-            import_tool('analyze_dxp')
-        else:
+        analyze_dxp = import_tool('analyze_dxp')
+        if not hasattr(sys, 'getdxp'):
             with self.assertRaises(RuntimeError):
-                import_tool('analyze_dxp')
+                analyze_dxp.snapshot_profile()
+
+    def test_analyze_dxp_sampling(self):
+        analyze_dxp = import_tool('analyze_dxp')
+        def f(n):
+            total = 0
+            for i in range(n):
+                total += i
+            return total
+        analyze_dxp.reset_samples()
+        analyze_dxp.start_sampling(7)
+        try:
+            f(10000)
+        finally:
+            analyze_dxp.stop_sampling()
+        code_profile = analyze_dxp.sampled_code_profile()
+        self.assertIn(f.__code__, code_profile)
+        hot = analyze_dxp.hot_code_objects(code_profile)
+        self.assertIs(hot[0][0], f.__code__)
+        names = {name for _, name, _ in analyze_dxp.common_instructions(
+                    analyze_dxp.sampled_profile(code_profile))}
+        self.assertIn('FOR_ITER_RANGE', names)
+        report = analyze_dxp.render_sampled_profile(code_profile)
+        self.assertIn('Most common pairs:', report)
+        self.assertIn(f.__code__.co_qualname, report)
+        analyze_dxp.reset_samples()
+        self.assertEqual(analyze_dxp.sampled_code_profile(), {})
 
 
 if __name__ == '__main__':
@@ -221,6 +221,9 @@ def test_find(self):
         self.checkequal(100, 'a' * 100 + '\U00100304', 'find', '\U00100304')
         self.checkequal(-1, 'a' * 100 + '\U00100304', 'find', '\U00100204')
         self.checkequal(-1, 'a' * 100 + '\U00100304', 'find', '\U00102004')
+        # many false positives of the memchr fast path
+        self.checkequal(100, '\u0430' * 100 + '\u0130', 'find', '\u0130')
+        self.checkequal(-1, '\u0430' * 100, 'find', '\u0130')
         # check mixed argument types
         self.checkequalnofix(0,  'abcdefghiabc', 'find', 'abc')
         self.checkequalnofix(9,  'abcdefghiabc', 'find', 'abc', 1)
@@ -252,6 +255,9 @@ def test_rfind(self):
         self.checkequal(0, '\U00100304' + 'a' * 100, 'rfind', '\U00100304')
         self.checkequal(-1, '\U00100304' + 'a' * 100, 'rfind', '\U00100204')
         self.checkequal(-1, '\U00100304' + 'a' * 100, 'rfind', '\U00102004')
+        # many false positives of the memrchr fast path
+        self.checkequal(0, '\u0130' + '\u0430' * 100, 'rfind', '\u0130')
+        self.checkequal(-1, '\u0430' * 100, 'rfind', '\u0130')
         # check mixed argument types
         self.checkequalnofix(9,   'abcdefghiabc', 'rfind', 'abc')
         self.checkequalnofix(12,  'abcdefghiabc', 'rfind', '')
@@ -1736,6 +1742,37 @@ def test_codecs_utf8(self):
         # * strict decoding testing for all of the
         #   UTF8_ERROR cases in PyUnicode_DecodeUTF8
 
+    def test_utf8_encode_long_mixed(self):
+        # Long strings of each kind, which are encoded in blocks of
+        # characters; single characters are encoded one at a time.
+        def encode_chars(s, errors='strict'):
+            return b''.join(c.encode('utf-8', errors) for c in s)
+
+        pools = ['abc', '\x80\xe9\xff', '\u0416\u07ff',
+                 '\u0800\u4e2d\uffff', '\U0001F600\U0010FFFF']
+        for kind_pool in ('\xe9', '\u4e2d', '\U0001F600'):
+            for i, p1 in enumerate(pools):
+                for p2 in pools[:i + 1]:
+                    chars = p1 + p2 + kind_pool
+                    for n in (8, 9, 15, 16, 17, 31, 40):
+                        s = ''.join(chars[(k * 7) % len(chars)] * (k % 3 + 1)
+                                    for k in range(n))
+                        with self.subTest(s=s):
+                            self.assertEqual(s.encode('utf-8'),
+                                             encode_chars(s))
+        # Surrogates are reported at the right position
+        for prefix in range(0, 20, 3):
+            for ch in ('\xe9', 'Ж', '中', '\U0001F600'):
+                s = ch * prefix + '\udc80' + 'Ж' * 10
+                with self.subTest(prefix=prefix, ch=ch):
+                    with self.assertRaises(UnicodeEncodeError) as cm:
+                        s.encode('utf-8')
+                    self.assertEqual(cm.exception.start, prefix)
+                    for errors in ('surrogatepass', 'surrogateescape',
+                                   'replace', 'backslashreplace'):
+                        self.assertEqual(s.encode('utf-8', errors),
+                                         encode_chars(s, errors))
+
     def test_utf8_decode_valid_sequences(self):
         sequences = [
             # single byte
@@ -1752,6 +1789,33 @@ def test_utf8_decode_valid_sequences(self):
         for seq, res in sequences:
             self.assertEqual(seq.decode('utf-8'), res)
 
+    def test_utf8_decode_long_mixed(self):
+        # Long inputs with ASCII runs around and between non-ASCII
+        # characters of each width, valid or not, at various offsets
+        # from a 16-byte boundary.
+        chars = ['\xe9', 'Ж', '中', '\U0001F600']
+        for prefix in range(0, 40, 3):
+            for ch in chars:
+                for ch2 in ['a'] + chars:
+                    s = 'x' * prefix + ch + 'y' * 20 + ch2 + 'z' * 17
+                    b = s.encode('utf-8')
+                    with self.subTest(prefix=prefix, ch=ch, ch2=ch2):
+                        self.assertEqual(b.decode('utf-8'), s)
+                        self.assertEqual(len(b.decode('utf-8')), len(s))
+                        for bad in b'\x80', b'\xc3', b'\xed\xa0\x80', b'\xff':
+                            nrepl = len(bad.decode('utf-8', 'replace'))
+                            self.assertEqual(
+                                (b + bad + b).decode('utf-8', 'replace'),
+                                s + '\ufffd' * nrepl + s)
+                            with self.assertRaises(UnicodeDecodeError) as cm:
+                                (b + bad).decode('utf-8')
+                            self.assertEqual(cm.exception.start, len(b))
+                        # Incremental decoding, cut in the middle of ch2
+                        # when it is not ASCII
+                        n2 = len(ch2.encode('utf-8'))
+                        t = b[:-18]
+                        self.assertEqual(codecs.utf_8_decode(t, None),
+                                         (s[:-18], len(t) - n2 + 1))
 
     def test_utf8_decode_invalid_sequences(self):
         # continuation bytes in a sequence of 2, 3, or 4 bytes
@@ -85,17 +85,69 @@ static PyObject *
 _opcode_get_specialization_stats_impl(PyObject *module)
 /*[clinic end generated code: output=fcbc32fdfbec5c17 input=e1f60db68d8ce5f6]*/
 {
-#if COLLECT_SPECIALIZATION_STATS
     return _Py_GetSpecializationStats();
-#else
+}
+
+/*[clinic input]
+
+_opcode.set_specialization_stats -> bool
+
+  enabled: bool
+  /
+
+Enable or disable the collection of the specialization stats.
+
+Return whether they were being collected before.
+[clinic start generated code]*/
+
+static int
+_opcode_set_specialization_stats_impl(PyObject *module, int enabled)
+/*[clinic end generated code: output=26e55c665cd2ad2c input=b5cf3c89487d33f3]*/
+{
+    int previous = _Py_SpecializationStatsEnabled;
+    _Py_SpecializationStatsEnabled = enabled;
+    return previous;
+}
+
+/*[clinic input]
+
+_opcode.clear_specialization_stats
+
+Reset the specialization stats and hot spots
+[clinic start generated code]*/
+
+static PyObject *
+_opcode_clear_specialization_stats_impl(PyObject *module)
+/*[clinic end generated code: output=456e44684028f8bf input=8b4d0543e8255ca5]*/
+{
+    _Py_ClearSpecializationStats();
     Py_RETURN_NONE;
-#endif
+}
+
+/*[clinic input]
+
+_opcode.get_specialization_hotspots
+
+Return the code objects with specialization misses
+
+Return a list of (code, misses) pairs, with the most misses first.
+Only code objects of the main interpreter are reported.
+[clinic start generated code]*/
+
+static PyObject *
+_opcode_get_specialization_hotspots_impl(PyObject *module)
+/*[clinic end generated code: output=50a7b2f6b423c01c input=536fa5ababdad112]*/
+{
+    return _Py_GetSpecializationHotspots();
 }
 
 static PyMethodDef
 opcode_functions[] =  {
     _OPCODE_STACK_EFFECT_METHODDEF
     _OPCODE_GET_SPECIALIZATION_STATS_METHODDEF
+    _OPCODE_SET_SPECIALIZATION_STATS_METHODDEF
+    _OPCODE_CLEAR_SPECIALIZATION_STATS_METHODDEF
+    _OPCODE_GET_SPECIALIZATION_HOTSPOTS_METHODDEF
     {NULL, NULL, 0, NULL}
 };
 
@@ -337,6 +337,21 @@ dict_getitem_knownhash(PyObject *self, PyObject *args)
     return result;
 }
 
+static PyObject*
+dict_reserve(PyObject *self, PyObject *args)
+{
+    PyObject *mp;
+    Py_ssize_t n;
+
+    if (!PyArg_ParseTuple(args, "On:dict_reserve", &mp, &n)) {
+        return NULL;
+    }
+    if (_PyDict_Reserve(mp, n) < 0) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
 /* Issue #4701: Check that PyObject_Hash implicitly calls
  *   PyType_Ready if it hasn't already been called
  */
@@ -5895,6 +5910,7 @@ static PyMethodDef TestMethods[] = {
     {"test_list_api",           test_list_api,                   METH_NOARGS},
     {"test_dict_iteration",     test_dict_iteration,             METH_NOARGS},
     {"dict_getitem_knownhash",  dict_getitem_knownhash,          METH_VARARGS},
+    {"dict_reserve",            dict_reserve,                    METH_VARARGS},
     {"test_lazy_hash_inheritance",      test_lazy_hash_inheritance,METH_NOARGS},
     {"test_long_api",           test_long_api,                   METH_NOARGS},
     {"test_xincref_doesnt_leak",test_xincref_doesnt_leak,        METH_NOARGS},
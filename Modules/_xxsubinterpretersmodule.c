@@ -8,6 +8,7 @@
 #include "Python.h"
 #include "frameobject.h"
 #include "pycore_frame.h"
+#include "pycore_interp.h"        // PyInterpreterState.ceval
 #include "pycore_pystate.h"       // _PyThreadState_GET()
 #include "pycore_interpreteridobject.h"
 
@@ -1935,27 +1936,14 @@ _run_script_in_interpreter(PyInterpreterState *interp, const char *codestr,
         return -1;
     }
 
-#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
-    // Switch to interpreter.
-    PyThreadState *new_tstate = PyInterpreterState_ThreadHead(interp);
-    PyThreadState *save1 = PyEval_SaveThread();
-
-    (void)PyThreadState_Swap(new_tstate);
-
-    // Run the script.
-    _sharedexception *exc = NULL;
-    int result = _run_script(interp, codestr, shared, &exc);
-
-    // Switch back.
-    PyEval_RestoreThread(save1);
-#else
     // Switch to interpreter.
     PyThreadState *save_tstate = NULL;
+    int switch_gil = 0;
     if (interp != PyInterpreterState_Get()) {
         // XXX Using the "head" thread isn't strictly correct.
         PyThreadState *tstate = PyInterpreterState_ThreadHead(interp);
         // XXX Possible GILState issues?
-        save_tstate = PyThreadState_Swap(tstate);
+        save_tstate = _PyThreadState_SwapInterpreter(tstate, &switch_gil);
     }
 
     // Run the script.
@@ -1964,9 +1952,8 @@ _run_script_in_interpreter(PyInterpreterState *interp, const char *codestr,
 
     // Switch back.
     if (save_tstate != NULL) {
-        PyThreadState_Swap(save_tstate);
+        _PyThreadState_SwapBack(save_tstate, switch_gil);
     }
-#endif
 
     // Propagate any exception out to the caller.
     if (exc != NULL) {
@@ -2024,6 +2011,12 @@ interp_create(PyObject *self, PyObject *args, PyObject *kwds)
     PyThreadState *save_tstate = _PyThreadState_GET();
     // XXX Possible GILState issues?
     PyThreadState *tstate = _Py_NewInterpreter(isolated);
+    if (tstate != NULL &&
+        tstate->interp->ceval.gil != save_tstate->interp->ceval.gil)
+    {
+        // Release the GIL of the new interpreter, which has its own.
+        PyEval_SaveThread();
+    }
     PyThreadState_Swap(save_tstate);
     if (tstate == NULL) {
         /* Since no new thread state was created, there is no exception to
@@ -2036,9 +2029,10 @@ interp_create(PyObject *self, PyObject *args, PyObject *kwds)
     PyObject *idobj = _PyInterpreterState_GetIDObject(interp);
     if (idobj == NULL) {
         // XXX Possible GILState issues?
-        save_tstate = PyThreadState_Swap(tstate);
+        int switch_gil;
+        save_tstate = _PyThreadState_SwapInterpreter(tstate, &switch_gil);
         Py_EndInterpreter(tstate);
-        PyThreadState_Swap(save_tstate);
+        _PyThreadState_SwapBack(save_tstate, switch_gil);
         return NULL;
     }
     _PyInterpreterState_RequireIDRef(interp, 1);
@@ -2089,9 +2083,11 @@ interp_destroy(PyObject *self, PyObject *args, PyObject *kwds)
     // Destroy the interpreter.
     PyThreadState *tstate = PyInterpreterState_ThreadHead(interp);
     // XXX Possible GILState issues?
-    PyThreadState *save_tstate = PyThreadState_Swap(tstate);
+    int switch_gil;
+    PyThreadState *save_tstate = _PyThreadState_SwapInterpreter(tstate,
+                                                               &switch_gil);
     Py_EndInterpreter(tstate);
-    PyThreadState_Swap(save_tstate);
+    _PyThreadState_SwapBack(save_tstate, switch_gil);
 
     Py_RETURN_NONE;
 }
@@ -74,4 +74,78 @@ _opcode_get_specialization_stats(PyObject *module, PyObject *Py_UNUSED(ignored))
 {
     return _opcode_get_specialization_stats_impl(module);
 }
-/*[clinic end generated code: output=1699b4b1488b49c1 input=a9049054013a1b77]*/
+
+PyDoc_STRVAR(_opcode_set_specialization_stats__doc__,
+"set_specialization_stats($module, enabled, /)\n"
+"--\n"
+"\n"
+"Enable or disable the collection of the specialization stats.\n"
+"\n"
+"Return whether they were being collected before.");
+
+#define _OPCODE_SET_SPECIALIZATION_STATS_METHODDEF    \
+    {"set_specialization_stats", (PyCFunction)_opcode_set_specialization_stats, METH_O, _opcode_set_specialization_stats__doc__},
+
+static int
+_opcode_set_specialization_stats_impl(PyObject *module, int enabled);
+
+static PyObject *
+_opcode_set_specialization_stats(PyObject *module, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    int enabled;
+    int _return_value;
+
+    enabled = PyObject_IsTrue(arg);
+    if (enabled < 0) {
+        goto exit;
+    }
+    _return_value = _opcode_set_specialization_stats_impl(module, enabled);
+    if ((_return_value == -1) && PyErr_Occurred()) {
+        goto exit;
+    }
+    return_value = PyBool_FromLong((long)_return_value);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_opcode_clear_specialization_stats__doc__,
+"clear_specialization_stats($module, /)\n"
+"--\n"
+"\n"
+"Reset the specialization stats and hot spots");
+
+#define _OPCODE_CLEAR_SPECIALIZATION_STATS_METHODDEF    \
+    {"clear_specialization_stats", (PyCFunction)_opcode_clear_specialization_stats, METH_NOARGS, _opcode_clear_specialization_stats__doc__},
+
+static PyObject *
+_opcode_clear_specialization_stats_impl(PyObject *module);
+
+static PyObject *
+_opcode_clear_specialization_stats(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    return _opcode_clear_specialization_stats_impl(module);
+}
+
+PyDoc_STRVAR(_opcode_get_specialization_hotspots__doc__,
+"get_specialization_hotspots($module, /)\n"
+"--\n"
+"\n"
+"Return the code objects with specialization misses\n"
+"\n"
+"Return a list of (code, misses) pairs, with the most misses first.\n"
+"Only code objects of the main interpreter are reported.");
+
+#define _OPCODE_GET_SPECIALIZATION_HOTSPOTS_METHODDEF    \
+    {"get_specialization_hotspots", (PyCFunction)_opcode_get_specialization_hotspots, METH_NOARGS, _opcode_get_specialization_hotspots__doc__},
+
+static PyObject *
+_opcode_get_specialization_hotspots_impl(PyObject *module);
+
+static PyObject *
+_opcode_get_specialization_hotspots(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    return _opcode_get_specialization_hotspots_impl(module);
+}
+/*[clinic end generated code: output=24aa6f9baa50da97 input=a9049054013a1b77]*/
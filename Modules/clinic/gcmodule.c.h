@@ -202,6 +202,192 @@ gc_get_threshold(PyObject *module, PyObject *Py_UNUSED(ignored))
     return gc_get_threshold_impl(module);
 }
 
+PyDoc_STRVAR(gc_set_incremental__doc__,
+"set_incremental($module, budget, /)\n"
+"--\n"
+"\n"
+"Collect the oldest generation incrementally.\n"
+"\n"
+"Automatic collections of the oldest generation are split into increments\n"
+"taking about budget seconds each.  A budget of 0 makes them collect the\n"
+"whole generation at once again.");
+
+#define GC_SET_INCREMENTAL_METHODDEF    \
+    {"set_incremental", (PyCFunction)gc_set_incremental, METH_O, gc_set_incremental__doc__},
+
+static PyObject *
+gc_set_incremental_impl(PyObject *module, double budget);
+
+static PyObject *
+gc_set_incremental(PyObject *module, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    double budget;
+
+    if (PyFloat_CheckExact(arg)) {
+        budget = PyFloat_AS_DOUBLE(arg);
+    }
+    else
+    {
+        budget = PyFloat_AsDouble(arg);
+        if (budget == -1.0 && PyErr_Occurred()) {
+            goto exit;
+        }
+    }
+    return_value = gc_set_incremental_impl(module, budget);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(gc_get_incremental__doc__,
+"get_incremental($module, /)\n"
+"--\n"
+"\n"
+"Return the pause budget of incremental collections, or 0.0 if disabled.");
+
+#define GC_GET_INCREMENTAL_METHODDEF    \
+    {"get_incremental", (PyCFunction)gc_get_incremental, METH_NOARGS, gc_get_incremental__doc__},
+
+static double
+gc_get_incremental_impl(PyObject *module);
+
+static PyObject *
+gc_get_incremental(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    PyObject *return_value = NULL;
+    double _return_value;
+
+    _return_value = gc_get_incremental_impl(module);
+    if ((_return_value == -1.0) && PyErr_Occurred()) {
+        goto exit;
+    }
+    return_value = PyFloat_FromDouble(_return_value);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(gc_set_adaptive__doc__,
+"set_adaptive($module, flag, /)\n"
+"--\n"
+"\n"
+"Make the collection thresholds adapt to the collections.\n"
+"\n"
+"The threshold of a generation is raised while its collections find little\n"
+"garbage, and lowered when they find a lot, or take too long.  They stay\n"
+"between the thresholds set by set_threshold() and 16 times these.\n"
+"get_threshold() returns the current thresholds.");
+
+#define GC_SET_ADAPTIVE_METHODDEF    \
+    {"set_adaptive", (PyCFunction)gc_set_adaptive, METH_O, gc_set_adaptive__doc__},
+
+static PyObject *
+gc_set_adaptive_impl(PyObject *module, int flag);
+
+static PyObject *
+gc_set_adaptive(PyObject *module, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    int flag;
+
+    flag = PyObject_IsTrue(arg);
+    if (flag < 0) {
+        goto exit;
+    }
+    return_value = gc_set_adaptive_impl(module, flag);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(gc_get_adaptive__doc__,
+"get_adaptive($module, /)\n"
+"--\n"
+"\n"
+"Return True if the collection thresholds adapt to the collections.");
+
+#define GC_GET_ADAPTIVE_METHODDEF    \
+    {"get_adaptive", (PyCFunction)gc_get_adaptive, METH_NOARGS, gc_get_adaptive__doc__},
+
+static int
+gc_get_adaptive_impl(PyObject *module);
+
+static PyObject *
+gc_get_adaptive(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    PyObject *return_value = NULL;
+    int _return_value;
+
+    _return_value = gc_get_adaptive_impl(module);
+    if ((_return_value == -1) && PyErr_Occurred()) {
+        goto exit;
+    }
+    return_value = PyBool_FromLong((long)_return_value);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(gc_set_parallel__doc__,
+"set_parallel($module, threads, /)\n"
+"--\n"
+"\n"
+"Set the number of threads marking the objects in full collections.\n"
+"\n"
+"With more than one thread, the reachable objects of full collections are\n"
+"found in parallel.  The thread which runs the collection is one of them.");
+
+#define GC_SET_PARALLEL_METHODDEF    \
+    {"set_parallel", (PyCFunction)gc_set_parallel, METH_O, gc_set_parallel__doc__},
+
+static PyObject *
+gc_set_parallel_impl(PyObject *module, int threads);
+
+static PyObject *
+gc_set_parallel(PyObject *module, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    int threads;
+
+    threads = _PyLong_AsInt(arg);
+    if (threads == -1 && PyErr_Occurred()) {
+        goto exit;
+    }
+    return_value = gc_set_parallel_impl(module, threads);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(gc_get_parallel__doc__,
+"get_parallel($module, /)\n"
+"--\n"
+"\n"
+"Return the number of threads marking the objects in full collections.");
+
+#define GC_GET_PARALLEL_METHODDEF    \
+    {"get_parallel", (PyCFunction)gc_get_parallel, METH_NOARGS, gc_get_parallel__doc__},
+
+static int
+gc_get_parallel_impl(PyObject *module);
+
+static PyObject *
+gc_get_parallel(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    PyObject *return_value = NULL;
+    int _return_value;
+
+    _return_value = gc_get_parallel_impl(module);
+    if ((_return_value == -1) && PyErr_Occurred()) {
+        goto exit;
+    }
+    return_value = PyLong_FromLong((long)_return_value);
+
+exit:
+    return return_value;
+}
+
 PyDoc_STRVAR(gc_get_count__doc__,
 "get_count($module, /)\n"
 "--\n"
@@ -283,6 +469,54 @@ gc_get_stats(PyObject *module, PyObject *Py_UNUSED(ignored))
     return gc_get_stats_impl(module);
 }
 
+PyDoc_STRVAR(gc_get_pause_histogram__doc__,
+"get_pause_histogram($module, /, generation=None)\n"
+"--\n"
+"\n"
+"Return a histogram of the durations of the collections.\n"
+"\n"
+"  generation\n"
+"    Generation whose collections to count.\n"
+"\n"
+"The result is a list of (limit, count) tuples, where count is the number\n"
+"of collections shorter than limit seconds which weren\'t counted in the\n"
+"previous tuple.  The limits are powers of two microseconds, the last one\n"
+"is infinity.  If generation is None, count the collections of all\n"
+"generations.");
+
+#define GC_GET_PAUSE_HISTOGRAM_METHODDEF    \
+    {"get_pause_histogram", (PyCFunction)(void(*)(void))gc_get_pause_histogram, METH_FASTCALL|METH_KEYWORDS, gc_get_pause_histogram__doc__},
+
+static PyObject *
+gc_get_pause_histogram_impl(PyObject *module, Py_ssize_t generation);
+
+static PyObject *
+gc_get_pause_histogram(PyObject *module, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames)
+{
+    PyObject *return_value = NULL;
+    static const char * const _keywords[] = {"generation", NULL};
+    static _PyArg_Parser _parser = {NULL, _keywords, "get_pause_histogram", 0};
+    PyObject *argsbuf[1];
+    Py_ssize_t noptargs = nargs + (kwnames ? PyTuple_GET_SIZE(kwnames) : 0) - 0;
+    Py_ssize_t generation = -1;
+
+    args = _PyArg_UnpackKeywords(args, nargs, NULL, kwnames, &_parser, 0, 1, 0, argsbuf);
+    if (!args) {
+        goto exit;
+    }
+    if (!noptargs) {
+        goto skip_optional_pos;
+    }
+    if (!_Py_convert_optional_to_ssize_t(args[0], &generation)) {
+        goto exit;
+    }
+skip_optional_pos:
+    return_value = gc_get_pause_histogram_impl(module, generation);
+
+exit:
+    return return_value;
+}
+
 PyDoc_STRVAR(gc_is_tracked__doc__,
 "is_tracked($module, obj, /)\n"
 "--\n"
@@ -372,4 +606,4 @@ gc_get_freeze_count(PyObject *module, PyObject *Py_UNUSED(ignored))
 exit:
     return return_value;
 }
-/*[clinic end generated code: output=61e15f3a549f3ab5 input=a9049054013a1b77]*/
+/*[clinic end generated code: output=0c7e70c96c8d145c input=a9049054013a1b77]*/
@@ -44,6 +44,13 @@ module gc
 #  define GC_DEBUG
 #endif
 
+#ifdef HAVE_BUILTIN_ATOMIC
+#  include "pycore_condvar.h"     // PyMUTEX_T, PyCOND_T
+#  ifdef _POSIX_THREADS
+#    define GC_PARALLEL
+#  endif
+#endif
+
 #define GC_NEXT _PyGCHead_NEXT
 #define GC_PREV _PyGCHead_PREV
 
@@ -150,6 +157,7 @@ _PyGC_InitState(GCState *gcstate)
     };
     for (int i = 0; i < NUM_GENERATIONS; i++) {
         gcstate->generations[i] = generations[i];
+        gcstate->generations[i].base_threshold = generations[i].threshold;
     };
     gcstate->generation0 = GEN_HEAD(gcstate, 0);
     struct gc_generation permanent_generation = {
@@ -157,6 +165,7 @@ _PyGC_InitState(GCState *gcstate)
            (uintptr_t)&gcstate->permanent_generation.head}, 0, 0
     };
     gcstate->permanent_generation = permanent_generation;
+    gcstate->parallel = 1;
 }
 
 
@@ -1092,9 +1101,13 @@ IMPORTANT: This function leaves 'unreachable' with the NEXT_MASK_UNREACHABLE
 flag set but it does not clear it to skip unnecessary iteration. Before the
 flag is cleared (for example, by using 'clear_unreachable_mask' function or
 by a call to 'move_legacy_finalizers'), the 'unreachable' list is not a normal
-list and we can not use most gc_list_* functions for it. */
+list and we can not use most gc_list_* functions for it.
+
+If refs_done is not NULL, it is set to the time when the adjusted reference
+counts were computed, to time the phases of the collection. */
 static inline void
-deduce_unreachable(PyGC_Head *base, PyGC_Head *unreachable) {
+deduce_unreachable(PyGC_Head *base, PyGC_Head *unreachable,
+                   _PyTime_t *refs_done) {
     validate_list(base, collecting_clear_unreachable_clear);
     /* Using ob_refcnt and gc_refs, calculate which objects in the
      * container set are reachable from outside the set (i.e., have a
@@ -1103,6 +1116,9 @@ deduce_unreachable(PyGC_Head *base, PyGC_Head *unreachable) {
      */
     update_refs(base);  // gc_prev is used for gc_refs
     subtract_refs(base);
+    if (refs_done != NULL) {
+        *refs_done = _PyTime_GetPerfCounter();
+    }
 
     /* Leave everything reachable from outside base in base, and move
      * everything else (in base) to unreachable.
@@ -1170,19 +1186,693 @@ handle_resurrected_objects(PyGC_Head *unreachable, PyGC_Head* still_unreachable,
     // have the PREV_MARK_COLLECTING set, but the objects are going to be
     // removed so we can skip the expense of clearing the flag.
     PyGC_Head* resurrected = unreachable;
-    deduce_unreachable(resurrected, still_unreachable);
+    deduce_unreachable(resurrected, still_unreachable, NULL);
     clear_unreachable_mask(still_unreachable);
 
     // Move the resurrected objects to the old generation for future collection.
     gc_list_merge(resurrected, old_generation);
 }
 
+/* Parallel marking.
+
+Full collections of big heaps can spread the work of subtract_refs() and
+move_unreachable() over several threads, see gc.set_parallel().  This
+thread keeps holding the GIL, so the world is stopped, and the worker
+threads only call tp_traverse, which doesn't touch reference counts or
+run Python code.
+
+update_refs() cuts the list in blocks of PARALLEL_BLOCK_SIZE objects while
+it walks it.  Then:
+
+1. The workers take blocks in turn and subtract the internal references,
+   decrementing gc_refs atomically since the same object can be referred to
+   from several blocks.
+
+2. The objects which still have gc_refs > 0 are referred to from outside,
+   so they are the roots of the marking.  The workers take blocks in turn
+   and mark the objects reachable from the roots of their block, using the
+   NEXT_MASK_UNREACHABLE bit of _gc_next as a mark bit: the thread which sets
+   it traverses the object, with a stack of its own.  Idle workers get
+   objects from the stacks of the busy ones, through a shared stack.
+
+3. This thread walks the list once more and moves the unmarked objects to
+   unreachable, leaving the list in the state move_unreachable() does.
+
+If a stack can't grow, the object stays marked but untraversed, and
+mark_overflowed() finishes the marking serially.  If anything else fails,
+the collection proceeds serially.
+*/
+
+#ifdef GC_PARALLEL
+
+#define PARALLEL_BLOCK_SIZE 4096
+/* Heaps of fewer blocks are collected serially. */
+#define PARALLEL_MIN_BLOCKS 16
+/* Busy workers share their stack when it's bigger than this. */
+#define PARALLEL_SHARE_SIZE 1024
+#define PARALLEL_MARK ((uintptr_t)NEXT_MASK_UNREACHABLE)
+
+struct mark_stack {
+    PyGC_Head **items;
+    Py_ssize_t size;
+    Py_ssize_t allocated;
+};
+
+struct parallel_state {
+    PyGC_Head *young;
+    PyGC_Head **blocks;
+    Py_ssize_t nblocks;
+    Py_ssize_t next_block;      /* next block to take, atomic */
+    void (*work)(struct parallel_state *, struct mark_stack *);
+    int overflow;               /* a stack couldn't grow, atomic */
+    /* The following are protected by mutex */
+    PyMUTEX_T mutex;
+    PyCOND_T cond;
+    int nworkers;
+    int running;                /* # worker threads which haven't returned */
+    int idle;                   /* # workers waiting for shared */
+    int done;
+    struct mark_stack shared;
+};
+
+static int
+mark_stack_push(struct mark_stack *stack, PyGC_Head *gc)
+{
+    if (stack->size == stack->allocated) {
+        Py_ssize_t allocated = Py_MAX(stack->allocated * 2, 256);
+        PyGC_Head **items = PyMem_RawRealloc(stack->items,
+                                             allocated * sizeof(*items));
+        if (items == NULL) {
+            return -1;
+        }
+        stack->items = items;
+        stack->allocated = allocated;
+    }
+    stack->items[stack->size++] = gc;
+    return 0;
+}
+
+static inline PyGC_Head *
+block_next(PyGC_Head *gc)
+{
+    uintptr_t next = __atomic_load_n(&gc->_gc_next, __ATOMIC_RELAXED);
+    return (PyGC_Head *)(next & ~PARALLEL_MARK);
+}
+
+/* Return the first object of the next block to process, and set *end to the
+ * object after its last one, or return NULL if there are no blocks left.
+ */
+static PyGC_Head *
+take_block(struct parallel_state *state, PyGC_Head **end)
+{
+    Py_ssize_t i = __atomic_fetch_add(&state->next_block, 1,
+                                      __ATOMIC_RELAXED);
+    if (i >= state->nblocks) {
+        return NULL;
+    }
+    *end = (i + 1 < state->nblocks) ? state->blocks[i + 1] : state->young;
+    return state->blocks[i];
+}
+
+/* A traversal callback for subtract_refs_worker(), see visit_decref(). */
+static int
+visit_decref_atomic(PyObject *op, void *parent)
+{
+    _PyObject_ASSERT(_PyObject_CAST(parent), !_PyObject_IsFreed(op));
+
+    if (_PyObject_IS_GC(op)) {
+        PyGC_Head *gc = AS_GC(op);
+        // Only the bits of gc_refs change during this phase.
+        if (gc_is_collecting(gc)) {
+            __atomic_fetch_sub(&gc->_gc_prev,
+                               (uintptr_t)1 << _PyGC_PREV_SHIFT,
+                               __ATOMIC_RELAXED);
+        }
+    }
+    return 0;
+}
+
+static void
+subtract_refs_worker(struct parallel_state *state, struct mark_stack *stack)
+{
+    PyGC_Head *gc, *end;
+    while ((gc = take_block(state, &end)) != NULL) {
+        for (; gc != end; gc = GC_NEXT(gc)) {
+            PyObject *op = FROM_GC(gc);
+            (void) Py_TYPE(op)->tp_traverse(op, visit_decref_atomic, op);
+        }
+    }
+}
+
+/* Set the mark bit of gc.  Return 1 if this thread set it. */
+static inline int
+try_mark(PyGC_Head *gc)
+{
+    if (__atomic_load_n(&gc->_gc_next, __ATOMIC_RELAXED) & PARALLEL_MARK) {
+        return 0;
+    }
+    uintptr_t next = __atomic_fetch_or(&gc->_gc_next, PARALLEL_MARK,
+                                       __ATOMIC_RELAXED);
+    return !(next & PARALLEL_MARK);
+}
+
+struct mark_visitor {
+    struct parallel_state *state;
+    struct mark_stack *stack;
+};
+
+/* A traversal callback for mark_worker(), see visit_reachable(). */
+static int
+visit_mark(PyObject *op, struct mark_visitor *visitor)
+{
+    if (!_PyObject_IS_GC(op)) {
+        return 0;
+    }
+    PyGC_Head *gc = AS_GC(op);
+    if (gc_is_collecting(gc) && try_mark(gc)) {
+        if (mark_stack_push(visitor->stack, gc) < 0) {
+            __atomic_store_n(&visitor->state->overflow, 1, __ATOMIC_RELAXED);
+        }
+    }
+    return 0;
+}
+
+/* Move half of stack to the shared stack, for the idle workers. */
+static void
+share_work(struct parallel_state *state, struct mark_stack *stack)
+{
+    pthread_mutex_lock(&state->mutex);
+    Py_ssize_t n = stack->size / 2;
+    while (n > 0 && mark_stack_push(&state->shared,
+                                    stack->items[stack->size - 1]) == 0) {
+        stack->size--;
+        n--;
+    }
+    pthread_cond_broadcast(&state->cond);
+    pthread_mutex_unlock(&state->mutex);
+}
+
+/* Wait until there is shared work, and move some of it to stack.  Return 0
+ * if the marking is done.
+ */
+static int
+get_shared_work(struct parallel_state *state, struct mark_stack *stack)
+{
+    pthread_mutex_lock(&state->mutex);
+    state->idle++;
+    while (state->shared.size == 0 && !state->done) {
+        if (state->idle == state->nworkers) {
+            state->done = 1;
+            pthread_cond_broadcast(&state->cond);
+            break;
+        }
+        pthread_cond_wait(&state->cond, &state->mutex);
+    }
+    if (state->done) {
+        pthread_mutex_unlock(&state->mutex);
+        return 0;
+    }
+    state->idle--;
+    Py_ssize_t n = Py_MIN(state->shared.size, PARALLEL_SHARE_SIZE);
+    while (n > 0 && mark_stack_push(stack, state->shared.items[
+                                        state->shared.size - 1]) == 0) {
+        state->shared.size--;
+        n--;
+    }
+    pthread_mutex_unlock(&state->mutex);
+    return 1;
+}
+
+static void
+mark_worker(struct parallel_state *state, struct mark_stack *stack)
+{
+    struct mark_visitor visitor = {state, stack};
+    PyGC_Head *gc, *end;
+    do {
+        if ((gc = take_block(state, &end)) != NULL) {
+            for (; gc != end; gc = block_next(gc)) {
+                if (gc_get_refs(gc) > 0 && try_mark(gc)) {
+                    if (mark_stack_push(stack, gc) < 0) {
+                        __atomic_store_n(&state->overflow, 1,
+                                         __ATOMIC_RELAXED);
+                    }
+                }
+            }
+        }
+        while (stack->size > 0) {
+            gc = stack->items[--stack->size];
+            PyObject *op = FROM_GC(gc);
+            (void) Py_TYPE(op)->tp_traverse(op, (visitproc)visit_mark,
+                                            &visitor);
+            if (stack->size > PARALLEL_SHARE_SIZE
+                && __atomic_load_n(&state->idle, __ATOMIC_RELAXED) > 0)
+            {
+                share_work(state, stack);
+            }
+        }
+    } while (__atomic_load_n(&state->next_block, __ATOMIC_RELAXED)
+                 < state->nblocks
+             || get_shared_work(state, stack));
+}
+
+static void
+parallel_worker_main(void *arg)
+{
+    struct parallel_state *state = (struct parallel_state *)arg;
+    struct mark_stack stack = {NULL, 0, 0};
+    state->work(state, &stack);
+    PyMem_RawFree(stack.items);
+    pthread_mutex_lock(&state->mutex);
+    state->running--;
+    pthread_cond_broadcast(&state->cond);
+    pthread_mutex_unlock(&state->mutex);
+}
+
+/* Run work in nthreads threads, including this one. */
+static void
+run_parallel(struct parallel_state *state, int nthreads,
+             void (*work)(struct parallel_state *, struct mark_stack *))
+{
+    state->work = work;
+    state->next_block = 0;
+    state->nworkers = nthreads;
+    state->running = 0;
+    state->idle = 0;
+    state->done = 0;
+    for (int i = 1; i < nthreads; i++) {
+        pthread_mutex_lock(&state->mutex);
+        state->running++;
+        pthread_mutex_unlock(&state->mutex);
+        if (PyThread_start_new_thread(parallel_worker_main, state)
+            == PYTHREAD_INVALID_THREAD_ID)
+        {
+            pthread_mutex_lock(&state->mutex);
+            state->running--;
+            state->nworkers -= nthreads - i;
+            pthread_cond_broadcast(&state->cond);
+            pthread_mutex_unlock(&state->mutex);
+            break;
+        }
+    }
+
+    struct mark_stack stack = {NULL, 0, 0};
+    work(state, &stack);
+    PyMem_RawFree(stack.items);
+
+    pthread_mutex_lock(&state->mutex);
+    while (state->running > 0) {
+        pthread_cond_wait(&state->cond, &state->mutex);
+    }
+    pthread_mutex_unlock(&state->mutex);
+}
+
+/* A traversal callback for mark_overflowed(). */
+static int
+visit_mark_overflowed(PyObject *op, int *changed)
+{
+    if (_PyObject_IS_GC(op)) {
+        PyGC_Head *gc = AS_GC(op);
+        if (gc_is_collecting(gc) && !(gc->_gc_next & PARALLEL_MARK)) {
+            gc->_gc_next |= PARALLEL_MARK;
+            *changed = 1;
+        }
+    }
+    return 0;
+}
+
+/* Mark the objects reachable from the marked ones, without a stack. */
+static void
+mark_overflowed(PyGC_Head *young)
+{
+    int changed;
+    do {
+        changed = 0;
+        for (PyGC_Head *gc = block_next(young); gc != young;
+             gc = block_next(gc))
+        {
+            if (gc->_gc_next & PARALLEL_MARK) {
+                PyObject *op = FROM_GC(gc);
+                (void) Py_TYPE(op)->tp_traverse(
+                    op, (visitproc)visit_mark_overflowed, &changed);
+            }
+        }
+    } while (changed);
+}
+
+/* Move the unmarked objects of young to unreachable, see move_unreachable().
+ */
+static void
+move_unmarked(PyGC_Head *young, PyGC_Head *unreachable)
+{
+    PyGC_Head *prev = young;
+    PyGC_Head *gc = GC_NEXT(young);
+    while (gc != young) {
+        PyGC_Head *next = block_next(gc);
+        if (gc->_gc_next & PARALLEL_MARK) {
+            prev->_gc_next = (uintptr_t)gc;
+            _PyGCHead_SET_PREV(gc, prev);
+            gc_clear_collecting(gc);
+            prev = gc;
+        }
+        else {
+            PyGC_Head *last = GC_PREV(unreachable);
+            last->_gc_next = (NEXT_MASK_UNREACHABLE | (uintptr_t)gc);
+            _PyGCHead_SET_PREV(gc, last);
+            gc->_gc_next = (NEXT_MASK_UNREACHABLE | (uintptr_t)unreachable);
+            unreachable->_gc_prev = (uintptr_t)gc;
+        }
+        gc = next;
+    }
+    prev->_gc_next = (uintptr_t)young;
+    young->_gc_prev = (uintptr_t)prev;
+    unreachable->_gc_next &= ~NEXT_MASK_UNREACHABLE;
+}
+
+/* Like update_refs(), and return the first objects of blocks of
+ * PARALLEL_BLOCK_SIZE objects in *blocks, or -1 if out of memory.
+ */
+static Py_ssize_t
+update_refs_blocks(PyGC_Head *containers, PyGC_Head ***blocks)
+{
+    Py_ssize_t n = 0, nblocks = 0, allocated = 0;
+    int error = 0;
+    *blocks = NULL;
+    for (PyGC_Head *gc = GC_NEXT(containers); gc != containers;
+         gc = GC_NEXT(gc), n++)
+    {
+        gc_reset_refs(gc, Py_REFCNT(FROM_GC(gc)));
+        _PyObject_ASSERT(FROM_GC(gc), gc_get_refs(gc) != 0);
+        if (n % PARALLEL_BLOCK_SIZE || error) {
+            continue;
+        }
+        if (nblocks == allocated) {
+            allocated = Py_MAX(allocated * 2, PARALLEL_MIN_BLOCKS);
+            PyGC_Head **items = PyMem_RawRealloc(*blocks,
+                                                 allocated * sizeof(*items));
+            if (items == NULL) {
+                error = 1;
+                continue;
+            }
+            *blocks = items;
+        }
+        (*blocks)[nblocks++] = gc;
+    }
+    if (error) {
+        PyMem_RawFree(*blocks);
+        *blocks = NULL;
+        return -1;
+    }
+    return nblocks;
+}
+
+/* Like deduce_unreachable(), with nthreads threads. */
+static void
+deduce_unreachable_parallel(PyGC_Head *base, PyGC_Head *unreachable,
+                            int nthreads, _PyTime_t *refs_done)
+{
+    validate_list(base, collecting_clear_unreachable_clear);
+    struct parallel_state state = {.young = base};
+    state.nblocks = update_refs_blocks(base, &state.blocks);
+    if (state.nblocks < PARALLEL_MIN_BLOCKS
+        || pthread_mutex_init(&state.mutex, NULL))
+    {
+        goto serial;
+    }
+    if (pthread_cond_init(&state.cond, NULL)) {
+        pthread_mutex_destroy(&state.mutex);
+        goto serial;
+    }
+
+    run_parallel(&state, nthreads, subtract_refs_worker);
+    *refs_done = _PyTime_GetPerfCounter();
+    run_parallel(&state, nthreads, mark_worker);
+    if (state.overflow) {
+        mark_overflowed(base);
+    }
+    gc_list_init(unreachable);
+    move_unmarked(base, unreachable);
+
+    PyMem_RawFree(state.shared.items);
+    pthread_cond_destroy(&state.cond);
+    pthread_mutex_destroy(&state.mutex);
+    PyMem_RawFree(state.blocks);
+    validate_list(base, collecting_clear_unreachable_clear);
+    validate_list(unreachable, collecting_set_unreachable_set);
+    return;
+
+serial:
+    PyMem_RawFree(state.blocks);
+    subtract_refs(base);
+    *refs_done = _PyTime_GetPerfCounter();
+    gc_list_init(unreachable);
+    move_unreachable(base, unreachable);
+    validate_list(base, collecting_clear_unreachable_clear);
+    validate_list(unreachable, collecting_set_unreachable_set);
+}
+
+#endif /* GC_PARALLEL */
+
+/* Incremental collection of the oldest generation.
+
+A full collection examines every tracked object, so its pause grows with the
+size of the heap.  If gc.set_incremental() gave a pause budget, automatic
+collections of the oldest generation only examine an increment of it.  The
+young generations are always part of the increment, and fill_increment()
+adds the oldest objects of the old generation (the head of its list), then
+the objects of the old generation that the increment refers to, as long as
+the increment fits in the budget.  The survivors are put at the end of the
+list, so that successive increments sweep the whole old generation.
+
+No write barrier is needed:  like a collection of a young generation, an
+increment treats all references from outside of it as roots, so it can only
+miss garbage, never free live objects.  Following references makes the
+increment include whole garbage cycles, as long as they are small enough:
+cycles that don't fit in an increment, and containers too big for one, are
+left to full collections.  Those still happen when gc.collect() is called,
+once the increments have swept as many objects as the old generation holds,
+and when the objects which weren't examined since the last full collection
+reach the size of the old generation (instead of 25% of it without
+increments), see gc_collect_generations().
+
+Objects in the permanent generation (see gc.freeze()) can't be told apart
+from objects in the old generation here, so references aren't followed if
+there are any.
+
+The size of an increment is the number of references it holds, estimated by
+increment_cost(), since that is what the collection walks.  It is derived from
+the budget and from the speed of the previous increments.
+*/
+
+/* Increments always examine this many references of the old generation, so
+ * that they make progress. */
+#define INCREMENT_MIN_SIZE 1000
+
+struct increment_state {
+    PyGC_Head *increment;
+    Py_ssize_t cost;     /* cost of the old objects moved so far */
+    Py_ssize_t limit;
+    Py_ssize_t n_moved;  /* # old objects moved so far */
+};
+
+/* Estimate the work to examine op, as the number of references tp_traverse
+ * visits, when it's cheap to tell.
+ */
+static Py_ssize_t
+increment_cost(PyObject *op)
+{
+    if (PyList_Check(op) || PyTuple_Check(op)) {
+        return 1 + Py_SIZE(op);
+    }
+    if (PyDict_Check(op)) {
+        return 1 + 2 * PyDict_GET_SIZE(op);
+    }
+    if (PyAnySet_Check(op)) {
+        return 1 + PySet_GET_SIZE(op);
+    }
+    return 1;
+}
+
+/* A traversal callback for fill_increment. */
+static int
+visit_increment(PyObject *op, struct increment_state *state)
+{
+    if (state->cost >= state->limit || !_PyObject_IS_GC(op)) {
+        return 0;
+    }
+    PyGC_Head *gc = AS_GC(op);
+    // Untracked objects, and objects which are in the increment already,
+    // are skipped.  Other tracked objects are in the old generation.
+    if (gc->_gc_next != 0 && !gc_is_collecting(gc)) {
+        Py_ssize_t cost = increment_cost(op);
+        if (cost > state->limit - state->cost) {
+            return 0;
+        }
+        gc_list_move(gc, state->increment);
+        gc->_gc_prev |= PREV_MASK_COLLECTING;
+        state->cost += cost;
+        state->n_moved++;
+    }
+    return 0;
+}
+
+/* Move objects of the old generation to increment, which holds the young
+ * generations, until the cost of the increment reaches limit.  Return the
+ * cost of the increment, and set *n_old to the number of objects moved.
+ */
+static Py_ssize_t
+fill_increment(GCState *gcstate, PyGC_Head *increment, Py_ssize_t limit,
+               Py_ssize_t *n_old)
+{
+    PyGC_Head *old = GEN_HEAD(gcstate, NUM_GENERATIONS-1);
+    PyGC_Head *gc;
+    Py_ssize_t young_cost = 0;
+
+    // PREV_MASK_COLLECTING tells which objects are in the increment
+    // until deduce_unreachable() starts using it.
+    for (gc = GC_NEXT(increment); gc != increment; gc = GC_NEXT(gc)) {
+        gc->_gc_prev |= PREV_MASK_COLLECTING;
+        young_cost += increment_cost(FROM_GC(gc));
+    }
+    struct increment_state state = {
+        increment, 0, Py_MAX(limit - young_cost, INCREMENT_MIN_SIZE), 0};
+
+    /* Take half of the increment from the head of the old generation. */
+    while (state.cost < state.limit / 2 && !gc_list_is_empty(old)) {
+        gc = GC_NEXT(old);
+        Py_ssize_t cost = increment_cost(FROM_GC(gc));
+        if (cost > state.limit - state.cost) {
+            /* Too big for an increment, leave it to full collections.
+               Count it, so that the loop ends. */
+            gc_list_move(gc, old);
+            state.cost++;
+            continue;
+        }
+        gc_list_move(gc, increment);
+        gc->_gc_prev |= PREV_MASK_COLLECTING;
+        state.cost += cost;
+        state.n_moved++;
+    }
+
+    /* Fill it with the objects they refer to, breadth first. */
+    if (gc_list_is_empty(&gcstate->permanent_generation.head)) {
+        for (gc = GC_NEXT(increment);
+             gc != increment && state.cost < state.limit;
+             gc = GC_NEXT(gc))
+        {
+            PyObject *op = FROM_GC(gc);
+            (void) Py_TYPE(op)->tp_traverse(op,
+                                            (visitproc)visit_increment,
+                                            &state);
+        }
+    }
+
+    gc_list_clear_collecting(increment);
+    *n_old = state.n_moved;
+    return young_cost + state.cost;
+}
+
+/* Return the cost of the next increment, see increment_cost(). */
+static Py_ssize_t
+increment_limit(GCState *gcstate)
+{
+    double size = gcstate->incremental_budget * gcstate->incremental_rate;
+    if (size < INCREMENT_MIN_SIZE) {
+        // Includes the first increment, before the speed is known
+        return INCREMENT_MIN_SIZE;
+    }
+    if (size >= (double)PY_SSIZE_T_MAX) {
+        return PY_SSIZE_T_MAX;
+    }
+    return (Py_ssize_t)size;
+}
+
+/* Set the duration of phase to the time since *t, and *t to now. */
+static void
+end_phase(struct gc_durations *durations, enum gc_phase phase, _PyTime_t *t)
+{
+    _PyTime_t now = _PyTime_GetPerfCounter();
+    durations->phases[phase] = _PyTime_AsSecondsDouble(now - *t);
+    *t = now;
+}
+
+/* Return the index of the bucket of gc_generation_stats.pauses counting a
+ * collection which took duration seconds.  Bucket 0 counts the collections
+ * shorter than a microsecond, bucket i those shorter than 2**i microseconds
+ * which don't fit in bucket i-1, and the last bucket the longer ones.
+ */
+static int
+gc_pause_bucket(double duration)
+{
+    int exponent;
+    double us = duration * 1e6;
+    if (!(us >= 1.0)) {
+        return 0;
+    }
+    (void)frexp(us, &exponent);
+    return Py_MIN(exponent, GC_PAUSE_BUCKETS - 1);
+}
+
+/* Adaptive thresholds.
+
+With gc.set_adaptive(True), the threshold of a generation is tuned after each
+of its collections, from the fraction of the examined objects which turned
+out to be garbage.  A collection that finds little garbage was mostly wasted,
+so the threshold is doubled, to give the young objects more time to die by
+reference counting.  A collection that finds a lot of garbage halves the
+threshold, to reclaim it sooner.  The threshold never goes below the one set
+by gc.set_threshold(), nor above ADAPTIVE_MAX_FACTOR times it.
+
+Raising the threshold of the young generations makes their collections
+longer, so it is also halved when a collection of them took longer than
+2 * ADAPTIVE_MAX_PAUSE, and only doubled if it took less than half of it.
+The collections of the oldest generation take as long as the heap is large,
+whatever the threshold, so only their yield is taken into account.
+
+gc.get_threshold() returns the current thresholds.
+*/
+
+#define ADAPTIVE_LOW_YIELD 0.01     /* double the threshold below this */
+#define ADAPTIVE_HIGH_YIELD 0.10    /* halve it above this */
+#define ADAPTIVE_MAX_FACTOR 16
+#define ADAPTIVE_MAX_PAUSE 0.001    /* seconds */
+
+static void
+adapt_threshold(GCState *gcstate, int generation, Py_ssize_t n_survivors,
+                Py_ssize_t n_garbage, double duration)
+{
+    struct gc_generation *gen = &gcstate->generations[generation];
+    if (gen->base_threshold <= 0 || n_survivors + n_garbage == 0) {
+        return;
+    }
+    double yield = (double)n_garbage / (double)(n_survivors + n_garbage);
+    int young = generation < NUM_GENERATIONS - 1;
+    int threshold = gen->threshold;
+    if (yield > ADAPTIVE_HIGH_YIELD
+        || (young && duration > 2 * ADAPTIVE_MAX_PAUSE))
+    {
+        threshold /= 2;
+    }
+    else if (yield < ADAPTIVE_LOW_YIELD
+             && (!young || duration < ADAPTIVE_MAX_PAUSE / 2)
+             && threshold <= INT_MAX / 2)
+    {
+        threshold *= 2;
+    }
+    int max_threshold = INT_MAX;
+    if (gen->base_threshold <= INT_MAX / ADAPTIVE_MAX_FACTOR) {
+        max_threshold = gen->base_threshold * ADAPTIVE_MAX_FACTOR;
+    }
+    gen->threshold = Py_MAX(gen->base_threshold,
+                            Py_MIN(threshold, max_threshold));
+}
+
 /* This is the main function.  Read this to understand how the
- * collection process works. */
+ * collection process works.  If incremental is true, only collect an
+ * increment of the oldest generation, see fill_increment(). */
 static Py_ssize_t
 gc_collect_main(PyThreadState *tstate, int generation,
                 Py_ssize_t *n_collected, Py_ssize_t *n_uncollectable,
-                int nofail)
+                int nofail, int incremental)
 {
     int i;
     Py_ssize_t m = 0; /* # objects collected */
@@ -1191,10 +1881,18 @@ gc_collect_main(PyThreadState *tstate, int generation,
     PyGC_Head *old; /* next older generation */
     PyGC_Head unreachable; /* non-problematic unreachable trash */
     PyGC_Head finalizers;  /* objects with, & reachable from, __del__ */
+    PyGC_Head increment;   /* the objects examined by an incremental collection */
+    Py_ssize_t n_old = 0;  /* # objects of the old generation in increment */
+    Py_ssize_t cost = 0;   /* the cost of the increment */
+    Py_ssize_t n_survivors = 0;  /* # reachable objects, if adaptive */
     PyGC_Head *gc;
     _PyTime_t t1 = 0;   /* initialize to prevent a compiler warning */
+    _PyTime_t t_start, t_refs, t_phase;
+    struct gc_durations durations;
     GCState *gcstate = &tstate->interp->gc;
 
+    assert(!incremental || generation == NUM_GENERATIONS-1);
+
     // gc_collect_main() must not be called before _PyGC_Init
     // or after _PyGC_Fini()
     assert(gcstate->garbage != NULL);
@@ -1209,10 +1907,12 @@ gc_collect_main(PyThreadState *tstate, int generation,
 #endif
 
     if (gcstate->debug & DEBUG_STATS) {
-        PySys_WriteStderr("gc: collecting generation %d...\n", generation);
+        PySys_WriteStderr("gc: collecting %sgeneration %d...\n",
+                          incremental ? "an increment of " : "", generation);
         show_stats_each_generations(gcstate);
         t1 = _PyTime_GetPerfCounter();
     }
+    t_start = _PyTime_GetPerfCounter();
 
     if (PyDTrace_GC_START_ENABLED())
         PyDTrace_GC_START(generation);
@@ -1223,24 +1923,61 @@ gc_collect_main(PyThreadState *tstate, int generation,
     for (i = 0; i <= generation; i++)
         gcstate->generations[i].count = 0;
 
-    /* merge younger generations with one we are currently collecting */
-    for (i = 0; i < generation; i++) {
-        gc_list_merge(GEN_HEAD(gcstate, i), GEN_HEAD(gcstate, generation));
+    if (incremental) {
+        gc_list_init(&increment);
+        for (i = 0; i < generation; i++) {
+            gc_list_merge(GEN_HEAD(gcstate, i), &increment);
+        }
+        cost = fill_increment(gcstate, &increment, increment_limit(gcstate),
+                              &n_old);
+        young = &increment;
+        old = GEN_HEAD(gcstate, generation);
     }
+    else {
+        /* merge younger generations with one we are currently collecting */
+        for (i = 0; i < generation; i++) {
+            gc_list_merge(GEN_HEAD(gcstate, i), GEN_HEAD(gcstate, generation));
+        }
 
-    /* handy references */
-    young = GEN_HEAD(gcstate, generation);
-    if (generation < NUM_GENERATIONS-1)
-        old = GEN_HEAD(gcstate, generation+1);
-    else
-        old = young;
+        /* handy references */
+        young = GEN_HEAD(gcstate, generation);
+        if (generation < NUM_GENERATIONS-1)
+            old = GEN_HEAD(gcstate, generation+1);
+        else
+            old = young;
+    }
     validate_list(old, collecting_clear_unreachable_clear);
 
-    deduce_unreachable(young, &unreachable);
+#ifdef GC_PARALLEL
+    if (gcstate->parallel > 1 && generation == NUM_GENERATIONS-1
+        && !incremental && !nofail)
+    {
+        deduce_unreachable_parallel(young, &unreachable, gcstate->parallel,
+                                    &t_refs);
+    }
+    else
+#endif
+    deduce_unreachable(young, &unreachable, &t_refs);
+    durations.phases[GC_PHASE_REFS] = _PyTime_AsSecondsDouble(t_refs - t_start);
+    t_phase = t_refs;
+    end_phase(&durations, GC_PHASE_UNREACHABLE, &t_phase);
 
     untrack_tuples(young);
+    if (gcstate->adaptive && !incremental) {
+        n_survivors = gc_list_size(young);
+    }
     /* Move reachable objects to next generation. */
-    if (young != old) {
+    if (incremental) {
+        /* The increment is small enough to untrack dicts too. */
+        untrack_dicts(young);
+        gcstate->long_lived_pending -= Py_MIN(n_old,
+                                              gcstate->long_lived_pending);
+        gcstate->incremental_swept += n_old;
+        gcstate->long_lived_total = Py_MAX(0, gcstate->long_lived_total
+                                              + gc_list_size(young) - n_old);
+        gc_list_merge(young, old);
+    }
+    else if (young != old) {
         if (generation == NUM_GENERATIONS - 2) {
             gcstate->long_lived_pending += gc_list_size(young);
         }
@@ -1252,6 +1989,7 @@ gc_collect_main(PyThreadState *tstate, int generation,
         untrack_dicts(young);
         gcstate->long_lived_pending = 0;
         gcstate->long_lived_total = gc_list_size(young);
+        gcstate->incremental_swept = 0;
     }
 
     /* All objects in unreachable are trash, but objects reachable from
@@ -1278,7 +2016,9 @@ gc_collect_main(PyThreadState *tstate, int generation,
     }
 
     /* Clear weakrefs and invoke callbacks as necessary. */
+    t_phase = _PyTime_GetPerfCounter();
     m += handle_weakrefs(&unreachable, old);
+    end_phase(&durations, GC_PHASE_WEAKREFS, &t_phase);
 
     validate_list(old, collecting_clear_unreachable_clear);
     validate_list(&unreachable, collecting_set_unreachable_clear);
@@ -1291,6 +2031,7 @@ gc_collect_main(PyThreadState *tstate, int generation,
      * objects that are still unreachable */
     PyGC_Head final_unreachable;
     handle_resurrected_objects(&unreachable, &final_unreachable, old);
+    end_phase(&durations, GC_PHASE_FINALIZE, &t_phase);
 
     /* Call tp_clear on objects in the final_unreachable set.  This will cause
     * the reference cycles to be broken.  It may also cause some objects
@@ -1298,6 +2039,7 @@ gc_collect_main(PyThreadState *tstate, int generation,
     */
     m += gc_list_size(&final_unreachable);
     delete_garbage(tstate, gcstate, &final_unreachable, old);
+    end_phase(&durations, GC_PHASE_DELETE, &t_phase);
 
     /* Collect statistics on uncollectable objects found and print
      * debugging information. */
@@ -1320,9 +2062,9 @@ gc_collect_main(PyThreadState *tstate, int generation,
     handle_legacy_finalizers(tstate, gcstate, &finalizers, old);
     validate_list(old, collecting_clear_unreachable_clear);
 
-    /* Clear free list only during the collection of the highest
+    /* Clear free list only during full collections of the highest
      * generation */
-    if (generation == NUM_GENERATIONS-1) {
+    if (generation == NUM_GENERATIONS-1 && !incremental) {
         clear_freelists(tstate->interp);
     }
 
@@ -1343,10 +2085,33 @@ gc_collect_main(PyThreadState *tstate, int generation,
         *n_uncollectable = n;
     }
 
+    durations.total = _PyTime_AsSecondsDouble(
+        _PyTime_GetPerfCounter() - t_start);
+    if (incremental) {
+        /* Measure the speed of increments to size the next ones. */
+        if (durations.total > 0) {
+            double rate = (double)cost / durations.total;
+            if (gcstate->incremental_rate > 0) {
+                rate = (gcstate->incremental_rate + rate) / 2;
+            }
+            gcstate->incremental_rate = rate;
+        }
+    }
+
     struct gc_generation_stats *stats = &gcstate->generation_stats[generation];
     stats->collections++;
     stats->collected += m;
     stats->uncollectable += n;
+    stats->durations.total += durations.total;
+    for (i = 0; i < GC_NUM_PHASES; i++) {
+        stats->durations.phases[i] += durations.phases[i];
+    }
+    stats->pauses[gc_pause_bucket(durations.total)]++;
+    gcstate->last_durations = durations;
+    if (gcstate->adaptive && !incremental) {
+        adapt_threshold(gcstate, generation, n_survivors, m + n,
+                        durations.total);
+    }
 
     if (PyDTrace_GC_DONE_ENABLED()) {
         PyDTrace_GC_DONE(n + m);
@@ -1356,13 +2121,41 @@ gc_collect_main(PyThreadState *tstate, int generation,
     return n + m;
 }
 
+/* Return a dict mapping the names of the phases to their durations. */
+static PyObject *
+phase_durations(const struct gc_durations *durations)
+{
+    static const char * const names[GC_NUM_PHASES] = {
+        [GC_PHASE_REFS] = "refs",
+        [GC_PHASE_UNREACHABLE] = "unreachable",
+        [GC_PHASE_WEAKREFS] = "weakrefs",
+        [GC_PHASE_FINALIZE] = "finalize",
+        [GC_PHASE_DELETE] = "delete",
+    };
+    PyObject *dict = PyDict_New();
+    if (dict == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < GC_NUM_PHASES; i++) {
+        PyObject *value = PyFloat_FromDouble(durations->phases[i]);
+        if (value == NULL || PyDict_SetItemString(dict, names[i], value)) {
+            Py_XDECREF(value);
+            Py_DECREF(dict);
+            return NULL;
+        }
+        Py_DECREF(value);
+    }
+    return dict;
+}
+
 /* Invoke progress callbacks to notify clients that garbage collection
- * is starting or stopping
+ * is starting or stopping.  durations is NULL when it is starting.
  */
 static void
 invoke_gc_callback(PyThreadState *tstate, const char *phase,
                    int generation, Py_ssize_t collected,
-                   Py_ssize_t uncollectable)
+                   Py_ssize_t uncollectable,
+                   const struct gc_durations *durations)
 {
     assert(!_PyErr_Occurred(tstate));
 
@@ -1376,10 +2169,20 @@ invoke_gc_callback(PyThreadState *tstate, const char *phase,
     assert(PyList_CheckExact(gcstate->callbacks));
     PyObject *info = NULL;
     if (PyList_GET_SIZE(gcstate->callbacks) != 0) {
-        info = Py_BuildValue("{sisnsn}",
-            "generation", generation,
-            "collected", collected,
-            "uncollectable", uncollectable);
+        if (durations == NULL) {
+            info = Py_BuildValue("{sisnsn}",
+                "generation", generation,
+                "collected", collected,
+                "uncollectable", uncollectable);
+        }
+        else {
+            info = Py_BuildValue("{sisnsnsdsN}",
+                "generation", generation,
+                "collected", collected,
+                "uncollectable", uncollectable,
+                "duration", durations->total,
+                "phases", phase_durations(durations));
+        }
         if (info == NULL) {
             PyErr_WriteUnraisable(NULL);
             return;
@@ -1405,13 +2208,16 @@ invoke_gc_callback(PyThreadState *tstate, const char *phase,
  * progress callbacks.
  */
 static Py_ssize_t
-gc_collect_with_callback(PyThreadState *tstate, int generation)
+gc_collect_with_callback(PyThreadState *tstate, int generation,
+                         int incremental)
 {
     assert(!_PyErr_Occurred(tstate));
     Py_ssize_t result, collected, uncollectable;
-    invoke_gc_callback(tstate, "start", generation, 0, 0);
-    result = gc_collect_main(tstate, generation, &collected, &uncollectable, 0);
-    invoke_gc_callback(tstate, "stop", generation, collected, uncollectable);
+    invoke_gc_callback(tstate, "start", generation, 0, 0, NULL);
+    result = gc_collect_main(tstate, generation, &collected, &uncollectable, 0,
+                             incremental);
+    invoke_gc_callback(tstate, "stop", generation, collected, uncollectable,
+                       &tstate->interp->gc.last_durations);
     assert(!_PyErr_Occurred(tstate));
     return result;
 }
@@ -1462,10 +2268,26 @@ gc_collect_generations(PyThreadState *tstate)
                June 2008. His original analysis and proposal can be found at:
                http://mail.python.org/pipermail/python-dev/2008-June/080579.html
             */
-            if (i == NUM_GENERATIONS - 1
-                && gcstate->long_lived_pending < gcstate->long_lived_total / 4)
-                continue;
-            n = gc_collect_with_callback(tstate, i);
+            int incremental = 0;
+            if (i == NUM_GENERATIONS - 1) {
+                if (gcstate->incremental_budget > 0) {
+                    /* Collect an increment of the old generation instead,
+                       unless the increments fell behind so much that the
+                       old generation doubled, or swept all of it once:
+                       the cycles too big for an increment are only found
+                       by full collections.  See fill_increment(). */
+                    incremental = (gcstate->long_lived_pending
+                                   < gcstate->long_lived_total
+                                   && gcstate->incremental_swept
+                                      < gcstate->long_lived_total);
+                }
+                else if (gcstate->long_lived_pending
+                         < gcstate->long_lived_total / 4)
+                {
+                    continue;
+                }
+            }
+            n = gc_collect_with_callback(tstate, i, incremental);
             break;
         }
     }
@@ -1548,7 +2370,7 @@ gc_collect_impl(PyObject *module, int generation)
     }
     else {
         gcstate->collecting = 1;
-        n = gc_collect_with_callback(tstate, generation);
+        n = gc_collect_with_callback(tstate, generation, 0);
         gcstate->collecting = 0;
     }
     return n;
@@ -1614,6 +2436,10 @@ gc_set_threshold(PyObject *self, PyObject *args)
         /* generations higher than 2 get the same threshold */
         gcstate->generations[i].threshold = gcstate->generations[2].threshold;
     }
+    for (int i = 0; i < NUM_GENERATIONS; i++) {
+        gcstate->generations[i].base_threshold =
+            gcstate->generations[i].threshold;
+    }
     Py_RETURN_NONE;
 }
 
@@ -1634,6 +2460,138 @@ gc_get_threshold_impl(PyObject *module)
                          gcstate->generations[2].threshold);
 }
 
+/*[clinic input]
+gc.set_incremental
+
+    budget: double
+    /
+
+Collect the oldest generation incrementally.
+
+Automatic collections of the oldest generation are split into increments
+taking about budget seconds each.  A budget of 0 makes them collect the
+whole generation at once again.
+[clinic start generated code]*/
+
+static PyObject *
+gc_set_incremental_impl(PyObject *module, double budget)
+/*[clinic end generated code: output=bc503a6ec89b6c5b input=124b589b960e4fa9]*/
+{
+    if (!(budget >= 0 && budget <= 1e9)) {
+        PyErr_SetString(PyExc_ValueError,
+                        "budget must be a non-negative number of seconds");
+        return NULL;
+    }
+    GCState *gcstate = get_gc_state();
+    gcstate->incremental_budget = budget;
+    Py_RETURN_NONE;
+}
+
+/*[clinic input]
+gc.get_incremental -> double
+
+Return the pause budget of incremental collections, or 0.0 if disabled.
+[clinic start generated code]*/
+
+static double
+gc_get_incremental_impl(PyObject *module)
+/*[clinic end generated code: output=a4ff9b83a08a764e input=68fd5b8d157e561e]*/
+{
+    GCState *gcstate = get_gc_state();
+    return gcstate->incremental_budget;
+}
+
+/*[clinic input]
+gc.set_adaptive
+
+    flag: bool
+    /
+
+Make the collection thresholds adapt to the collections.
+
+The threshold of a generation is raised while its collections find little
+garbage, and lowered when they find a lot, or take too long.  They stay
+between the thresholds set by set_threshold() and 16 times these.
+get_threshold() returns the current thresholds.
+[clinic start generated code]*/
+
+static PyObject *
+gc_set_adaptive_impl(PyObject *module, int flag)
+/*[clinic end generated code: output=85771f5d216a7e3d input=d65251bfe7012abf]*/
+{
+    GCState *gcstate = get_gc_state();
+    gcstate->adaptive = flag;
+    if (!flag) {
+        for (int i = 0; i < NUM_GENERATIONS; i++) {
+            gcstate->generations[i].threshold =
+                gcstate->generations[i].base_threshold;
+        }
+    }
+    Py_RETURN_NONE;
+}
+
+/*[clinic input]
+gc.get_adaptive -> bool
+
+Return True if the collection thresholds adapt to the collections.
+[clinic start generated code]*/
+
+static int
+gc_get_adaptive_impl(PyObject *module)
+/*[clinic end generated code: output=1f7d922ff8e3f6be input=7ed75d0c307bc74d]*/
+{
+    GCState *gcstate = get_gc_state();
+    return gcstate->adaptive;
+}
+
+/*[clinic input]
+gc.set_parallel
+
+    threads: int
+    /
+
+Set the number of threads marking the objects in full collections.
+
+With more than one thread, the reachable objects of full collections are
+found in parallel.  The thread which runs the collection is one of them.
+[clinic start generated code]*/
+
+static PyObject *
+gc_set_parallel_impl(PyObject *module, int threads)
+/*[clinic end generated code: output=eb1b216ff80032f6 input=570e24199c15c7ef]*/
+{
+    GCState *gcstate = get_gc_state();
+    if (threads < 1 || threads > 256) {
+        PyErr_SetString(PyExc_ValueError,
+                        "number of threads must be between 1 and 256");
+        return NULL;
+    }
+#ifndef GC_PARALLEL
+    if (threads > 1) {
+        PyErr_SetString(PyExc_ValueError,
+                        "parallel collections are not supported "
+                        "on this platform");
+        return NULL;
+    }
+#endif
+    gcstate->parallel = threads;
+    Py_RETURN_NONE;
+}
+
+/*[clinic input]
+gc.get_parallel -> int
+
+Return the number of threads marking the objects in full collections.
+[clinic start generated code]*/
+
+static int
+gc_get_parallel_impl(PyObject *module)
+/*[clinic end generated code: output=5b8b3265d5cdfb34 input=0409a82b2cd8d8b3]*/
+{
+    GCState *gcstate = get_gc_state();
+    return gcstate->parallel;
+}
+
 /*[clinic input]
 gc.get_count
 
@@ -1838,10 +2796,12 @@ gc_get_stats_impl(PyObject *module)
     for (i = 0; i < NUM_GENERATIONS; i++) {
         PyObject *dict;
         st = &stats[i];
-        dict = Py_BuildValue("{snsnsn}",
+        dict = Py_BuildValue("{snsnsnsdsN}",
                              "collections", st->collections,
                              "collected", st->collected,
-                             "uncollectable", st->uncollectable
+                             "uncollectable", st->uncollectable,
+                             "duration", st->durations.total,
+                             "phases", phase_durations(&st->durations)
                             );
         if (dict == NULL)
             goto error;
@@ -1858,6 +2818,60 @@ gc_get_stats_impl(PyObject *module)
     return NULL;
 }
 
+/*[clinic input]
+gc.get_pause_histogram
+
+    generation: Py_ssize_t(accept={int, NoneType}, c_default="-1") = None
+        Generation whose collections to count.
+
+Return a histogram of the durations of the collections.
+
+The result is a list of (limit, count) tuples, where count is the number
+of collections shorter than limit seconds which weren't counted in the
+previous tuple.  The limits are powers of two microseconds, the last one
+is infinity.  If generation is None, count the collections of all
+generations.
+[clinic start generated code]*/
+
+static PyObject *
+gc_get_pause_histogram_impl(PyObject *module, Py_ssize_t generation)
+/*[clinic end generated code: output=d8dfa01cd34ed8d3 input=e7ea3acf535c88ea]*/
+{
+    Py_ssize_t pauses[GC_PAUSE_BUCKETS] = {0};
+    GCState *gcstate = get_gc_state();
+
+    if (generation != -1 && (generation < 0 || generation >= NUM_GENERATIONS)) {
+        PyErr_Format(PyExc_ValueError,
+                     "generation parameter must be None or between 0 and %i",
+                     NUM_GENERATIONS - 1);
+        return NULL;
+    }
+    /* Take a snapshot, like gc_get_stats_impl(). */
+    for (int i = 0; i < NUM_GENERATIONS; i++) {
+        if (generation == -1 || generation == i) {
+            for (int j = 0; j < GC_PAUSE_BUCKETS; j++) {
+                pauses[j] += gcstate->generation_stats[i].pauses[j];
+            }
+        }
+    }
+
+    PyObject *result = PyList_New(GC_PAUSE_BUCKETS);
+    if (result == NULL) {
+        return NULL;
+    }
+    for (int j = 0; j < GC_PAUSE_BUCKETS; j++) {
+        double limit = (j == GC_PAUSE_BUCKETS - 1) ? Py_HUGE_VAL
+                                                   : ldexp(1e-6, j);
+        PyObject *item = Py_BuildValue("(dn)", limit, pauses[j]);
+        if (item == NULL) {
+            Py_DECREF(result);
+            return NULL;
+        }
+        PyList_SET_ITEM(result, j, item);
+    }
+    return result;
+}
+
 
 /*[clinic input]
 gc.is_tracked
@@ -1967,10 +2981,17 @@ PyDoc_STRVAR(gc__doc__,
 "collect() -- Do a full collection right now.\n"
 "get_count() -- Return the current collection counts.\n"
 "get_stats() -- Return list of dictionaries containing per-generation stats.\n"
+"get_pause_histogram() -- Return a histogram of the durations of collections.\n"
 "set_debug() -- Set debugging flags.\n"
 "get_debug() -- Get debugging flags.\n"
 "set_threshold() -- Set the collection thresholds.\n"
 "get_threshold() -- Return the current the collection thresholds.\n"
+"set_incremental() -- Collect the oldest generation incrementally.\n"
+"get_incremental() -- Return the pause budget of incremental collections.\n"
+"set_adaptive() -- Make the collection thresholds adapt to the collections.\n"
+"get_adaptive() -- Return True if the thresholds are adaptive.\n"
+"set_parallel() -- Set the number of threads marking full collections.\n"
+"get_parallel() -- Return the number of threads marking full collections.\n"
 "get_objects() -- Return a list of all objects tracked by the collector.\n"
 "is_tracked() -- Returns true if a given object is tracked.\n"
 "is_finalized() -- Returns true if a given object has been already finalized.\n"
@@ -1989,9 +3010,16 @@ static PyMethodDef GcMethods[] = {
     GC_GET_COUNT_METHODDEF
     {"set_threshold",  gc_set_threshold, METH_VARARGS, gc_set_thresh__doc__},
     GC_GET_THRESHOLD_METHODDEF
+    GC_SET_INCREMENTAL_METHODDEF
+    GC_GET_INCREMENTAL_METHODDEF
+    GC_SET_ADAPTIVE_METHODDEF
+    GC_GET_ADAPTIVE_METHODDEF
+    GC_SET_PARALLEL_METHODDEF
+    GC_GET_PARALLEL_METHODDEF
     GC_COLLECT_METHODDEF
     GC_GET_OBJECTS_METHODDEF
     GC_GET_STATS_METHODDEF
+    GC_GET_PAUSE_HISTOGRAM_METHODDEF
     GC_IS_TRACKED_METHODDEF
     GC_IS_FINALIZED_METHODDEF
     {"get_referrers",  gc_get_referrers, METH_VARARGS,
@@ -2096,7 +3124,7 @@ PyGC_Collect(void)
         PyObject *exc, *value, *tb;
         gcstate->collecting = 1;
         _PyErr_Fetch(tstate, &exc, &value, &tb);
-        n = gc_collect_with_callback(tstate, NUM_GENERATIONS - 1);
+        n = gc_collect_with_callback(tstate, NUM_GENERATIONS - 1, 0);
         _PyErr_Restore(tstate, exc, value, tb);
         gcstate->collecting = 0;
     }
@@ -2120,7 +3148,7 @@ _PyGC_CollectNoFail(PyThreadState *tstate)
 
     Py_ssize_t n;
     gcstate->collecting = 1;
-    n = gc_collect_main(tstate, NUM_GENERATIONS - 1, NULL, NULL, 1);
+    n = gc_collect_main(tstate, NUM_GENERATIONS - 1, NULL, NULL, 1, 0);
     gcstate->collecting = 0;
     return n;
 }
@@ -174,6 +174,27 @@ dict_popitem(PyDictObject *self, PyObject *Py_UNUSED(ignored))
     return dict_popitem_impl(self);
 }
 
+PyDoc_STRVAR(dict_compact__doc__,
+"compact($self, /)\n"
+"--\n"
+"\n"
+"Shrink the memory used by the dictionary to a minimum.\n"
+"\n"
+"This is meant for big dictionaries which are built once and then mostly\n"
+"read.  Inserting a new key afterwards grows the dictionary again.");
+
+#define DICT_COMPACT_METHODDEF    \
+    {"compact", (PyCFunction)dict_compact, METH_NOARGS, dict_compact__doc__},
+
+static PyObject *
+dict_compact_impl(PyDictObject *self);
+
+static PyObject *
+dict_compact(PyDictObject *self, PyObject *Py_UNUSED(ignored))
+{
+    return dict_compact_impl(self);
+}
+
 PyDoc_STRVAR(dict___reversed____doc__,
 "__reversed__($self, /)\n"
 "--\n"
@@ -191,4 +212,4 @@ dict___reversed__(PyDictObject *self, PyObject *Py_UNUSED(ignored))
 {
     return dict___reversed___impl(self);
 }
-/*[clinic end generated code: output=7b77c16e43d6735a input=a9049054013a1b77]*/
+/*[clinic end generated code: output=e83dde31b486c86b input=a9049054013a1b77]*/
@@ -20,12 +20,15 @@ As of Python 3.6, this is compact and ordered. Basic idea is described here:
 | dk_refcnt     |
 | dk_log2_size  |
 | dk_kind       |
+| dk_grouped    |
 | dk_usable     |
 | dk_nentries   |
 +---------------+
 | dk_indices    |
 |               |
 +---------------+
+| dk_ctrl       |  (only if dk_grouped)
++---------------+
 | dk_entries    |
 |               |
 +---------------+
@@ -45,6 +48,16 @@ DK_ENTRIES(dk) can be used to get pointer to entries.
 NOTE: Since negative value is used for DKIX_EMPTY and DKIX_DUMMY, type of
 dk_indices entry is signed integer and int16 is used for table which
 dk_size == 256.
+
+Big tables of unicode keys are "grouped": a control byte per slot follows
+dk_indices.  It is CTRL_EMPTY or CTRL_DUMMY for the slots whose index is
+DKIX_EMPTY or DKIX_DUMMY, else 7 bits of the hash of the key (its tag).  Such
+tables are probed by groups of DK_GROUP_WIDTH consecutive slots instead of
+slot by slot, see "Probing groups" below.
+
+dict.compact() can make big tables of unicode keys compact: dk_entries is
+then an array of PyDictCompactEntry without hashes, see "Compact tables"
+below.
 */
 
 
@@ -121,6 +134,12 @@ As a consequence of this, split keys have a maximum size of 16.
 #include "pycore_pystate.h"       // _PyThreadState_GET()
 #include "stringlib/eq.h"         // unicode_eq()
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>          // _mm_cmpeq_epi8()
+#  define HAVE_GROUP_SSE2
+#endif
+
 /*[clinic input]
 class dict "PyDictObject *" "&PyDict_Type"
 [clinic start generated code]*/
@@ -291,6 +310,15 @@ _PyDict_DebugMallocStats(FILE *out)
 }
 
 #define DK_MASK(dk) (DK_SIZE(dk)-1)
+#define DK_CTRL(dk) \
+    ((uint8_t *)&(dk)->dk_indices[DK_SIZE(dk) * DK_IXSIZE(dk)])
+#define DK_GROUP_WIDTH 16
+#define DK_GROUP_MASK(dk) ((size_t)(DK_SIZE(dk) / DK_GROUP_WIDTH) - 1)
+
+/* Control bytes of the unused and dummy slots of grouped tables. */
+#define CTRL_EMPTY 0x80
+#define CTRL_DUMMY 0xfe
+
 #define IS_POWER_OF_2(x) (((x) & (x-1)) == 0)
 
 static void free_keys_object(PyDictKeysObject *keys);
@@ -375,6 +403,157 @@ dictkeys_set_index(PyDictKeysObject *keys, Py_ssize_t i, Py_ssize_t ix)
         assert(ix <= 0x7fffffff);
         indices[i] = (int32_t)ix;
     }
+    if (keys->dk_grouped && ix < 0) {
+        DK_CTRL(keys)[i] = (ix == DKIX_DUMMY) ? CTRL_DUMMY : CTRL_EMPTY;
+    }
+}
+
+/* Probing groups
+
+Lookups in big dicts are dominated by cache misses: each probe loads a slot of
+dk_indices and then the entry it refers to, only to compare hashes.  Grouped
+tables also keep a tag of the hash of each key in dk_ctrl, and probe groups of
+DK_GROUP_WIDTH consecutive slots, visited in the order given by the recurrence
+described above, applied to group numbers.  The tags of a group are compared
+to the tag of the hash in one step, with SSE2 when available, and only the
+matching slots, typically one, are looked up in dk_indices and dk_entries.
+A lookup ends at the first group having an unused slot, which is normally the
+first group, so missing keys usually cost a single cache miss.
+
+A key is inserted in the first free (unused or dummy) slot of the first group
+having one.  Since slots never become unused again, a lookup can't miss a key
+by stopping at a group with an unused slot.
+
+The tag mixes all bits of the hash, so that keys with small hashes, such as
+small ints, still have different tags.  Only tables of unicode keys are
+grouped when created, tables which get other keys stay grouped until resized.
+*/
+
+/* Grouped tables have at least 2**DK_LOG_GROUP_MIN slots. */
+#define DK_LOG_GROUP_MIN 10
+
+static inline uint8_t
+ctrl_tag(Py_hash_t hash)
+{
+#if SIZEOF_SIZE_T > 4
+    return (uint8_t)(((size_t)hash * 0x9E3779B97F4A7C15) >> 57);
+#else
+    return (uint8_t)(((size_t)hash * 0x9E3779B9) >> 25);
+#endif
+}
+
+/* Return a mask of the slots of group whose control byte is ctrl. */
+static inline unsigned int
+group_match(const uint8_t *group, uint8_t ctrl)
+{
+#ifdef HAVE_GROUP_SSE2
+    __m128i g = _mm_loadu_si128((const __m128i *)group);
+    __m128i c = _mm_set1_epi8((char)ctrl);
+    return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(g, c));
+#else
+    unsigned int mask = 0;
+    for (int j = 0; j < DK_GROUP_WIDTH; j++) {
+        mask |= (unsigned int)(group[j] == ctrl) << j;
+    }
+    return mask;
+#endif
+}
+
+/* Return a mask of the free (unused or dummy) slots of group. */
+static inline unsigned int
+group_match_free(const uint8_t *group)
+{
+#ifdef HAVE_GROUP_SSE2
+    __m128i g = _mm_loadu_si128((const __m128i *)group);
+    return (unsigned int)_mm_movemask_epi8(g);
+#else
+    unsigned int mask = 0;
+    for (int j = 0; j < DK_GROUP_WIDTH; j++) {
+        mask |= (unsigned int)(group[j] >> 7) << j;
+    }
+    return mask;
+#endif
+}
+
+/* Return the index of the lowest set bit of mask, which must not be 0. */
+static inline int
+group_lowest(unsigned int mask)
+{
+    assert(mask != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(mask);
+#elif defined(_MSC_VER)
+    unsigned long j;
+    _BitScanForward(&j, mask);
+    return (int)j;
+#else
+    int j = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        j++;
+    }
+    return j;
+#endif
+}
+
+/* Start loading the indices of group g, while its control bytes are
+ * compared: when the key is present, they are needed next. */
+static inline void
+group_prefetch_indices(const PyDictKeysObject *keys, size_t g)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(&keys->dk_indices[g * DK_GROUP_WIDTH * DK_IXSIZE(keys)]);
+#endif
+}
+
+/* Write the index of a new entry in slot i. */
+static inline void
+dictkeys_insert_index(PyDictKeysObject *keys, Py_ssize_t i, Py_ssize_t ix,
+                      Py_hash_t hash)
+{
+    assert(ix >= 0);
+    dictkeys_set_index(keys, i, ix);
+    if (keys->dk_grouped) {
+        DK_CTRL(keys)[i] = ctrl_tag(hash);
+    }
+}
+
+
+/* Compact tables
+
+dict.compact() turns a big combined table of exact str keys into a compact
+table: its size is the smallest one which fits the items, dk_entries holds
+the items and nothing else (dk_usable is 0), and the entries don't store the
+hashes of the keys, since str objects cache them.  This saves 40% to 50% of
+the memory of a table which was filled by insertions.
+
+A compact table stays compact when items are deleted or values replaced.
+Inserting a new key resizes it to a regular table.  Compact tables are
+grouped, so lookups only need to handle them in the grouped code paths.
+*/
+
+#define DK_IS_COMPACT(dk) ((dk)->dk_kind == DICT_KEYS_COMPACT)
+
+/* Return the hash of a key of a compact table. */
+static inline Py_hash_t
+compact_hash(PyObject *key)
+{
+    assert(PyUnicode_CheckExact(key));
+    assert(((PyASCIIObject *)key)->hash != -1);
+    return ((PyASCIIObject *)key)->hash;
+}
+
+/* Return the index of the first item of the compact table keys at or after
+ * index i, or dk_nentries if there is none. */
+static inline Py_ssize_t
+compact_next_item(PyDictKeysObject *keys, Py_ssize_t i)
+{
+    PyDictCompactEntry *entries = DK_COMPACT_ENTRIES(keys);
+    Py_ssize_t n = keys->dk_nentries;
+    while (i < n && entries[i].me_value == NULL) {
+        i++;
+    }
+    return i;
 }
 
 
@@ -445,6 +624,7 @@ static PyDictKeysObject empty_keys_struct = {
         1, /* dk_refcnt */
         0, /* dk_log2_size */
         DICT_KEYS_SPLIT, /* dk_kind */
+        0, /* dk_grouped */
         1, /* dk_version */
         0, /* dk_usable (immutable) */
         0, /* dk_nentries */
@@ -500,17 +680,52 @@ _PyDict_CheckConsistency(PyObject *op, int check_content)
     }
     else {
         CHECK(mp->ma_used <= SHARED_KEYS_MAX_SIZE);
+        CHECK(!keys->dk_grouped);
+    }
+    CHECK(!keys->dk_grouped || DK_LOG_SIZE(keys) >= DK_LOG_GROUP_MIN);
+    if (DK_IS_COMPACT(keys)) {
+        CHECK(!splitted);
+        CHECK(keys->dk_grouped);
+        CHECK(keys->dk_usable == 0);
     }
 
     if (check_content) {
         PyDictKeyEntry *entries = DK_ENTRIES(keys);
+        PyDictCompactEntry *centries = DK_COMPACT_ENTRIES(keys);
 
         for (Py_ssize_t i=0; i < DK_SIZE(keys); i++) {
             Py_ssize_t ix = dictkeys_get_index(keys, i);
             CHECK(DKIX_DUMMY <= ix && ix <= usable);
+            if (keys->dk_grouped) {
+                uint8_t ctrl = DK_CTRL(keys)[i];
+                if (ix == DKIX_EMPTY) {
+                    CHECK(ctrl == CTRL_EMPTY);
+                }
+                else if (ix == DKIX_DUMMY) {
+                    CHECK(ctrl == CTRL_DUMMY);
+                }
+                else if (DK_IS_COMPACT(keys)) {
+                    CHECK(ctrl == ctrl_tag(compact_hash(centries[ix].me_key)));
+                }
+                else {
+                    CHECK(ctrl == ctrl_tag(entries[ix].me_hash));
+                }
+            }
         }
 
-        for (Py_ssize_t i=0; i < usable; i++) {
+        for (Py_ssize_t i=0; DK_IS_COMPACT(keys) && i < keys->dk_nentries; i++) {
+            PyObject *key = centries[i].me_key;
+            if (key != NULL) {
+                CHECK(PyUnicode_CheckExact(key));
+                CHECK(((PyASCIIObject *)key)->hash != -1);
+                CHECK(centries[i].me_value != NULL);
+            }
+            else {
+                CHECK(centries[i].me_value == NULL);
+            }
+        }
+
+        for (Py_ssize_t i=0; !DK_IS_COMPACT(keys) && i < usable; i++) {
             PyDictKeyEntry *entry = &entries[i];
             PyObject *key = entry->me_key;
 
@@ -552,11 +767,14 @@ _PyDict_CheckConsistency(PyObject *op, int check_content)
 }
 
 
+/* Create a keys object of 2**log2_size slots.  If unicode is true, the
+ * keys are expected to be strings, and big tables are grouped. */
 static PyDictKeysObject*
-new_keys_object(uint8_t log2_size)
+new_keys_object(uint8_t log2_size, int unicode)
 {
     PyDictKeysObject *dk;
     Py_ssize_t es, usable;
+    uint8_t grouped = (unicode && log2_size >= DK_LOG_GROUP_MIN);
 
     assert(log2_size >= PyDict_LOG_MINSIZE);
 
@@ -589,7 +807,7 @@ new_keys_object(uint8_t log2_size)
 #endif
     {
         dk = PyObject_Malloc(sizeof(PyDictKeysObject)
-                             + (es<<log2_size)
+                             + ((es + grouped)<<log2_size)
                              + sizeof(PyDictKeyEntry) * usable);
         if (dk == NULL) {
             PyErr_NoMemory();
@@ -602,10 +820,14 @@ new_keys_object(uint8_t log2_size)
     dk->dk_refcnt = 1;
     dk->dk_log2_size = log2_size;
     dk->dk_kind = DICT_KEYS_UNICODE;
+    dk->dk_grouped = grouped;
     dk->dk_nentries = 0;
     dk->dk_usable = usable;
     dk->dk_version = 0;
     memset(&dk->dk_indices[0], 0xff, es<<log2_size);
+    if (grouped) {
+        memset(DK_CTRL(dk), CTRL_EMPTY, (size_t)1<<log2_size);
+    }
     memset(DK_ENTRIES(dk), 0, sizeof(PyDictKeyEntry) * usable);
     return dk;
 }
@@ -615,6 +837,15 @@ free_keys_object(PyDictKeysObject *keys)
 {
     PyDictKeyEntry *entries = DK_ENTRIES(keys);
     Py_ssize_t i, n;
+    if (DK_IS_COMPACT(keys)) {
+        PyDictCompactEntry *centries = DK_COMPACT_ENTRIES(keys);
+        for (i = 0, n = keys->dk_nentries; i < n; i++) {
+            Py_XDECREF(centries[i].me_key);
+            Py_XDECREF(centries[i].me_value);
+        }
+        PyObject_Free(keys);
+        return;
+    }
     for (i = 0, n = keys->dk_nentries; i < n; i++) {
         Py_XDECREF(entries[i].me_key);
         Py_XDECREF(entries[i].me_value);
@@ -729,12 +960,23 @@ clone_combined_dict_keys(PyDictObject *orig)
        new dict object. */
     PyDictKeyEntry *ep0 = DK_ENTRIES(keys);
     Py_ssize_t n = keys->dk_nentries;
-    for (Py_ssize_t i = 0; i < n; i++) {
-        PyDictKeyEntry *entry = &ep0[i];
-        PyObject *value = entry->me_value;
-        if (value != NULL) {
-            Py_INCREF(value);
-            Py_INCREF(entry->me_key);
+    if (DK_IS_COMPACT(keys)) {
+        PyDictCompactEntry *entries = DK_COMPACT_ENTRIES(keys);
+        for (Py_ssize_t i = 0; i < n; i++) {
+            if (entries[i].me_value != NULL) {
+                Py_INCREF(entries[i].me_value);
+                Py_INCREF(entries[i].me_key);
+            }
+        }
+    }
+    else {
+        for (Py_ssize_t i = 0; i < n; i++) {
+            PyDictKeyEntry *entry = &ep0[i];
+            PyObject *value = entry->me_value;
+            if (value != NULL) {
+                Py_INCREF(value);
+                Py_INCREF(entry->me_key);
+            }
         }
     }
 
@@ -755,10 +997,109 @@ PyDict_New(void)
     return new_dict(Py_EMPTY_KEYS, empty_values, 0, 0);
 }
 
+/* lookdict_index() for grouped tables */
+static Py_ssize_t
+group_lookdict_index(PyDictKeysObject *k, Py_hash_t hash, Py_ssize_t index)
+{
+    const uint8_t *ctrl = DK_CTRL(k);
+    uint8_t tag = ctrl_tag(hash);
+    size_t mask = DK_GROUP_MASK(k);
+    size_t perturb = (size_t)hash;
+    size_t g = (size_t)hash & mask;
+
+    for (;;) {
+        const uint8_t *group = &ctrl[g * DK_GROUP_WIDTH];
+        for (unsigned int m = group_match(group, tag); m; m &= m - 1) {
+            size_t i = g * DK_GROUP_WIDTH + group_lowest(m);
+            if (dictkeys_get_index(k, i) == index) {
+                return i;
+            }
+        }
+        if (group_match(group, CTRL_EMPTY)) {
+            return DKIX_EMPTY;
+        }
+        perturb >>= PERTURB_SHIFT;
+        g = mask & (g*5 + perturb + 1);
+    }
+    Py_UNREACHABLE();
+}
+
+/* dictkeys_stringlookup() for grouped tables */
+static Py_ssize_t
+group_stringlookup(PyDictKeysObject* dk, PyObject *key, Py_hash_t hash)
+{
+    PyDictKeyEntry *ep0 = DK_ENTRIES(dk);
+    const uint8_t *ctrl = DK_CTRL(dk);
+    uint8_t tag = ctrl_tag(hash);
+    size_t mask = DK_GROUP_MASK(dk);
+    size_t perturb = (size_t)hash;
+    size_t g = (size_t)hash & mask;
+
+    for (;;) {
+        const uint8_t *group = &ctrl[g * DK_GROUP_WIDTH];
+        group_prefetch_indices(dk, g);
+        for (unsigned int m = group_match(group, tag); m; m &= m - 1) {
+            Py_ssize_t ix = dictkeys_get_index(
+                dk, g * DK_GROUP_WIDTH + group_lowest(m));
+            assert(ix >= 0);
+            PyDictKeyEntry *ep = &ep0[ix];
+            assert(ep->me_key != NULL);
+            assert(PyUnicode_CheckExact(ep->me_key));
+            if (ep->me_key == key ||
+                    (ep->me_hash == hash && unicode_eq(ep->me_key, key))) {
+                return ix;
+            }
+        }
+        if (group_match(group, CTRL_EMPTY)) {
+            return DKIX_EMPTY;
+        }
+        perturb >>= PERTURB_SHIFT;
+        g = mask & (g*5 + perturb + 1);
+    }
+    Py_UNREACHABLE();
+}
+
+/* dictkeys_stringlookup() for compact tables */
+static Py_ssize_t
+compact_stringlookup(PyDictKeysObject* dk, PyObject *key, Py_hash_t hash)
+{
+    PyDictCompactEntry *ep0 = DK_COMPACT_ENTRIES(dk);
+    const uint8_t *ctrl = DK_CTRL(dk);
+    uint8_t tag = ctrl_tag(hash);
+    size_t mask = DK_GROUP_MASK(dk);
+    size_t perturb = (size_t)hash;
+    size_t g = (size_t)hash & mask;
+
+    for (;;) {
+        const uint8_t *group = &ctrl[g * DK_GROUP_WIDTH];
+        group_prefetch_indices(dk, g);
+        for (unsigned int m = group_match(group, tag); m; m &= m - 1) {
+            Py_ssize_t ix = dictkeys_get_index(
+                dk, g * DK_GROUP_WIDTH + group_lowest(m));
+            assert(ix >= 0);
+            PyObject *ekey = ep0[ix].me_key;
+            assert(ekey != NULL);
+            if (ekey == key ||
+                    (compact_hash(ekey) == hash && unicode_eq(ekey, key))) {
+                return ix;
+            }
+        }
+        if (group_match(group, CTRL_EMPTY)) {
+            return DKIX_EMPTY;
+        }
+        perturb >>= PERTURB_SHIFT;
+        g = mask & (g*5 + perturb + 1);
+    }
+    Py_UNREACHABLE();
+}
+
 /* Search index of hash table from offset of entry table */
 static Py_ssize_t
 lookdict_index(PyDictKeysObject *k, Py_hash_t hash, Py_ssize_t index)
 {
+    if (k->dk_grouped) {
+        return group_lookdict_index(k, hash, index);
+    }
     size_t mask = DK_MASK(k);
     size_t perturb = (size_t)hash;
     size_t i = (size_t)hash & mask;
@@ -780,6 +1121,12 @@ lookdict_index(PyDictKeysObject *k, Py_hash_t hash, Py_ssize_t index)
 static Py_ssize_t
 dictkeys_stringlookup(PyDictKeysObject* dk, PyObject *key, Py_hash_t hash)
 {
+    if (dk->dk_grouped) {
+        if (DK_IS_COMPACT(dk)) {
+            return compact_stringlookup(dk, key, hash);
+        }
+        return group_stringlookup(dk, key, hash);
+    }
     PyDictKeyEntry *ep0 = DK_ENTRIES(dk);
     size_t mask = DK_MASK(dk);
     size_t perturb = hash;
@@ -844,6 +1191,61 @@ _PyDictKeys_StringLookup(PyDictKeysObject* dk, PyObject *key)
     return dictkeys_stringlookup(dk, key, hash);
 }
 
+/* _Py_dict_lookup() for compact tables and keys which are not exact str */
+static Py_ssize_t
+compact_lookup(PyDictObject *mp, PyObject *key, Py_hash_t hash,
+               PyObject **value_addr)
+{
+    PyDictKeysObject *dk = mp->ma_keys;
+    PyDictCompactEntry *ep0 = DK_COMPACT_ENTRIES(dk);
+    const uint8_t *ctrl = DK_CTRL(dk);
+    uint8_t tag = ctrl_tag(hash);
+    size_t mask = DK_GROUP_MASK(dk);
+    size_t perturb = hash;
+    size_t g = (size_t)hash & mask;
+
+    for (;;) {
+        const uint8_t *group = &ctrl[g * DK_GROUP_WIDTH];
+        for (unsigned int m = group_match(group, tag); m; m &= m - 1) {
+            Py_ssize_t ix = dictkeys_get_index(dk, g * DK_GROUP_WIDTH
+                                                   + group_lowest(m));
+            if (ix < 0) {
+                /* Deleted by a comparison since the group was matched */
+                continue;
+            }
+            PyDictCompactEntry *ep = &ep0[ix];
+            assert(ep->me_key != NULL);
+            if (compact_hash(ep->me_key) == hash) {
+                PyObject *startkey = ep->me_key;
+                Py_INCREF(startkey);
+                int cmp = PyObject_RichCompareBool(startkey, key, Py_EQ);
+                Py_DECREF(startkey);
+                if (cmp < 0) {
+                    *value_addr = NULL;
+                    return DKIX_ERROR;
+                }
+                if (dk == mp->ma_keys && ep->me_key == startkey) {
+                    if (cmp > 0) {
+                        *value_addr = ep->me_value;
+                        return ix;
+                    }
+                }
+                else {
+                    /* The dict was mutated, restart */
+                    return _Py_dict_lookup(mp, key, hash, value_addr);
+                }
+            }
+        }
+        if (group_match(group, CTRL_EMPTY)) {
+            *value_addr = NULL;
+            return DKIX_EMPTY;
+        }
+        perturb >>= PERTURB_SHIFT;
+        g = (g*5 + perturb + 1) & mask;
+    }
+    Py_UNREACHABLE();
+}
+
 /*
 The basic lookup function used by all operations.
 This is based on Algorithm D from Knuth Vol. 3, Sec. 6.4.
@@ -874,16 +1276,71 @@ _Py_dict_lookup(PyDictObject *mp, PyObject *key, Py_hash_t hash, PyObject **valu
         else if (kind == DICT_KEYS_SPLIT) {
             *value_addr = mp->ma_values->values[ix];
         }
+        else if (kind == DICT_KEYS_COMPACT) {
+            *value_addr = DK_COMPACT_ENTRIES(dk)[ix].me_value;
+        }
         else {
             *value_addr = DK_ENTRIES(dk)[ix].me_value;
         }
         return ix;
     }
+    if (kind == DICT_KEYS_COMPACT) {
+        return compact_lookup(mp, key, hash, value_addr);
+    }
     PyDictKeyEntry *ep0 = DK_ENTRIES(dk);
+    Py_ssize_t ix;
+    if (dk->dk_grouped) {
+        const uint8_t *ctrl = DK_CTRL(dk);
+        uint8_t tag = ctrl_tag(hash);
+        size_t mask = DK_GROUP_MASK(dk);
+        size_t perturb = hash;
+        size_t g = (size_t)hash & mask;
+        for (;;) {
+            const uint8_t *group = &ctrl[g * DK_GROUP_WIDTH];
+            group_prefetch_indices(dk, g);
+            for (unsigned int m = group_match(group, tag); m; m &= m - 1) {
+                ix = dictkeys_get_index(dk, g * DK_GROUP_WIDTH
+                                            + group_lowest(m));
+                if (ix < 0) {
+                    /* Deleted by a comparison since the group was matched */
+                    continue;
+                }
+                PyDictKeyEntry *ep = &ep0[ix];
+                assert(ep->me_key != NULL);
+                if (ep->me_key == key) {
+                    goto found;
+                }
+                if (ep->me_hash == hash) {
+                    PyObject *startkey = ep->me_key;
+                    Py_INCREF(startkey);
+                    int cmp = PyObject_RichCompareBool(startkey, key, Py_EQ);
+                    Py_DECREF(startkey);
+                    if (cmp < 0) {
+                        *value_addr = NULL;
+                        return DKIX_ERROR;
+                    }
+                    if (dk == mp->ma_keys && ep->me_key == startkey) {
+                        if (cmp > 0) {
+                            goto found;
+                        }
+                    }
+                    else {
+                        /* The dict was mutated, restart */
+                        goto start;
+                    }
+                }
+            }
+            if (group_match(group, CTRL_EMPTY)) {
+                *value_addr = NULL;
+                return DKIX_EMPTY;
+            }
+            perturb >>= PERTURB_SHIFT;
+            g = (g*5 + perturb + 1) & mask;
+        }
+    }
     size_t mask = DK_MASK(dk);
     size_t perturb = hash;
     size_t i = (size_t)hash & mask;
-    Py_ssize_t ix;
     for (;;) {
         ix = dictkeys_get_index(dk, i);
         if (ix == DKIX_EMPTY) {
@@ -979,6 +1436,16 @@ _PyDict_MaybeUntrack(PyObject *op)
             }
         }
     }
+    else if (DK_IS_COMPACT(mp->ma_keys)) {
+        PyDictCompactEntry *entries = DK_COMPACT_ENTRIES(mp->ma_keys);
+        for (i = 0; i < numentries; i++) {
+            if ((value = entries[i].me_value) == NULL)
+                continue;
+            /* Keys are strings */
+            if (_PyObject_GC_MAY_BE_TRACKED(value))
+                return;
+        }
+    }
     else {
         for (i = 0; i < numentries; i++) {
             if ((value = ep0[i].me_value) == NULL)
@@ -1000,6 +1467,20 @@ find_empty_slot(PyDictKeysObject *keys, Py_hash_t hash)
 {
     assert(keys != NULL);
 
+    if (keys->dk_grouped) {
+        const uint8_t *ctrl = DK_CTRL(keys);
+        const size_t mask = DK_GROUP_MASK(keys);
+        size_t g = hash & mask;
+        for (size_t perturb = hash;;) {
+            unsigned int m = group_match_free(&ctrl[g * DK_GROUP_WIDTH]);
+            if (m) {
+                return g * DK_GROUP_WIDTH + group_lowest(m);
+            }
+            perturb >>= PERTURB_SHIFT;
+            g = (g*5 + perturb + 1) & mask;
+        }
+    }
+
     const size_t mask = DK_MASK(keys);
     size_t i = hash & mask;
     Py_ssize_t ix = dictkeys_get_index(keys, i);
@@ -1040,7 +1521,7 @@ insert_into_dictkeys(PyDictKeysObject *keys, PyObject *name)
         Py_ssize_t hashpos = find_empty_slot(keys, hash);
         ix = keys->dk_nentries;
         PyDictKeyEntry *ep = &DK_ENTRIES(keys)[ix];
-        dictkeys_set_index(keys, hashpos, ix);
+        dictkeys_insert_index(keys, hashpos, ix, hash);
         assert(ep->me_key == NULL);
         ep->me_key = name;
         ep->me_hash = hash;
@@ -1088,7 +1569,8 @@ insertdict(PyDictObject *mp, PyObject *key, Py_hash_t hash, PyObject *value)
         }
         Py_ssize_t hashpos = find_empty_slot(mp->ma_keys, hash);
         ep = &DK_ENTRIES(mp->ma_keys)[mp->ma_keys->dk_nentries];
-        dictkeys_set_index(mp->ma_keys, hashpos, mp->ma_keys->dk_nentries);
+        dictkeys_insert_index(mp->ma_keys, hashpos, mp->ma_keys->dk_nentries,
+                              hash);
         ep->me_key = key;
         ep->me_hash = hash;
         if (mp->ma_values) {
@@ -1119,6 +1601,10 @@ insertdict(PyDictObject *mp, PyObject *key, Py_hash_t hash, PyObject *value)
                 mp->ma_used++;
             }
         }
+        else if (DK_IS_COMPACT(mp->ma_keys)) {
+            assert(old_value != NULL);
+            DK_COMPACT_ENTRIES(mp->ma_keys)[ix].me_value = value;
+        }
         else {
             assert(old_value != NULL);
             DK_ENTRIES(mp->ma_keys)[ix].me_value = value;
@@ -1144,7 +1630,7 @@ insert_to_emptydict(PyDictObject *mp, PyObject *key, Py_hash_t hash,
 {
     assert(mp->ma_keys == Py_EMPTY_KEYS);
 
-    PyDictKeysObject *newkeys = new_keys_object(PyDict_LOG_MINSIZE);
+    PyDictKeysObject *newkeys = new_keys_object(PyDict_LOG_MINSIZE, 1);
     if (newkeys == NULL) {
         Py_DECREF(key);
         Py_DECREF(value);
@@ -1161,7 +1647,7 @@ insert_to_emptydict(PyDictObject *mp, PyObject *key, Py_hash_t hash,
 
     size_t hashpos = (size_t)hash & (PyDict_MINSIZE-1);
     PyDictKeyEntry *ep = DK_ENTRIES(mp->ma_keys);
-    dictkeys_set_index(mp->ma_keys, hashpos, 0);
+    dictkeys_insert_index(mp->ma_keys, hashpos, 0, hash);
     ep->me_key = key;
     ep->me_hash = hash;
     ep->me_value = value;
@@ -1178,6 +1664,13 @@ Internal routine used by dictresize() to build a hashtable of entries.
 static void
 build_indices(PyDictKeysObject *keys, PyDictKeyEntry *ep, Py_ssize_t n)
 {
+    if (keys->dk_grouped) {
+        for (Py_ssize_t ix = 0; ix != n; ix++, ep++) {
+            dictkeys_insert_index(keys, find_empty_slot(keys, ep->me_hash),
+                                  ix, ep->me_hash);
+        }
+        return;
+    }
     size_t mask = (size_t)DK_SIZE(keys) - 1;
     for (Py_ssize_t ix = 0; ix != n; ix++, ep++) {
         Py_hash_t hash = ep->me_hash;
@@ -1221,7 +1714,8 @@ dictresize(PyDictObject *mp, uint8_t log2_newsize)
      */
 
     /* Allocate a new table. */
-    mp->ma_keys = new_keys_object(log2_newsize);
+    mp->ma_keys = new_keys_object(log2_newsize,
+                                  oldkeys->dk_kind != DICT_KEYS_GENERAL);
     if (mp->ma_keys == NULL) {
         mp->ma_keys = oldkeys;
         return -1;
@@ -1255,7 +1749,18 @@ dictresize(PyDictObject *mp, uint8_t log2_newsize)
         }
     }
     else {  // combined table.
-        if (oldkeys->dk_nentries == numentries) {
+        if (DK_IS_COMPACT(oldkeys)) {
+            PyDictCompactEntry *ep = DK_COMPACT_ENTRIES(oldkeys);
+            for (Py_ssize_t i = 0; i < numentries; i++) {
+                while (ep->me_value == NULL)
+                    ep++;
+                newentries[i].me_key = ep->me_key;
+                newentries[i].me_hash = compact_hash(ep->me_key);
+                newentries[i].me_value = ep->me_value;
+                ep++;
+            }
+        }
+        else if (oldkeys->dk_nentries == numentries) {
             memcpy(newentries, oldentries, numentries * sizeof(PyDictKeyEntry));
         }
         else {
@@ -1297,6 +1802,85 @@ dictresize(PyDictObject *mp, uint8_t log2_newsize)
     return 0;
 }
 
+/*
+Restructure a combined table of exact str keys as a compact table of
+2**log2_newsize slots.  See "Compact tables" above.
+*/
+static int
+dictcompact(PyDictObject *mp, uint8_t log2_newsize)
+{
+    PyDictKeysObject *oldkeys = mp->ma_keys;
+    PyDictKeysObject *newkeys;
+    PyDictCompactEntry *newentries;
+    Py_ssize_t numentries = mp->ma_used;
+    Py_ssize_t es;
+
+    assert(mp->ma_values == NULL);
+    assert(oldkeys->dk_kind == DICT_KEYS_UNICODE || DK_IS_COMPACT(oldkeys));
+    assert(log2_newsize >= DK_LOG_GROUP_MIN);
+    assert(USABLE_FRACTION((Py_ssize_t)1 << log2_newsize) >= numentries);
+
+    if (log2_newsize <= 15) {
+        es = 2;
+    }
+#if SIZEOF_VOID_P > 4
+    else if (log2_newsize <= 31) {
+        es = 4;
+    }
+#endif
+    else {
+        es = sizeof(Py_ssize_t);
+    }
+    newkeys = PyObject_Malloc(sizeof(PyDictKeysObject)
+                              + ((es + 1)<<log2_newsize)
+                              + sizeof(PyDictCompactEntry) * numentries);
+    if (newkeys == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    newkeys->dk_refcnt = 1;
+    newkeys->dk_log2_size = log2_newsize;
+    newkeys->dk_kind = DICT_KEYS_COMPACT;
+    newkeys->dk_grouped = 1;
+    newkeys->dk_version = 0;
+    newkeys->dk_usable = 0;
+    newkeys->dk_nentries = numentries;
+    memset(&newkeys->dk_indices[0], 0xff, es<<log2_newsize);
+    memset(DK_CTRL(newkeys), CTRL_EMPTY, (size_t)1<<log2_newsize);
+
+    /* Move the items, the references are transferred. */
+    newentries = DK_COMPACT_ENTRIES(newkeys);
+    if (DK_IS_COMPACT(oldkeys)) {
+        PyDictCompactEntry *ep = DK_COMPACT_ENTRIES(oldkeys);
+        for (Py_ssize_t i = 0; i < numentries; i++) {
+            while (ep->me_value == NULL)
+                ep++;
+            newentries[i] = *ep++;
+        }
+    }
+    else {
+        PyDictKeyEntry *ep = DK_ENTRIES(oldkeys);
+        for (Py_ssize_t i = 0; i < numentries; i++) {
+            while (ep->me_value == NULL)
+                ep++;
+            newentries[i].me_key = ep->me_key;
+            newentries[i].me_value = ep->me_value;
+            ep++;
+        }
+    }
+    for (Py_ssize_t ix = 0; ix < numentries; ix++) {
+        Py_hash_t hash = compact_hash(newentries[ix].me_key);
+        dictkeys_insert_index(newkeys, find_empty_slot(newkeys, hash),
+                              ix, hash);
+    }
+
+    assert(oldkeys->dk_refcnt == 1);
+    PyObject_Free(oldkeys);
+    mp->ma_keys = newkeys;
+    ASSERT_CONSISTENT(mp);
+    return 0;
+}
+
 PyObject *
 _PyDict_NewPresized(Py_ssize_t minused)
 {
@@ -1319,12 +1903,53 @@ _PyDict_NewPresized(Py_ssize_t minused)
         log2_newsize = estimate_log2_keysize(minused);
     }
 
-    new_keys = new_keys_object(log2_newsize);
+    new_keys = new_keys_object(log2_newsize, 1);
     if (new_keys == NULL)
         return NULL;
     return new_dict(new_keys, NULL, 0, 0);
 }
 
+/* Make room for n more items, so that inserting them does not resize the
+ * dict.  Split tables are left alone, to keep sharing their keys.
+ * n is usually a length hint: see dict_trim_reserve(). */
+static int
+dict_reserve(PyDictObject *mp, Py_ssize_t n)
+{
+    if (mp->ma_values != NULL && mp->ma_keys != Py_EMPTY_KEYS) {
+        return 0;
+    }
+    if (n <= mp->ma_keys->dk_usable) {
+        return 0;
+    }
+    if (n > (PY_SSIZE_T_MAX - mp->ma_used) / 3) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    return dictresize(mp, estimate_log2_keysize(mp->ma_used + n));
+}
+
+/* Shrink the dict if dict_reserve() made it much bigger than needed, for
+ * instance because the items it made room for had many duplicate keys. */
+static int
+dict_trim_reserve(PyDictObject *mp)
+{
+    uint8_t log2_size = calculate_log2_keysize(GROWTH_RATE(mp));
+    if (mp->ma_values == NULL && DK_LOG_SIZE(mp->ma_keys) > log2_size + 1) {
+        return dictresize(mp, log2_size);
+    }
+    return 0;
+}
+
+int
+_PyDict_Reserve(PyObject *op, Py_ssize_t n)
+{
+    if (!PyDict_Check(op) || n < 0) {
+        PyErr_BadInternalCall();
+        return -1;
+    }
+    return dict_reserve((PyDictObject *)op, n);
+}
+
 /* Note that, for historical reasons, PyDict_GetItem() suppresses all errors
  * that may occur (originally dicts supported only string keys, and exceptions
  * weren't possible).  So, while the original intent was that a NULL return
@@ -1385,7 +2010,8 @@ _PyDict_GetItemHint(PyDictObject *mp, PyObject *key,
     assert(PyDict_CheckExact((PyObject*)mp));
     assert(PyUnicode_CheckExact(key));
 
-    if (hint >= 0 && hint < mp->ma_keys->dk_nentries) {
+    if (hint >= 0 && hint < mp->ma_keys->dk_nentries &&
+            !DK_IS_COMPACT(mp->ma_keys)) {
         PyObject *res = NULL;
 
         PyDictKeyEntry *ep = DK_ENTRIES(mp->ma_keys) + (size_t)hint;
@@ -1635,6 +2261,15 @@ delitem_common(PyDictObject *mp, Py_hash_t hash, Py_ssize_t ix,
             delete_index_from_order(mp->ma_values->mv_order, ix);
         ASSERT_CONSISTENT(mp);
     }
+    else if (DK_IS_COMPACT(mp->ma_keys)) {
+        PyDictCompactEntry *cep = &DK_COMPACT_ENTRIES(mp->ma_keys)[ix];
+        mp->ma_keys->dk_version = 0;
+        dictkeys_set_index(mp->ma_keys, hashpos, DKIX_DUMMY);
+        old_key = cep->me_key;
+        cep->me_key = NULL;
+        cep->me_value = NULL;
+        Py_DECREF(old_key);
+    }
     else {
         mp->ma_keys->dk_version = 0;
         dictkeys_set_index(mp->ma_keys, hashpos, DKIX_DUMMY);
@@ -1797,6 +2432,23 @@ _PyDict_Next(PyObject *op, Py_ssize_t *ppos, PyObject **pkey,
         value = mp->ma_values->values[index];
         assert(value != NULL);
     }
+    else if (DK_IS_COMPACT(mp->ma_keys)) {
+        PyDictKeysObject *k = mp->ma_keys;
+        if (i < 0)
+            return 0;
+        i = compact_next_item(k, i);
+        if (i >= k->dk_nentries)
+            return 0;
+        PyDictCompactEntry *cep = &DK_COMPACT_ENTRIES(k)[i];
+        *ppos = i+1;
+        if (pkey)
+            *pkey = cep->me_key;
+        if (phash)
+            *phash = compact_hash(cep->me_key);
+        if (pvalue)
+            *pvalue = cep->me_value;
+        return 1;
+    }
     else {
         Py_ssize_t n = mp->ma_keys->dk_nentries;
         if (i < 0 || i >= n)
@@ -1970,12 +2622,24 @@ _PyDict_FromKeys(PyObject *cls, PyObject *iterable, PyObject *value)
     }
 
     if (PyDict_CheckExact(d)) {
+        PyDictObject *mp = (PyDictObject *)d;
+        int presized = 0;
+        if (mp->ma_used == 0) {
+            Py_ssize_t hint = PyObject_LengthHint(iterable, 0);
+            if (hint < 0 || dict_reserve(mp, hint) < 0) {
+                goto Fail;
+            }
+            presized = (hint > 0);
+        }
         while ((key = PyIter_Next(it)) != NULL) {
-            status = PyDict_SetItem(d, key, value);
-            Py_DECREF(key);
+            Py_INCREF(value);
+            status = _PyDict_SetItem_Take2(mp, key, value);
             if (status < 0)
                 goto Fail;
         }
+        if (presized && !PyErr_Occurred() && dict_trim_reserve(mp) < 0) {
+            goto Fail;
+        }
     } else {
         while ((key = PyIter_Next(it)) != NULL) {
             status = PyObject_SetItem(d, key, value);
@@ -2201,6 +2865,18 @@ dict_keys(PyDictObject *mp)
         Py_DECREF(v);
         goto again;
     }
+    if (DK_IS_COMPACT(mp->ma_keys)) {
+        PyDictCompactEntry *cep = DK_COMPACT_ENTRIES(mp->ma_keys);
+        for (i = 0, j = 0; j < n; i++) {
+            if (cep[i].me_value != NULL) {
+                PyObject *key = cep[i].me_key;
+                Py_INCREF(key);
+                PyList_SET_ITEM(v, j, key);
+                j++;
+            }
+        }
+        return v;
+    }
     ep = DK_ENTRIES(mp->ma_keys);
     if (mp->ma_values) {
         value_ptr = mp->ma_values->values;
@@ -2249,6 +2925,10 @@ dict_values(PyDictObject *mp)
         value_ptr = mp->ma_values->values;
         offset = sizeof(PyObject *);
     }
+    else if (DK_IS_COMPACT(mp->ma_keys)) {
+        value_ptr = &DK_COMPACT_ENTRIES(mp->ma_keys)[0].me_value;
+        offset = sizeof(PyDictCompactEntry);
+    }
     else {
         value_ptr = &ep[0].me_value;
         offset = sizeof(PyDictKeyEntry);
@@ -2301,6 +2981,22 @@ dict_items(PyDictObject *mp)
         goto again;
     }
     /* Nothing we do below makes any function calls. */
+    if (DK_IS_COMPACT(mp->ma_keys)) {
+        PyDictCompactEntry *cep = DK_COMPACT_ENTRIES(mp->ma_keys);
+        for (i = 0, j = 0; j < n; i++) {
+            PyObject *value = cep[i].me_value;
+            if (value != NULL) {
+                key = cep[i].me_key;
+                item = PyList_GET_ITEM(v, j);
+                Py_INCREF(key);
+                PyTuple_SET_ITEM(item, 0, key);
+                Py_INCREF(value);
+                PyTuple_SET_ITEM(item, 1, value);
+                j++;
+            }
+        }
+        return v;
+    }
     ep = DK_ENTRIES(mp->ma_keys);
     if (mp->ma_values) {
         value_ptr = mp->ma_values->values;
@@ -2414,11 +3110,21 @@ PyDict_MergeFromSeq2(PyObject *d, PyObject *seq2, int override)
     Py_ssize_t i;       /* index into seq2 of current element */
     PyObject *item;     /* seq2[i] */
     PyObject *fast;     /* item as a 2-tuple or 2-list */
+    int presized = 0;
 
     assert(d != NULL);
     assert(PyDict_Check(d));
     assert(seq2 != NULL);
 
+    /* Building a new dict: make room for all the items at once. */
+    if (PyDict_GET_SIZE(d) == 0) {
+        Py_ssize_t hint = PyObject_LengthHint(seq2, 0);
+        if (hint < 0 || dict_reserve((PyDictObject *)d, hint) < 0) {
+            return -1;
+        }
+        presized = (hint > 0);
+    }
+
     it = PyObject_GetIter(seq2);
     if (it == NULL)
         return -1;
@@ -2460,9 +3166,7 @@ PyDict_MergeFromSeq2(PyObject *d, PyObject *seq2, int override)
         Py_INCREF(key);
         Py_INCREF(value);
         if (override) {
-            if (PyDict_SetItem(d, key, value) < 0) {
-                Py_DECREF(key);
-                Py_DECREF(value);
+            if (_PyDict_SetItem_Take2((PyDictObject *)d, key, value) < 0) {
                 goto Fail;
             }
         }
@@ -2472,14 +3176,17 @@ PyDict_MergeFromSeq2(PyObject *d, PyObject *seq2, int override)
                 Py_DECREF(value);
                 goto Fail;
             }
+            Py_DECREF(key);
+            Py_DECREF(value);
         }
 
-        Py_DECREF(key);
-        Py_DECREF(value);
         Py_DECREF(fast);
         Py_DECREF(item);
     }
 
+    if (presized && dict_trim_reserve((PyDictObject *)d) < 0) {
+        goto Fail;
+    }
     i = 0;
     ASSERT_CONSISTENT(d);
     goto Return;
@@ -2568,13 +3275,21 @@ dict_merge(PyObject *a, PyObject *b, int override)
         for (i = 0, n = other->ma_keys->dk_nentries; i < n; i++) {
             PyObject *key, *value;
             Py_hash_t hash;
-            entry = &ep0[i];
-            key = entry->me_key;
-            hash = entry->me_hash;
-            if (other->ma_values)
-                value = other->ma_values->values[i];
-            else
-                value = entry->me_value;
+            if (DK_IS_COMPACT(other->ma_keys)) {
+                PyDictCompactEntry *cep = &DK_COMPACT_ENTRIES(other->ma_keys)[i];
+                key = cep->me_key;
+                value = cep->me_value;
+                hash = value != NULL ? compact_hash(key) : -1;
+            }
+            else {
+                entry = &ep0[i];
+                key = entry->me_key;
+                hash = entry->me_hash;
+                if (other->ma_values)
+                    value = other->ma_values->values[i];
+                else
+                    value = entry->me_value;
+            }
 
             if (value != NULL) {
                 int err = 0;
@@ -2630,6 +3345,14 @@ dict_merge(PyObject *a, PyObject *b, int override)
              */
             return -1;
 
+        /* Building a new dict: make room for all the items at once. */
+        int presized = (mp->ma_used == 0 && PyList_CheckExact(keys) &&
+                        PyList_GET_SIZE(keys) > 0);
+        if (presized && dict_reserve(mp, PyList_GET_SIZE(keys)) < 0) {
+            Py_DECREF(keys);
+            return -1;
+        }
+
         iter = PyObject_GetIter(keys);
         Py_DECREF(keys);
         if (iter == NULL)
@@ -2669,6 +3392,8 @@ dict_merge(PyObject *a, PyObject *b, int override)
         if (PyErr_Occurred())
             /* Iterator completed, via error */
             return -1;
+        if (presized && dict_trim_reserve(mp) < 0)
+            return -1;
     }
     ASSERT_CONSISTENT(a);
     return 0;
@@ -2848,22 +3573,32 @@ dict_equal(PyDictObject *a, PyDictObject *b)
     /* Same # of entries -- check all of 'em.  Exit early on any diff. */
     for (i = 0; i < a->ma_keys->dk_nentries; i++) {
         PyDictKeyEntry *ep = &DK_ENTRIES(a->ma_keys)[i];
-        PyObject *aval;
-        if (a->ma_values)
-            aval = a->ma_values->values[i];
-        else
-            aval = ep->me_value;
+        PyObject *aval, *key;
+        Py_hash_t hash;
+        if (DK_IS_COMPACT(a->ma_keys)) {
+            PyDictCompactEntry *cep = &DK_COMPACT_ENTRIES(a->ma_keys)[i];
+            key = cep->me_key;
+            aval = cep->me_value;
+            hash = aval != NULL ? compact_hash(key) : -1;
+        }
+        else {
+            key = ep->me_key;
+            hash = ep->me_hash;
+            if (a->ma_values)
+                aval = a->ma_values->values[i];
+            else
+                aval = ep->me_value;
+        }
         if (aval != NULL) {
             int cmp;
             PyObject *bval;
-            PyObject *key = ep->me_key;
             /* temporarily bump aval's refcount to ensure it stays
                alive until we're done with it */
             Py_INCREF(aval);
             /* ditto for key */
             Py_INCREF(key);
             /* reuse the known hash value */
-            _Py_dict_lookup(b, key, ep->me_hash, &bval);
+            _Py_dict_lookup(b, key, hash, &bval);
             if (bval == NULL) {
                 Py_DECREF(key);
                 Py_DECREF(aval);
@@ -3024,7 +3759,8 @@ PyDict_SetDefault(PyObject *d, PyObject *key, PyObject *defaultobj)
         Py_ssize_t hashpos = find_empty_slot(mp->ma_keys, hash);
         ep0 = DK_ENTRIES(mp->ma_keys);
         ep = &ep0[mp->ma_keys->dk_nentries];
-        dictkeys_set_index(mp->ma_keys, hashpos, mp->ma_keys->dk_nentries);
+        dictkeys_insert_index(mp->ma_keys, hashpos, mp->ma_keys->dk_nentries,
+                              hash);
         Py_INCREF(key);
         Py_INCREF(value);
         MAINTAIN_TRACKING(mp, key, value);
@@ -3157,23 +3893,43 @@ dict_popitem_impl(PyDictObject *self)
     self->ma_keys->dk_version = 0;
 
     /* Pop last item */
-    ep0 = DK_ENTRIES(self->ma_keys);
-    i = self->ma_keys->dk_nentries - 1;
-    while (i >= 0 && ep0[i].me_value == NULL) {
-        i--;
+    if (DK_IS_COMPACT(self->ma_keys)) {
+        PyDictCompactEntry *cep0 = DK_COMPACT_ENTRIES(self->ma_keys);
+        i = self->ma_keys->dk_nentries - 1;
+        while (i >= 0 && cep0[i].me_value == NULL) {
+            i--;
+        }
+        assert(i >= 0);
+
+        j = lookdict_index(self->ma_keys, compact_hash(cep0[i].me_key), i);
+        assert(j >= 0);
+        assert(dictkeys_get_index(self->ma_keys, j) == i);
+        dictkeys_set_index(self->ma_keys, j, DKIX_DUMMY);
+
+        PyTuple_SET_ITEM(res, 0, cep0[i].me_key);
+        PyTuple_SET_ITEM(res, 1, cep0[i].me_value);
+        cep0[i].me_key = NULL;
+        cep0[i].me_value = NULL;
     }
-    assert(i >= 0);
+    else {
+        ep0 = DK_ENTRIES(self->ma_keys);
+        i = self->ma_keys->dk_nentries - 1;
+        while (i >= 0 && ep0[i].me_value == NULL) {
+            i--;
+        }
+        assert(i >= 0);
 
-    ep = &ep0[i];
-    j = lookdict_index(self->ma_keys, ep->me_hash, i);
-    assert(j >= 0);
-    assert(dictkeys_get_index(self->ma_keys, j) == i);
-    dictkeys_set_index(self->ma_keys, j, DKIX_DUMMY);
+        ep = &ep0[i];
+        j = lookdict_index(self->ma_keys, ep->me_hash, i);
+        assert(j >= 0);
+        assert(dictkeys_get_index(self->ma_keys, j) == i);
+        dictkeys_set_index(self->ma_keys, j, DKIX_DUMMY);
 
-    PyTuple_SET_ITEM(res, 0, ep->me_key);
-    PyTuple_SET_ITEM(res, 1, ep->me_value);
-    ep->me_key = NULL;
-    ep->me_value = NULL;
+        PyTuple_SET_ITEM(res, 0, ep->me_key);
+        PyTuple_SET_ITEM(res, 1, ep->me_value);
+        ep->me_key = NULL;
+        ep->me_value = NULL;
+    }
     /* We can't dk_usable++ since there is DKIX_DUMMY in indices */
     self->ma_keys->dk_nentries = i;
     self->ma_used--;
@@ -3182,6 +3938,47 @@ dict_popitem_impl(PyDictObject *self)
     return res;
 }
 
+/*[clinic input]
+dict.compact
+
+Shrink the memory used by the dictionary to a minimum.
+
+This is meant for big dictionaries which are built once and then mostly
+read.  Inserting a new key afterwards grows the dictionary again.
+[clinic start generated code]*/
+
+static PyObject *
+dict_compact_impl(PyDictObject *self)
+/*[clinic end generated code: output=c66de97e36ae5d54 input=ef1de14609a00672]*/
+{
+    PyDictKeysObject *keys = self->ma_keys;
+    Py_ssize_t used = self->ma_used;
+
+    if (used == 0) {
+        PyDict_Clear((PyObject *)self);
+        Py_RETURN_NONE;
+    }
+    if (self->ma_values != NULL) {
+        /* Split tables share their keys and are small. */
+        Py_RETURN_NONE;
+    }
+    uint8_t log2_size = estimate_log2_keysize(used);
+    if (keys->dk_kind != DICT_KEYS_GENERAL && log2_size >= DK_LOG_GROUP_MIN) {
+        if (!DK_IS_COMPACT(keys) || DK_LOG_SIZE(keys) != log2_size
+                || keys->dk_nentries != used) {
+            if (dictcompact(self, log2_size) < 0) {
+                return NULL;
+            }
+        }
+    }
+    else if (DK_LOG_SIZE(keys) > log2_size || keys->dk_nentries != used) {
+        if (dictresize(self, log2_size) < 0) {
+            return NULL;
+        }
+    }
+    Py_RETURN_NONE;
+}
+
 static int
 dict_traverse(PyObject *op, visitproc visit, void *arg)
 {
@@ -3204,6 +4001,12 @@ dict_traverse(PyObject *op, visitproc visit, void *arg)
                 Py_VISIT(mp->ma_values->values[i]);
             }
         }
+        else if (DK_IS_COMPACT(keys)) {
+            PyDictCompactEntry *centries = DK_COMPACT_ENTRIES(keys);
+            for (i = 0; i < n; i++) {
+                Py_VISIT(centries[i].me_value);
+            }
+        }
         else {
             for (i = 0; i < n; i++) {
                 Py_VISIT(entries[i].me_value);
@@ -3225,9 +4028,7 @@ static PyObject *dictiter_new(PyDictObject *, PyTypeObject *);
 Py_ssize_t
 _PyDict_SizeOf(PyDictObject *mp)
 {
-    Py_ssize_t size, res;
-
-    size = DK_SIZE(mp->ma_keys);
+    Py_ssize_t res;
 
     res = _PyObject_SIZE(Py_TYPE(mp));
     if (mp->ma_values) {
@@ -3236,10 +4037,7 @@ _PyDict_SizeOf(PyDictObject *mp)
     /* If the dictionary is split, the keys portion is accounted-for
        in the type object. */
     if (mp->ma_keys->dk_refcnt == 1) {
-        Py_ssize_t usable = USABLE_FRACTION(size);
-        res += (sizeof(PyDictKeysObject)
-                + DK_IXSIZE(mp->ma_keys) * size
-                + sizeof(PyDictKeyEntry) * usable);
+        res += _PyDict_KeysSize(mp->ma_keys);
     }
     return res;
 }
@@ -3247,8 +4045,13 @@ _PyDict_SizeOf(PyDictObject *mp)
 Py_ssize_t
 _PyDict_KeysSize(PyDictKeysObject *keys)
 {
+    if (DK_IS_COMPACT(keys)) {
+        return (sizeof(PyDictKeysObject)
+                + (DK_IXSIZE(keys) + 1) * DK_SIZE(keys)
+                + keys->dk_nentries * sizeof(PyDictCompactEntry));
+    }
     return (sizeof(PyDictKeysObject)
-            + DK_IXSIZE(keys) * DK_SIZE(keys)
+            + (DK_IXSIZE(keys) + keys->dk_grouped) * DK_SIZE(keys)
             + USABLE_FRACTION(DK_SIZE(keys)) * sizeof(PyDictKeyEntry));
 }
 
@@ -3324,6 +4127,7 @@ static PyMethodDef mapp_methods[] = {
     DICT_SETDEFAULT_METHODDEF
     DICT_POP_METHODDEF
     DICT_POPITEM_METHODDEF
+    DICT_COMPACT_METHODDEF
     {"keys",            dictkeys_new,                   METH_NOARGS,
     keys__doc__},
     {"items",           dictitems_new,                  METH_NOARGS,
@@ -3608,6 +4412,9 @@ typedef struct {
     PyObject_HEAD
     PyDictObject *di_dict; /* Set to NULL when iterator is exhausted */
     Py_ssize_t di_used;
+    /* Borrowed, to detect entries renumbered without a change of size,
+       as done by dict.compact() */
+    PyDictKeysObject *di_keys;
     Py_ssize_t di_pos;
     PyObject* di_result; /* reusable result tuple for iteritems */
     Py_ssize_t len;
@@ -3624,6 +4431,7 @@ dictiter_new(PyDictObject *dict, PyTypeObject *itertype)
     Py_INCREF(dict);
     di->di_dict = dict;
     di->di_used = dict->ma_used;
+    di->di_keys = dict->ma_keys;
     di->len = dict->ma_used;
     if (itertype == &PyDictRevIterKey_Type ||
          itertype == &PyDictRevIterItem_Type ||
@@ -3675,7 +4483,8 @@ static PyObject *
 dictiter_len(dictiterobject *di, PyObject *Py_UNUSED(ignored))
 {
     Py_ssize_t len = 0;
-    if (di->di_dict != NULL && di->di_used == di->di_dict->ma_used)
+    if (di->di_dict != NULL && di->di_used == di->di_dict->ma_used
+        && di->di_keys == di->di_dict->ma_keys)
         len = di->len;
     return PyLong_FromSize_t(len);
 }
@@ -3714,6 +4523,12 @@ dictiter_iternextkey(dictiterobject *di)
         di->di_used = -1; /* Make this state sticky */
         return NULL;
     }
+    if (di->di_keys != d->ma_keys) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "dictionary keys changed during iteration");
+        di->di_used = -1; /* Make this state sticky */
+        return NULL;
+    }
 
     i = di->di_pos;
     k = d->ma_keys;
@@ -3725,6 +4540,12 @@ dictiter_iternextkey(dictiterobject *di)
         key = DK_ENTRIES(k)[index].me_key;
         assert(d->ma_values->values[index] != NULL);
     }
+    else if (DK_IS_COMPACT(k)) {
+        i = compact_next_item(k, i);
+        if (i >= k->dk_nentries)
+            goto fail;
+        key = DK_COMPACT_ENTRIES(k)[i].me_key;
+    }
     else {
         Py_ssize_t n = k->dk_nentries;
         PyDictKeyEntry *entry_ptr = &DK_ENTRIES(k)[i];
@@ -3803,6 +4624,12 @@ dictiter_iternextvalue(dictiterobject *di)
         di->di_used = -1; /* Make this state sticky */
         return NULL;
     }
+    if (di->di_keys != d->ma_keys) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "dictionary keys changed during iteration");
+        di->di_used = -1; /* Make this state sticky */
+        return NULL;
+    }
 
     i = di->di_pos;
     assert(i >= 0);
@@ -3813,6 +4640,12 @@ dictiter_iternextvalue(dictiterobject *di)
         value = d->ma_values->values[index];
         assert(value != NULL);
     }
+    else if (DK_IS_COMPACT(d->ma_keys)) {
+        i = compact_next_item(d->ma_keys, i);
+        if (i >= d->ma_keys->dk_nentries)
+            goto fail;
+        value = DK_COMPACT_ENTRIES(d->ma_keys)[i].me_value;
+    }
     else {
         Py_ssize_t n = d->ma_keys->dk_nentries;
         PyDictKeyEntry *entry_ptr = &DK_ENTRIES(d->ma_keys)[i];
@@ -3874,22 +4707,31 @@ PyTypeObject PyDictIterValue_Type = {
     0,
 };
 
-static PyObject *
-dictiter_iternextitem(dictiterobject *di)
+/* Advance an items iterator, storing new references to the next key and
+   value in *pkey and *pvalue.  Return 1 on success, 0 if the iterator is
+   exhausted, or -1 with an exception set. */
+static int
+dictiter_iternextpair(dictiterobject *di, PyObject **pkey, PyObject **pvalue)
 {
-    PyObject *key, *value, *result;
+    PyObject *key, *value;
     Py_ssize_t i;
     PyDictObject *d = di->di_dict;
 
     if (d == NULL)
-        return NULL;
+        return 0;
     assert (PyDict_Check(d));
 
     if (di->di_used != d->ma_used) {
         PyErr_SetString(PyExc_RuntimeError,
                         "dictionary changed size during iteration");
         di->di_used = -1; /* Make this state sticky */
-        return NULL;
+        return -1;
+    }
+    if (di->di_keys != d->ma_keys) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "dictionary keys changed during iteration");
+        di->di_used = -1; /* Make this state sticky */
+        return -1;
     }
 
     i = di->di_pos;
@@ -3902,6 +4744,13 @@ dictiter_iternextitem(dictiterobject *di)
         value = d->ma_values->values[index];
         assert(value != NULL);
     }
+    else if (DK_IS_COMPACT(d->ma_keys)) {
+        i = compact_next_item(d->ma_keys, i);
+        if (i >= d->ma_keys->dk_nentries)
+            goto fail;
+        key = DK_COMPACT_ENTRIES(d->ma_keys)[i].me_key;
+        value = DK_COMPACT_ENTRIES(d->ma_keys)[i].me_value;
+    }
     else {
         Py_ssize_t n = d->ma_keys->dk_nentries;
         PyDictKeyEntry *entry_ptr = &DK_ENTRIES(d->ma_keys)[i];
@@ -3918,12 +4767,38 @@ dictiter_iternextitem(dictiterobject *di)
     if (di->len == 0) {
         PyErr_SetString(PyExc_RuntimeError,
                         "dictionary keys changed during iteration");
-        goto fail;
+        di->di_dict = NULL;
+        Py_DECREF(d);
+        return -1;
     }
     di->di_pos = i+1;
     di->len--;
     Py_INCREF(key);
     Py_INCREF(value);
+    *pkey = key;
+    *pvalue = value;
+    return 1;
+
+fail:
+    di->di_dict = NULL;
+    Py_DECREF(d);
+    return 0;
+}
+
+int
+_PyDictIter_NextItem(PyObject *iter, PyObject **pkey, PyObject **pvalue)
+{
+    assert(Py_IS_TYPE(iter, &PyDictIterItem_Type));
+    return dictiter_iternextpair((dictiterobject *)iter, pkey, pvalue);
+}
+
+static PyObject *
+dictiter_iternextitem(dictiterobject *di)
+{
+    PyObject *key, *value, *result;
+    if (dictiter_iternextpair(di, &key, &value) <= 0) {
+        return NULL;
+    }
     result = di->di_result;
     if (Py_REFCNT(result) == 1) {
         PyObject *oldkey = PyTuple_GET_ITEM(result, 0);
@@ -3941,17 +4816,15 @@ dictiter_iternextitem(dictiterobject *di)
     }
     else {
         result = PyTuple_New(2);
-        if (result == NULL)
+        if (result == NULL) {
+            Py_DECREF(key);
+            Py_DECREF(value);
             return NULL;
+        }
         PyTuple_SET_ITEM(result, 0, key);  /* steals reference */
         PyTuple_SET_ITEM(result, 1, value);  /* steals reference */
     }
     return result;
-
-fail:
-    di->di_dict = NULL;
-    Py_DECREF(d);
-    return NULL;
 }
 
 PyTypeObject PyDictIterItem_Type = {
@@ -4006,6 +4879,12 @@ dictreviter_iternext(dictiterobject *di)
         di->di_used = -1; /* Make this state sticky */
         return NULL;
     }
+    if (di->di_keys != d->ma_keys) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "dictionary keys changed during iteration");
+        di->di_used = -1; /* Make this state sticky */
+        return NULL;
+    }
 
     Py_ssize_t i = di->di_pos;
     PyDictKeysObject *k = d->ma_keys;
@@ -4020,6 +4899,17 @@ dictreviter_iternext(dictiterobject *di)
         value = d->ma_values->values[index];
         assert (value != NULL);
     }
+    else if (DK_IS_COMPACT(k)) {
+        PyDictCompactEntry *entry_ptr = &DK_COMPACT_ENTRIES(k)[i];
+        while (entry_ptr->me_value == NULL) {
+            if (--i < 0) {
+                goto fail;
+            }
+            entry_ptr--;
+        }
+        key = entry_ptr->me_key;
+        value = entry_ptr->me_value;
+    }
     else {
         PyDictKeyEntry *entry_ptr = &DK_ENTRIES(k)[i];
         while (entry_ptr->me_value == NULL) {
@@ -4942,7 +5832,7 @@ dictvalues_reversed(_PyDictViewObject *dv, PyObject *Py_UNUSED(ignored))
 PyDictKeysObject *
 _PyDict_NewKeysForClass(void)
 {
-    PyDictKeysObject *keys = new_keys_object(5); /* log2(32) */
+    PyDictKeysObject *keys = new_keys_object(5, 1); /* log2(32) */
     if (keys == NULL) {
         PyErr_Clear();
     }
@@ -5252,6 +6142,10 @@ static uint32_t next_dict_keys_version = 2;
 
 uint32_t _PyDictKeys_GetVersionForCurrentState(PyDictKeysObject *dictkeys)
 {
+    if (DK_IS_COMPACT(dictkeys)) {
+        /* The specialized instructions read entries of regular tables */
+        return 0;
+    }
     if (dictkeys->dk_version != 0) {
         return dictkeys->dk_version;
     }
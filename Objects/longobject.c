@@ -73,6 +73,11 @@ maybe_small_long(PyLongObject *v)
 #define KARATSUBA_CUTOFF 70
 #define KARATSUBA_SQUARE_CUTOFF (2 * KARATSUBA_CUTOFF)
 
+/* Above Karatsuba, switch to Toom-3 when both operands have at least
+ * TOOM3_CUTOFF digits and their sizes are balanced enough, see k_mul().
+ */
+#define TOOM3_CUTOFF 400
+
 /* For exponentiation, use the binary left-to-right algorithm
  * unless the exponent contains more than FIVEARY_CUTOFF digits.
  * In that case, do 5 bits at a time.  The potential drawback is that
@@ -80,6 +85,20 @@ maybe_small_long(PyLongObject *v)
  */
 #define FIVEARY_CUTOFF 8
 
+/* Conversions between int and decimal str are quadratic-time below.  For
+ * inputs larger than these cutoffs, they are delegated to the
+ * divide-and-conquer algorithms in Lib/_pylong.py, whose cost is dominated
+ * by a few big multiplications.
+ */
+#define TO_DECIMAL_DC_CUTOFF_BITS 30000     /* about 9000 decimal digits */
+#define FROM_DECIMAL_DC_CUTOFF 6000         /* in decimal digits */
+
+/* Likewise, divmod() switches to _pylong's Burnikel-Ziegler division when
+ * both the divisor and the quotient are at least this many bits.  It must
+ * stay above _DIVLIM in _pylong.py.
+ */
+#define DIVMOD_DC_CUTOFF_BITS 9000
+
 #define SIGCHECK(PyTryBlock)                    \
     do {                                        \
         if (PyErr_CheckSignals()) PyTryBlock    \
@@ -233,6 +252,36 @@ _PyLong_FromSTwoDigits(stwodigits x)
     return _PyLong_FromLarge(x);
 }
 
+/* Store an int with the value ival into *target, replacing (and releasing)
+   the object previously stored there, which may be NULL.  If the old
+   object is a single-digit int that nothing else refers to, it is
+   updated in place instead of allocating a new object.  Used by the
+   interpreter to assign the loop variable when iterating over a range. */
+int
+_PyLong_AssignValue(PyObject **target, long ival)
+{
+    PyObject *old = *target;
+    if (IS_SMALL_INT(ival)) {
+        *target = get_small_int((sdigit)ival);
+        Py_XDECREF(old);
+        return 0;
+    }
+    if (old != NULL && PyLong_CheckExact(old) && Py_REFCNT(old) == 1 &&
+        Py_SIZE(old) == 1 && ival > 0 && (unsigned long)ival <= PyLong_MASK)
+    {
+        /* Only positive values, as range iteration is typically ascending
+           from zero.  A small int is never uniquely referenced. */
+        ((PyLongObject *)old)->ob_digit[0] = (digit)ival;
+        return 0;
+    }
+    *target = PyLong_FromLong(ival);
+    Py_XDECREF(old);
+    if (*target == NULL) {
+        return -1;
+    }
+    return 0;
+}
+
 /* If a freshly-allocated int is already shared, it must
    be a small integer, so negating it must go to PyLong_FromLong */
 Py_LOCAL_INLINE(void)
@@ -1630,6 +1679,67 @@ divrem1(PyLongObject *a, digit n, digit *prem)
     return long_normalize(z);
 }
 
+/* Convert a huge integer to a base 10 string with
+   _pylong.int_to_decimal_string(), and write it like
+   long_to_decimal_string_internal() does. */
+
+static int
+pylong_int_to_decimal_string(PyObject *aa,
+                             PyObject **p_output,
+                             _PyUnicodeWriter *writer,
+                             _PyBytesWriter *bytes_writer,
+                             char **bytes_str)
+{
+    PyObject *mod, *s;
+    Py_ssize_t size;
+
+    mod = PyImport_ImportModule("_pylong");
+    if (mod == NULL) {
+        return -1;
+    }
+    s = PyObject_CallMethod(mod, "int_to_decimal_string", "O", aa);
+    Py_DECREF(mod);
+    if (s == NULL) {
+        return -1;
+    }
+    if (!PyUnicode_CheckExact(s) || !PyUnicode_IS_ASCII(s)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "_pylong.int_to_decimal_string() did not return "
+                        "an ASCII str");
+        goto error;
+    }
+    size = PyUnicode_GET_LENGTH(s);
+    if (writer) {
+        if (_PyUnicodeWriter_WriteStr(writer, s) < 0) {
+            goto error;
+        }
+    }
+    else if (bytes_writer) {
+        *bytes_str = _PyBytesWriter_WriteBytes(bytes_writer, *bytes_str,
+                                               PyUnicode_DATA(s), size);
+        if (*bytes_str == NULL) {
+            goto error;
+        }
+    }
+    else {
+        /* The result must not be shared, see below. */
+        if (Py_REFCNT(s) != 1) {
+            Py_SETREF(s, _PyUnicode_Copy(s));
+            if (s == NULL) {
+                return -1;
+            }
+        }
+        *p_output = s;
+        return 0;
+    }
+    Py_DECREF(s);
+    return 0;
+
+  error:
+    Py_DECREF(s);
+    return -1;
+}
+
 /* Convert an integer to a base 10 string.  Returns a new non-shared
    string.  (Return value is non-shared so that callers can modify the
    returned value if necessary.) */
@@ -1657,6 +1767,11 @@ long_to_decimal_string_internal(PyObject *aa,
     size_a = Py_ABS(Py_SIZE(a));
     negative = Py_SIZE(a) < 0;
 
+    if (size_a > TO_DECIMAL_DC_CUTOFF_BITS / PyLong_SHIFT) {
+        return pylong_int_to_decimal_string(aa, p_output, writer,
+                                            bytes_writer, bytes_str);
+    }
+
     /* quick and dirty upper bound for the number of digits
        required to express a in base _PyLong_DECIMAL_BASE:
 
@@ -2160,6 +2275,37 @@ long_from_binary_base(const char **str, int base, PyLongObject **res)
     return 0;
 }
 
+/* Convert the decimal digits in [start, end) with
+ * _pylong.int_from_string().  The digits, with single underscores between
+ * them, have already been validated by the caller.  The result may be a
+ * shared small int.
+ */
+static PyLongObject *
+pylong_int_from_string(const char *start, const char *end)
+{
+    PyObject *mod, *s, *result;
+
+    mod = PyImport_ImportModule("_pylong");
+    if (mod == NULL) {
+        return NULL;
+    }
+    s = PyUnicode_FromStringAndSize(start, end - start);
+    if (s == NULL) {
+        Py_DECREF(mod);
+        return NULL;
+    }
+    result = PyObject_CallMethod(mod, "int_from_string", "O", s);
+    Py_DECREF(s);
+    Py_DECREF(mod);
+    if (result != NULL && !PyLong_CheckExact(result)) {
+        Py_DECREF(result);
+        PyErr_SetString(PyExc_TypeError,
+                        "_pylong.int_from_string() did not return an int");
+        return NULL;
+    }
+    return (PyLongObject *)result;
+}
+
 /* Parses an int from a bytestring. Leading and trailing whitespace will be
  * ignored.
  *
@@ -2240,6 +2386,8 @@ PyLong_FromString(const char *str, char **pend, int base)
 Binary bases can be converted in time linear in the number of digits, because
 Python's representation base is binary.  Other bases (including decimal!) use
 the simple quadratic-time algorithm below, complicated by some speed tricks.
+(Decimal inputs longer than FROM_DECIMAL_DC_CUTOFF digits are handed to the
+subquadratic _pylong.int_from_string() instead.)
 
 First some math:  the largest integer that can be expressed in N base-B digits
 is B**N-1.  Consequently, if we have an N-digit input in base B, the worst-
@@ -2380,6 +2528,23 @@ digit beyond the first.
             goto onError;
         }
 
+        if (base == 10 && digits > FROM_DECIMAL_DC_CUTOFF) {
+            z = pylong_int_from_string(str, scan);
+            if (z == NULL) {
+                return NULL;
+            }
+            /* z may be shared, negate it here rather than in place below */
+            if (sign < 0) {
+                _PyLong_Negate(&z);
+                if (z == NULL) {
+                    return NULL;
+                }
+                sign = 1;
+            }
+            str = scan;
+            goto digits_done;
+        }
+
         /* Create an int object that can contain the largest possible
          * integer with this base and length.  Note that there's no
          * need to initialize z->ob_digit -- no slot is read up before
@@ -2472,6 +2637,7 @@ digit beyond the first.
             }
         }
     }
+  digits_done:
     if (z == NULL) {
         return NULL;
     }
@@ -3314,6 +3480,7 @@ kmul_split(PyLongObject *n,
 }
 
 static PyLongObject *k_lopsided_mul(PyLongObject *a, PyLongObject *b);
+static PyLongObject *toom3_mul(PyLongObject *a, PyLongObject *b);
 
 /* Karatsuba multiplication.  Ignores the input signs, and returns the
  * absolute value of the product (or NULL if error).
@@ -3372,6 +3539,13 @@ k_mul(PyLongObject *a, PyLongObject *b)
     if (2 * asize <= bsize)
         return k_lopsided_mul(a, b);
 
+    /* Toom-3 splits b in three pieces of k = ceil(bsize/3) digits, and
+     * needs a's top piece to be nonempty.  Otherwise a Karatsuba step
+     * leaves more balanced products, which come back here.
+     */
+    if (asize >= TOOM3_CUTOFF && asize > 2 * ((bsize + 2) / 3))
+        return toom3_mul(a, b);
+
     /* Split a & b into hi & lo pieces. */
     shift = bsize >> 1;
     if (kmul_split(a, shift, &ah, &al) < 0) goto fail;
@@ -3594,6 +3768,217 @@ k_lopsided_mul(PyLongObject *a, PyLongObject *b)
     return NULL;
 }
 
+/* Signed product, for the evaluations in toom3_mul() that can be
+ * negative.
+ */
+static PyLongObject *
+t3_signed_mul(PyLongObject *a, PyLongObject *b)
+{
+    PyLongObject *z = k_mul(a, b);
+    if (z != NULL && (Py_SIZE(a) ^ Py_SIZE(b)) < 0)
+        _PyLong_Negate(&z);
+    return z;
+}
+
+/* Exact division of a signed integer by 3. */
+static PyLongObject *
+t3_divexact3(PyLongObject *x)
+{
+    digit rem;
+    PyLongObject *z = divrem1(x, 3, &rem);
+    assert(z == NULL || rem == 0);
+    if (z != NULL && Py_SIZE(x) < 0)
+        _PyLong_Negate(&z);
+    return z;
+}
+
+/* Split n in three k-digit pieces, n = n2*X**2 + n1*X + n0 with
+ * X = BASE**k, and evaluate that polynomial at 0, 1, -1, -2 and infinity,
+ * into v[0..4].  Returns 0 on success, -1 on failure (v is then cleared).
+ */
+static int
+t3_eval(PyLongObject *n, Py_ssize_t k, PyLongObject *v[5])
+{
+    PyLongObject *rest = NULL, *n1 = NULL, *p = NULL, *t;
+    int i;
+
+    for (i = 0; i < 5; i++)
+        v[i] = NULL;
+    if (kmul_split(n, k, &rest, &v[0]) < 0)
+        goto fail;
+    if (kmul_split(rest, k, &v[4], &n1) < 0)
+        goto fail;
+    Py_CLEAR(rest);
+
+    /* p = n0 + n2; v(1) = p + n1; v(-1) = p - n1 */
+    if ((p = x_add(v[0], v[4])) == NULL)
+        goto fail;
+    if ((v[1] = (PyLongObject *)_PyLong_Add(p, n1)) == NULL)
+        goto fail;
+    if ((v[2] = (PyLongObject *)_PyLong_Subtract(p, n1)) == NULL)
+        goto fail;
+    Py_CLEAR(p);
+    Py_CLEAR(n1);
+
+    /* v(-2) = (v(-1) + n2)*2 - n0 */
+    if ((t = (PyLongObject *)_PyLong_Add(v[2], v[4])) == NULL)
+        goto fail;
+    p = (PyLongObject *)_PyLong_Lshift((PyObject *)t, 1);
+    Py_DECREF(t);
+    if (p == NULL)
+        goto fail;
+    if ((v[3] = (PyLongObject *)_PyLong_Subtract(p, v[0])) == NULL)
+        goto fail;
+    Py_DECREF(p);
+    return 0;
+
+  fail:
+    Py_XDECREF(rest);
+    Py_XDECREF(n1);
+    Py_XDECREF(p);
+    for (i = 0; i < 5; i++)
+        Py_CLEAR(v[i]);
+    return -1;
+}
+
+/* Toom-Cook 3-way multiplication.  Like k_mul(), ignores the input signs
+ * and returns the absolute value of the product (or NULL if error).
+ *
+ * Both inputs are split in three pieces of k digits, viewed as polynomials
+ * in X = BASE**k, and their product polynomial is recovered from its values
+ * at 5 points: 5 multiplications on numbers a third of the size, instead of
+ * the 9 of the schoolbook method.  The evaluation and interpolation
+ * sequences are Bodrato's, see "Towards Optimal Toom-Cook Multiplication
+ * for Univariate and Multivariate Polynomials in Characteristic 2 and 0"
+ * (WAIFI 2007).
+ *
+ * Called by k_mul() with asize <= bsize and asize > 2*k.
+ */
+static PyLongObject *
+toom3_mul(PyLongObject *a, PyLongObject *b)
+{
+    const Py_ssize_t asize = Py_ABS(Py_SIZE(a));
+    const Py_ssize_t bsize = Py_ABS(Py_SIZE(b));
+    const Py_ssize_t k = (bsize + 2) / 3;
+    PyLongObject *u[5], *v[5], *w[5] = {NULL, NULL, NULL, NULL, NULL};
+    PyLongObject *ret = NULL, *t, *t2;
+    int i, failed;
+
+    assert(asize <= bsize);
+    assert(asize > 2 * k);
+
+    if (t3_eval(a, k, u) < 0)
+        return NULL;
+    if (a == b) {
+        for (i = 0; i < 5; i++) {
+            v[i] = u[i];
+            Py_INCREF(v[i]);
+        }
+    }
+    else if (t3_eval(b, k, v) < 0) {
+        for (i = 0; i < 5; i++)
+            Py_DECREF(u[i]);
+        return NULL;
+    }
+
+    /* Pointwise products; u[i] == v[i] when squaring, which k_mul()
+     * takes advantage of.
+     */
+    for (i = 0; i < 5; i++) {
+        w[i] = t3_signed_mul(u[i], v[i]);
+        if (w[i] == NULL)
+            break;
+    }
+    failed = i < 5;
+    for (i = 0; i < 5; i++) {
+        Py_DECREF(u[i]);
+        Py_DECREF(v[i]);
+    }
+    if (failed)
+        goto fail;
+
+    /* Interpolate.  w[] holds r(0), r(1), r(-1), r(-2), r(inf) on entry,
+     * and the coefficients c0 .. c4 of the product on exit:
+     *
+     *     c3 = (r(-2) - r(1)) / 3
+     *     c1 = (r(1) - r(-1)) / 2
+     *     c2 = r(-1) - r(0)
+     *     c3 = (c2 - c3) / 2 + 2*r(inf)
+     *     c2 = c2 + c1 - r(inf)
+     *     c1 = c1 - c3
+     */
+    if ((t = (PyLongObject *)_PyLong_Subtract(w[3], w[1])) == NULL)
+        goto fail;
+    Py_SETREF(w[3], t3_divexact3(t));
+    Py_DECREF(t);
+    if (w[3] == NULL)
+        goto fail;
+
+    if ((t = (PyLongObject *)_PyLong_Subtract(w[1], w[2])) == NULL)
+        goto fail;
+    Py_SETREF(w[1], (PyLongObject *)_PyLong_Rshift((PyObject *)t, 1));
+    Py_DECREF(t);
+    if (w[1] == NULL)
+        goto fail;
+
+    Py_SETREF(w[2], (PyLongObject *)_PyLong_Subtract(w[2], w[0]));
+    if (w[2] == NULL)
+        goto fail;
+
+    if ((t = (PyLongObject *)_PyLong_Subtract(w[2], w[3])) == NULL)
+        goto fail;
+    t2 = (PyLongObject *)_PyLong_Rshift((PyObject *)t, 1);
+    Py_DECREF(t);
+    if (t2 == NULL)
+        goto fail;
+    t = (PyLongObject *)_PyLong_Lshift((PyObject *)w[4], 1);
+    if (t == NULL) {
+        Py_DECREF(t2);
+        goto fail;
+    }
+    Py_SETREF(w[3], (PyLongObject *)_PyLong_Add(t2, t));
+    Py_DECREF(t);
+    Py_DECREF(t2);
+    if (w[3] == NULL)
+        goto fail;
+
+    if ((t = (PyLongObject *)_PyLong_Add(w[2], w[1])) == NULL)
+        goto fail;
+    Py_SETREF(w[2], (PyLongObject *)_PyLong_Subtract(t, w[4]));
+    Py_DECREF(t);
+    if (w[2] == NULL)
+        goto fail;
+
+    Py_SETREF(w[1], (PyLongObject *)_PyLong_Subtract(w[1], w[3]));
+    if (w[1] == NULL)
+        goto fail;
+
+    /* Recompose.  Every coefficient is a sum of products of pieces, so it
+     * is >= 0, and since c[i]*X**i <= a*b, each fits in the digits above
+     * i*k.
+     */
+    ret = _PyLong_New(asize + bsize);
+    if (ret == NULL)
+        goto fail;
+    memset(ret->ob_digit, 0, Py_SIZE(ret) * sizeof(digit));
+    for (i = 0; i < 5; i++) {
+        assert(Py_SIZE(w[i]) >= 0);
+        if (Py_SIZE(w[i]) == 0)
+            continue;
+        assert(i * k + Py_SIZE(w[i]) <= Py_SIZE(ret));
+        (void)v_iadd(ret->ob_digit + i * k, Py_SIZE(ret) - i * k,
+                     w[i]->ob_digit, Py_SIZE(w[i]));
+    }
+    for (i = 0; i < 5; i++)
+        Py_DECREF(w[i]);
+    return long_normalize(ret);
+
+  fail:
+    for (i = 0; i < 5; i++)
+        Py_XDECREF(w[i]);
+    return NULL;
+}
+
 PyObject *
 _PyLong_Multiply(PyLongObject *a, PyLongObject *b)
 {
@@ -3668,6 +4053,44 @@ fast_floor_div(PyLongObject *a, PyLongObject *b)
     return PyLong_FromLong(div);
 }
 
+/* Compute divmod(v, w) with _pylong.int_divmod(). */
+static int
+pylong_int_divmod(PyLongObject *v, PyLongObject *w,
+                  PyLongObject **pdiv, PyLongObject **pmod)
+{
+    PyObject *mod, *result, *q, *r;
+
+    mod = PyImport_ImportModule("_pylong");
+    if (mod == NULL) {
+        return -1;
+    }
+    result = PyObject_CallMethod(mod, "int_divmod", "OO", v, w);
+    Py_DECREF(mod);
+    if (result == NULL) {
+        return -1;
+    }
+    if (!PyTuple_Check(result) || PyTuple_GET_SIZE(result) != 2 ||
+        !PyLong_CheckExact(q = PyTuple_GET_ITEM(result, 0)) ||
+        !PyLong_CheckExact(r = PyTuple_GET_ITEM(result, 1)))
+    {
+        Py_DECREF(result);
+        PyErr_SetString(PyExc_TypeError,
+                        "_pylong.int_divmod() did not return "
+                        "a pair of ints");
+        return -1;
+    }
+    if (pdiv != NULL) {
+        Py_INCREF(q);
+        *pdiv = (PyLongObject *)q;
+    }
+    if (pmod != NULL) {
+        Py_INCREF(r);
+        *pmod = (PyLongObject *)r;
+    }
+    Py_DECREF(result);
+    return 0;
+}
+
 /* The / and % operators are now defined in terms of divmod().
    The expression a mod b has the value a - b*floor(a/b).
    The long_divrem function gives the remainder after division of
@@ -3694,8 +4117,9 @@ l_divmod(PyLongObject *v, PyLongObject *w,
          PyLongObject **pdiv, PyLongObject **pmod)
 {
     PyLongObject *div, *mod;
+    Py_ssize_t size_v = Py_ABS(Py_SIZE(v)), size_w = Py_ABS(Py_SIZE(w));
 
-    if (Py_ABS(Py_SIZE(v)) == 1 && Py_ABS(Py_SIZE(w)) == 1) {
+    if (size_v == 1 && size_w == 1) {
         /* Fast path for single-digit longs */
         div = NULL;
         if (pdiv != NULL) {
@@ -3719,6 +4143,10 @@ l_divmod(PyLongObject *v, PyLongObject *w,
         }
         return 0;
     }
+    if (size_w > DIVMOD_DC_CUTOFF_BITS / PyLong_SHIFT &&
+        size_v - size_w > DIVMOD_DC_CUTOFF_BITS / PyLong_SHIFT) {
+        return pylong_int_divmod(v, w, pdiv, pmod);
+    }
     if (long_divrem(v, w, &div, &mod) < 0)
         return -1;
     if ((Py_SIZE(mod) < 0 && Py_SIZE(w) > 0) ||
@@ -970,6 +970,13 @@ static int running_on_valgrind = -1;
 #   error "arena size not an exact multiple of pool size"
 #endif
 
+/* Can the memory of empty pools be handed back to the OS?  See
+ * trim_free_pools().
+ */
+#if defined(ARENAS_USE_MMAP) && defined(HAVE_MADVISE) && defined(MADV_DONTNEED)
+#  define WITH_POOL_TRIM
+#endif
+
 /*
  * -- End of tunable settings section --
  */
@@ -994,6 +1001,8 @@ struct pool_header {
 
 typedef struct pool_header *poolp;
 
+#define TRIMMED_MAP_WORDS   ((MAX_POOLS_IN_ARENA + 63) / 64)
+
 /* Record keeping for arenas. */
 struct arena_object {
     /* The address of the arena, as returned by malloc.  Note that 0
@@ -1017,6 +1026,12 @@ struct arena_object {
     /* Singly-linked list of available pools. */
     struct pool_header* freepools;
 
+    /* Bitmap of the pools whose memory was handed back to the OS by
+     * trim_free_pools(), by index from the first pool-aligned address.
+     * They are counted in nfreepools, but aren't in the freepools list.
+     */
+    uint64_t trimmedpools[TRIMMED_MAP_WORDS];
+
     /* Whenever this arena_object is not associated with an allocated
      * arena, the nextarena member is used to link all unassociated
      * arena_objects in the singly-linked `unused_arena_objects` list.
@@ -1039,6 +1054,9 @@ struct arena_object {
 
 #define DUMMY_SIZE_IDX          0xffff  /* size class of newly cached pools */
 
+/* Return the first pool-aligned address in arena AO, as a poolp */
+#define FIRST_POOL(AO) ((poolp)_Py_ALIGN_UP((AO)->address, POOL_SIZE))
+
 /* Round pointer P down to the closest pool-aligned address <= P, as a poolp */
 #define POOL_ADDR(P) ((poolp)_Py_ALIGN_DOWN((P), POOL_SIZE))
 
@@ -1568,6 +1586,10 @@ new_arena(void)
     if (debug_stats == -1) {
         const char *opt = Py_GETENV("PYTHONMALLOCSTATS");
         debug_stats = (opt != NULL && *opt != '\0');
+        opt = Py_GETENV("PYTHONMALLOCTRIM");
+        if (opt != NULL && *opt != '\0') {
+            _PyObject_SetMallocTrimInterval(strtol(opt, NULL, 10));
+        }
     }
     if (debug_stats)
         _PyObject_DebugMallocStats(stderr);
@@ -1644,6 +1666,7 @@ new_arena(void)
     if (narenas_currently_allocated > narenas_highwater)
         narenas_highwater = narenas_currently_allocated;
     arenaobj->freepools = NULL;
+    memset(arenaobj->trimmedpools, 0, sizeof(arenaobj->trimmedpools));
     /* pool_address <- first pool-aligned address in the arena
        nfreepools <- number of whole pools that fit after alignment */
     arenaobj->pool_address = (block*)arenaobj->address;
@@ -1786,6 +1809,40 @@ pymalloc_pool_extend(poolp pool, uint size)
     pool->nextpool = next;
 }
 
+#ifndef NDEBUG
+static int
+has_trimmed_pools(struct arena_object *ao)
+{
+    for (uint i = 0; i < TRIMMED_MAP_WORDS; i++) {
+        if (ao->trimmedpools[i] != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+#endif
+
+/* Unmark and return the trimmed pool of ao with the lowest address,
+ * or NULL if there is none.  Its header has to be initialized.
+ */
+static poolp
+take_trimmed_pool(struct arena_object *ao)
+{
+    for (uint i = 0; i < TRIMMED_MAP_WORDS; i++) {
+        uint64_t word = ao->trimmedpools[i];
+        if (word != 0) {
+            uint j = 0;
+            while (!(word & ((uint64_t)1 << j))) {
+                j++;
+            }
+            ao->trimmedpools[i] = word & ~((uint64_t)1 << j);
+            return (poolp)((block *)FIRST_POOL(ao) +
+                           (size_t)(i * 64 + j) * POOL_SIZE);
+        }
+    }
+    return NULL;
+}
+
 /* called when pymalloc_alloc can not allocate a block from usedpool.
  * This function takes new pool and allocate a block from it.
  */
@@ -1855,20 +1912,24 @@ allocate_from_new_pool(uint size)
             assert(usable_arenas->freepools != NULL ||
                    usable_arenas->pool_address <=
                    (block*)usable_arenas->address +
-                       ARENA_SIZE - POOL_SIZE);
+                       ARENA_SIZE - POOL_SIZE ||
+                   has_trimmed_pools(usable_arenas));
         }
     }
     else {
-        /* Carve off a new pool. */
         assert(usable_arenas->nfreepools > 0);
         assert(usable_arenas->freepools == NULL);
-        pool = (poolp)usable_arenas->pool_address;
-        assert((block*)pool <= (block*)usable_arenas->address +
-                                 ARENA_SIZE - POOL_SIZE);
+        pool = take_trimmed_pool(usable_arenas);
+        if (pool == NULL) {
+            /* Carve off a new pool. */
+            pool = (poolp)usable_arenas->pool_address;
+            assert((block*)pool <= (block*)usable_arenas->address +
+                                     ARENA_SIZE - POOL_SIZE);
+            usable_arenas->pool_address += POOL_SIZE;
+        }
         pool->arenaindex = (uint)(usable_arenas - arenas);
         assert(&arenas[pool->arenaindex] == usable_arenas);
         pool->szidx = DUMMY_SIZE_IDX;
-        usable_arenas->pool_address += POOL_SIZE;
         --usable_arenas->nfreepools;
 
         if (usable_arenas->nfreepools == 0) {
@@ -2025,6 +2086,55 @@ insert_to_usedpool(poolp pool)
     prev->nextpool = pool;
 }
 
+/* Unlink ao, all of whose pools are free, from usable_arenas and return
+ * its arena to the system.  The caller must have taken care of nfp2lasta.
+ */
+static void
+release_arena(struct arena_object *ao)
+{
+    assert(ao->nfreepools == ao->ntotalpools);
+    assert(ao->prevarena == NULL ||
+           ao->prevarena->address != 0);
+    assert(ao ->nextarena == NULL ||
+           ao->nextarena->address != 0);
+
+    /* Fix the pointer in the prevarena, or the
+     * usable_arenas pointer.
+     */
+    if (ao->prevarena == NULL) {
+        usable_arenas = ao->nextarena;
+        assert(usable_arenas == NULL ||
+               usable_arenas->address != 0);
+    }
+    else {
+        assert(ao->prevarena->nextarena == ao);
+        ao->prevarena->nextarena =
+            ao->nextarena;
+    }
+    /* Fix the pointer in the nextarena. */
+    if (ao->nextarena != NULL) {
+        assert(ao->nextarena->prevarena == ao);
+        ao->nextarena->prevarena =
+            ao->prevarena;
+    }
+    /* Record that this arena_object slot is
+     * available to be reused.
+     */
+    ao->nextarena = unused_arena_objects;
+    unused_arena_objects = ao;
+
+#if WITH_PYMALLOC_RADIX_TREE
+    /* mark arena region as not under control of obmalloc */
+    arena_map_mark_used(ao->address, 0);
+#endif
+
+    /* Free the entire arena. */
+    _PyObject_Arena.free(_PyObject_Arena.ctx,
+                         (void *)ao->address, ARENA_SIZE);
+    ao->address = 0;                        /* mark unassociated */
+    --narenas_currently_allocated;
+}
+
 static void
 insert_to_freepool(poolp pool)
 {
@@ -2065,7 +2175,9 @@ insert_to_freepool(poolp pool)
      *    keeping one wholly free arena in the list avoids
      *    pathological cases where a simple loop would
      *    otherwise provoke needing to allocate and free an
-     *    arena on every iteration.  See bpo-37257.
+     *    arena on every iteration.  See bpo-37257.  If
+     *    trimming is enabled, a later trimming pass releases
+     *    it once it has stayed free for a while.
      * 2. If this is the only free pool in the arena,
      *    add the arena back to the `usable_arenas` list.
      * 3. If the "next" arena has a smaller count of free
@@ -2075,49 +2187,8 @@ insert_to_freepool(poolp pool)
      * 4. Else there's nothing more to do.
      */
     if (nf == ao->ntotalpools && ao->nextarena != NULL) {
-        /* Case 1.  First unlink ao from usable_arenas.
-         */
-        assert(ao->prevarena == NULL ||
-               ao->prevarena->address != 0);
-        assert(ao ->nextarena == NULL ||
-               ao->nextarena->address != 0);
-
-        /* Fix the pointer in the prevarena, or the
-         * usable_arenas pointer.
-         */
-        if (ao->prevarena == NULL) {
-            usable_arenas = ao->nextarena;
-            assert(usable_arenas == NULL ||
-                   usable_arenas->address != 0);
-        }
-        else {
-            assert(ao->prevarena->nextarena == ao);
-            ao->prevarena->nextarena =
-                ao->nextarena;
-        }
-        /* Fix the pointer in the nextarena. */
-        if (ao->nextarena != NULL) {
-            assert(ao->nextarena->prevarena == ao);
-            ao->nextarena->prevarena =
-                ao->prevarena;
-        }
-        /* Record that this arena_object slot is
-         * available to be reused.
-         */
-        ao->nextarena = unused_arena_objects;
-        unused_arena_objects = ao;
-
-#if WITH_PYMALLOC_RADIX_TREE
-        /* mark arena region as not under control of obmalloc */
-        arena_map_mark_used(ao->address, 0);
-#endif
-
-        /* Free the entire arena. */
-        _PyObject_Arena.free(_PyObject_Arena.ctx,
-                             (void *)ao->address, ARENA_SIZE);
-        ao->address = 0;                        /* mark unassociated */
-        --narenas_currently_allocated;
-
+        /* Case 1. */
+        release_arena(ao);
         return;
     }
 
@@ -2192,6 +2263,128 @@ insert_to_freepool(poolp pool)
            || ao->prevarena->nextarena == ao);
 }
 
+/*==========================================================================
+Trimming of empty pools.
+
+Arenas are only returned to the system when all of their pools are empty, so
+a long running process which went through a peak of allocations typically
+keeps many partially used arenas, and the empty pools in them stay resident.
+
+If trimming is enabled (PYTHONMALLOCTRIM=N, or
+sys._set_obmalloc_trim_interval(N)), a trimming pass is run every N times a
+pool becomes empty.  It hands the memory of the empty pools back to the OS
+with madvise(MADV_DONTNEED).  MADV_FREE would be cheaper, but the pages
+would only be reclaimed under memory pressure, so the RSS wouldn't shrink.
+The pool header, which linked the pool into its arena's freepools list, is
+lost with the pages:  a trimmed pool is recorded in its arena's
+trimmedpools bitmap instead, and allocate_from_new_pool() takes it from
+there when the freepools list is empty, before carving off a new pool.  As
+the lowest trimmed pool is reused first, allocations stay packed at the
+start of the arena.
+
+A pass also releases the arenas all of whose pools are empty, including the
+one insert_to_freepool() keeps to avoid thrashing.
+
+To avoid madvise()ing a pool and faulting its pages in again over and over
+when a loop keeps emptying and reusing it, a pass only trims the pools that
+were already empty at the previous pass, and only releases an arena if all
+of its free pools were.  pool->prevpool isn't used by the freepools list;
+a pass marks the empty pools it sees by pointing it to the pool itself.
+allocate_from_new_pool() links a reused pool into usedpools, which clears
+the mark.  sys._obmalloc_trim() runs a pass which doesn't wait for pools to
+age.
+*/
+
+/* Run a trimming pass every trim_interval times a pool becomes empty,
+ * or never if it is 0.
+ */
+static Py_ssize_t trim_interval = 0;
+static Py_ssize_t trim_countdown = 0;
+
+#ifdef WITH_POOL_TRIM
+/* Can the memory of pools be discarded? */
+static int
+can_trim_pools(void)
+{
+    static long page_size = 0;
+
+    if (page_size == 0) {
+        page_size = sysconf(_SC_PAGESIZE);
+    }
+    /* Only anonymous memory from our own allocator can be discarded. */
+    return (page_size > 0 && POOL_SIZE % page_size == 0 &&
+            _PyObject_Arena.alloc == _PyObject_ArenaMmap);
+}
+#endif
+
+/* Trim the empty pools in usable_arenas and release the arenas all of
+ * whose pools are empty.  If aged_only is true, only consider the pools
+ * which were already empty at the previous pass.
+ */
+static void
+trim_free_pools(int aged_only)
+{
+#ifdef WITH_POOL_TRIM
+    int can_trim = can_trim_pools();
+#endif
+    struct arena_object *ao = usable_arenas;
+
+    while (ao != NULL) {
+        struct arena_object *next = ao->nextarena;
+        int young = 0;
+        poolp *link = &ao->freepools;
+        poolp pool;
+
+        while ((pool = *link) != NULL) {
+            if (aged_only && pool->prevpool != pool) {
+                /* Newly empty:  give it until the next pass. */
+                pool->prevpool = pool;
+                young = 1;
+                link = &pool->nextpool;
+                continue;
+            }
+#ifdef WITH_POOL_TRIM
+            poolp nextpool = pool->nextpool;
+            if (can_trim && madvise(pool, POOL_SIZE, MADV_DONTNEED) == 0) {
+                size_t i = ((block *)pool - (block *)FIRST_POOL(ao)) / POOL_SIZE;
+                ao->trimmedpools[i / 64] |= (uint64_t)1 << (i % 64);
+                *link = nextpool;
+                continue;
+            }
+#endif
+            pool->prevpool = pool;
+            link = &pool->nextpool;
+        }
+
+        uint nf = ao->nfreepools;
+        if (!young && nf == ao->ntotalpools) {
+            /* Wholly free, and was at the previous pass. */
+            if (nfp2lasta[nf] == ao) {
+                struct arena_object *p = ao->prevarena;
+                nfp2lasta[nf] = (p != NULL && p->nfreepools == nf) ? p : NULL;
+            }
+            release_arena(ao);
+        }
+        ao = next;
+    }
+}
+
+void
+_PyObject_TrimMalloc(void)
+{
+    trim_free_pools(0);
+    trim_countdown = trim_interval;
+}
+
+Py_ssize_t
+_PyObject_SetMallocTrimInterval(Py_ssize_t interval)
+{
+    Py_ssize_t old = trim_interval;
+    trim_interval = interval > 0 ? interval : 0;
+    trim_countdown = trim_interval;
+    return old;
+}
+
 /* Free a memory block allocated by pymalloc_alloc().
    Return 1 if it was freed.
    Return 0 if the block was not allocated by pymalloc_alloc(). */
@@ -2249,6 +2442,10 @@ pymalloc_free(void *ctx, void *p)
      * (being not referenced, they are perhaps paged out).
      */
     insert_to_freepool(pool);
+    if (UNLIKELY(trim_interval != 0) && --trim_countdown <= 0) {
+        trim_countdown = trim_interval;
+        trim_free_pools(1);
+    }
     return 1;
 }
 
@@ -2928,52 +3125,38 @@ pool_is_in_list(const poolp target, poolp list)
 }
 #endif
 
-/* Print summary info to "out" about the state of pymalloc's structures.
- * In Py_DEBUG mode, also perform some expensive internal consistency
- * checks.
- *
- * Return 0 if the memory debug hooks are not installed or no statistics was
- * written into out, return 1 otherwise.
- */
-int
-_PyObject_DebugMallocStats(FILE *out)
-{
-    if (!_PyMem_PymallocEnabled()) {
-        return 0;
-    }
+#define NUMCLASSES (SMALL_REQUEST_THRESHOLD >> ALIGNMENT_SHIFT)
 
-    uint i;
-    const uint numclasses = SMALL_REQUEST_THRESHOLD >> ALIGNMENT_SHIFT;
-    /* # of pools, allocated blocks, and free blocks per class index */
-    size_t numpools[SMALL_REQUEST_THRESHOLD >> ALIGNMENT_SHIFT];
-    size_t numblocks[SMALL_REQUEST_THRESHOLD >> ALIGNMENT_SHIFT];
-    size_t numfreeblocks[SMALL_REQUEST_THRESHOLD >> ALIGNMENT_SHIFT];
-    /* total # of allocated bytes in used and full pools */
-    size_t allocated_bytes = 0;
-    /* total # of available bytes in used pools */
-    size_t available_bytes = 0;
+/* Occupancy of pymalloc's structures */
+typedef struct {
+    /* # of pools, full pools, allocated blocks, and free blocks per
+       class index */
+    size_t numpools[NUMCLASSES];
+    size_t numfullpools[NUMCLASSES];
+    size_t numblocks[NUMCLASSES];
+    size_t numfreeblocks[NUMCLASSES];
     /* # of free pools + pools not yet carved out of current arena */
-    uint numfreepools = 0;
+    size_t numfreepools;
+    /* # of free pools whose pages were handed back to the OS */
+    size_t numtrimmedpools;
     /* # of bytes for arena alignment padding */
-    size_t arena_alignment = 0;
-    /* # of bytes in used and full pools used for pool_headers */
-    size_t pool_header_bytes = 0;
-    /* # of bytes in used and full pools wasted due to quantization,
-     * i.e. the necessarily leftover space at the ends of used and
-     * full pools.
-     */
-    size_t quantization = 0;
+    size_t arena_alignment;
     /* # of arenas actually allocated. */
-    size_t narenas = 0;
-    /* running total -- should equal narenas * ARENA_SIZE */
-    size_t total;
-    char buf[128];
+    size_t narenas;
+    /* # of arenas by number of pools in use */
+    size_t arena_usage[MAX_POOLS_IN_ARENA + 1];
+} obmalloc_usage;
 
-    fprintf(out, "Small block threshold = %d, in %u size classes.\n",
-            SMALL_REQUEST_THRESHOLD, numclasses);
+/* Collect the occupancy of pymalloc's structures into *usage.
+ * In Py_DEBUG mode, also perform some expensive internal consistency
+ * checks.
+ */
+static void
+get_obmalloc_usage(obmalloc_usage *usage)
+{
+    uint i;
 
-    for (i = 0; i < numclasses; ++i)
-        numpools[i] = numblocks[i] = numfreeblocks[i] = 0;
+    memset(usage, 0, sizeof(*usage));
 
     /* Because full pools aren't linked to from anything, it's easiest
      * to march over all the arenas.  If we're lucky, most of the memory
@@ -2986,13 +3169,14 @@ _PyObject_DebugMallocStats(FILE *out)
         /* Skip arenas which are not allocated. */
         if (arenas[i].address == (uintptr_t)NULL)
             continue;
-        narenas += 1;
+        usage->narenas += 1;
 
-        numfreepools += arenas[i].nfreepools;
+        usage->numfreepools += arenas[i].nfreepools;
+        usage->arena_usage[arenas[i].ntotalpools - arenas[i].nfreepools]++;
 
         /* round up to pool alignment */
         if (base & (uintptr_t)POOL_SIZE_MASK) {
-            arena_alignment += POOL_SIZE;
+            usage->arena_alignment += POOL_SIZE;
             base &= ~(uintptr_t)POOL_SIZE_MASK;
             base += POOL_SIZE;
         }
@@ -3002,9 +3186,15 @@ _PyObject_DebugMallocStats(FILE *out)
         for (j = 0; base < (uintptr_t) arenas[i].pool_address;
              ++j, base += POOL_SIZE) {
             poolp p = (poolp)base;
-            const uint sz = p->szidx;
             uint freeblocks;
 
+            if (arenas[i].trimmedpools[j / 64] & ((uint64_t)1 << (j % 64))) {
+                /* its memory was handed back to the OS */
+                ++usage->numtrimmedpools;
+                continue;
+            }
+            const uint sz = p->szidx;
+
             if (p->ref.count == 0) {
                 /* currently unused */
 #ifdef Py_DEBUG
@@ -3012,17 +3202,60 @@ _PyObject_DebugMallocStats(FILE *out)
 #endif
                 continue;
             }
-            ++numpools[sz];
-            numblocks[sz] += p->ref.count;
+            ++usage->numpools[sz];
+            usage->numblocks[sz] += p->ref.count;
             freeblocks = NUMBLOCKS(sz) - p->ref.count;
-            numfreeblocks[sz] += freeblocks;
+            usage->numfreeblocks[sz] += freeblocks;
+            if (freeblocks == 0) {
+                ++usage->numfullpools[sz];
+            }
 #ifdef Py_DEBUG
             if (freeblocks > 0)
                 assert(pool_is_in_list(p, usedpools[sz + sz]));
 #endif
         }
     }
-    assert(narenas == narenas_currently_allocated);
+    assert(usage->narenas == narenas_currently_allocated);
+}
+
+/* Print summary info to "out" about the state of pymalloc's structures.
+ * In Py_DEBUG mode, also perform some expensive internal consistency
+ * checks.
+ *
+ * Return 0 if the memory debug hooks are not installed or no statistics was
+ * written into out, return 1 otherwise.
+ */
+int
+_PyObject_DebugMallocStats(FILE *out)
+{
+    if (!_PyMem_PymallocEnabled()) {
+        return 0;
+    }
+
+    uint i;
+    const uint numclasses = NUMCLASSES;
+    obmalloc_usage usage;
+    /* total # of allocated bytes in used and full pools */
+    size_t allocated_bytes = 0;
+    /* total # of available bytes in used pools */
+    size_t available_bytes = 0;
+    /* # of bytes in used and full pools used for pool_headers */
+    size_t pool_header_bytes = 0;
+    /* # of bytes in used and full pools wasted due to quantization,
+     * i.e. the necessarily leftover space at the ends of used and
+     * full pools.
+     */
+    size_t quantization = 0;
+    size_t narenas;
+    /* running total -- should equal narenas * ARENA_SIZE */
+    size_t total;
+    char buf[128];
+
+    fprintf(out, "Small block threshold = %d, in %u size classes.\n",
+            SMALL_REQUEST_THRESHOLD, numclasses);
+
+    get_obmalloc_usage(&usage);
+    narenas = usage.narenas;
 
     fputc('\n', out);
     fputs("class   size   num pools   blocks in use  avail blocks\n"
@@ -3030,9 +3263,9 @@ _PyObject_DebugMallocStats(FILE *out)
           out);
 
     for (i = 0; i < numclasses; ++i) {
-        size_t p = numpools[i];
-        size_t b = numblocks[i];
-        size_t f = numfreeblocks[i];
+        size_t p = usage.numpools[i];
+        size_t b = usage.numblocks[i];
+        size_t f = usage.numfreeblocks[i];
         uint size = INDEX2SIZE(i);
         if (p == 0) {
             assert(b == 0 && f == 0);
@@ -3068,12 +3301,13 @@ _PyObject_DebugMallocStats(FILE *out)
     total += printone(out, "# bytes in available blocks", available_bytes);
 
     PyOS_snprintf(buf, sizeof(buf),
-        "%u unused pools * %d bytes", numfreepools, POOL_SIZE);
-    total += printone(out, buf, (size_t)numfreepools * POOL_SIZE);
+        "%zu unused pools * %d bytes", usage.numfreepools, POOL_SIZE);
+    total += printone(out, buf, usage.numfreepools * POOL_SIZE);
 
     total += printone(out, "# bytes lost to pool headers", pool_header_bytes);
     total += printone(out, "# bytes lost to quantization", quantization);
-    total += printone(out, "# bytes lost to arena alignment", arena_alignment);
+    total += printone(out, "# bytes lost to arena alignment",
+                      usage.arena_alignment);
     (void)printone(out, "Total", total);
     assert(narenas * ARENA_SIZE == total);
 
@@ -3097,4 +3331,142 @@ _PyObject_DebugMallocStats(FILE *out)
     return 1;
 }
 
+/* Set dict[key] = PyLong(value); return -1 on error */
+static int
+set_size_item(PyObject *dict, const char *key, size_t value)
+{
+    PyObject *v = PyLong_FromSize_t(value);
+    if (v == NULL) {
+        return -1;
+    }
+    int res = PyDict_SetItemString(dict, key, v);
+    Py_DECREF(v);
+    return res;
+}
+
+#define SET_SIZE_ITEM(dict, key, value) \
+    do { \
+        if (set_size_item(dict, key, value) < 0) { \
+            goto error; \
+        } \
+    } while (0)
+
+/* Return the state of pymalloc's structures as a dict, see
+ * sys._obmalloc_stats(). Return None if pymalloc is not in use.
+ */
+PyObject *
+_PyObject_GetMallocStats(void)
+{
+    if (!_PyMem_PymallocEnabled()) {
+        Py_RETURN_NONE;
+    }
+
+    obmalloc_usage usage;
+    get_obmalloc_usage(&usage);
+
+    PyObject *classes = NULL, *arena_usage = NULL, *item = NULL;
+    PyObject *stats = PyDict_New();
+    if (stats == NULL) {
+        return NULL;
+    }
+
+    size_t allocated_bytes = 0;
+    size_t available_bytes = 0;
+    size_t pool_header_bytes = 0;
+    size_t quantization = 0;
+
+    classes = PyList_New(0);
+    if (classes == NULL) {
+        goto error;
+    }
+    for (uint i = 0; i < NUMCLASSES; i++) {
+        size_t p = usage.numpools[i];
+        uint size = INDEX2SIZE(i);
+        if (p == 0) {
+            continue;
+        }
+        allocated_bytes += usage.numblocks[i] * size;
+        available_bytes += usage.numfreeblocks[i] * size;
+        pool_header_bytes += p * POOL_OVERHEAD;
+        quantization += p * ((POOL_SIZE - POOL_OVERHEAD) % size);
+        item = Py_BuildValue("{sIsIsnsnsnsn}",
+                             "class", i, "size", size,
+                             "pools", (Py_ssize_t)p,
+                             "full_pools", (Py_ssize_t)usage.numfullpools[i],
+                             "blocks", (Py_ssize_t)usage.numblocks[i],
+                             "free_blocks", (Py_ssize_t)usage.numfreeblocks[i]);
+        if (item == NULL || PyList_Append(classes, item) < 0) {
+            goto error;
+        }
+        Py_CLEAR(item);
+    }
+    if (PyDict_SetItemString(stats, "size_classes", classes) < 0) {
+        goto error;
+    }
+
+    /* arena_usage[k] is the number of arenas with k pools in use */
+    arena_usage = PyList_New(MAX_POOLS_IN_ARENA + 1);
+    if (arena_usage == NULL) {
+        goto error;
+    }
+    for (Py_ssize_t k = 0; k <= MAX_POOLS_IN_ARENA; k++) {
+        item = PyLong_FromSize_t(usage.arena_usage[k]);
+        if (item == NULL) {
+            goto error;
+        }
+        PyList_SET_ITEM(arena_usage, k, item);
+        item = NULL;
+    }
+    if (PyDict_SetItemString(stats, "arena_usage", arena_usage) < 0) {
+        goto error;
+    }
+
+    SET_SIZE_ITEM(stats, "arena_size", ARENA_SIZE);
+    SET_SIZE_ITEM(stats, "pool_size", POOL_SIZE);
+    SET_SIZE_ITEM(stats, "small_block_threshold", SMALL_REQUEST_THRESHOLD);
+    SET_SIZE_ITEM(stats, "arenas", usage.narenas);
+    SET_SIZE_ITEM(stats, "arenas_allocated_total", ntimes_arena_allocated);
+    SET_SIZE_ITEM(stats, "arenas_reclaimed",
+                  ntimes_arena_allocated - usage.narenas);
+    SET_SIZE_ITEM(stats, "arenas_highwater", narenas_highwater);
+    SET_SIZE_ITEM(stats, "free_pools", usage.numfreepools);
+    SET_SIZE_ITEM(stats, "trimmed_pools", usage.numtrimmedpools);
+    SET_SIZE_ITEM(stats, "trim_interval", (size_t)trim_interval);
+    SET_SIZE_ITEM(stats, "allocated_bytes", allocated_bytes);
+    SET_SIZE_ITEM(stats, "available_bytes", available_bytes);
+    SET_SIZE_ITEM(stats, "free_pool_bytes", usage.numfreepools * POOL_SIZE);
+    SET_SIZE_ITEM(stats, "pool_header_bytes", pool_header_bytes);
+    SET_SIZE_ITEM(stats, "quantization_bytes", quantization);
+    SET_SIZE_ITEM(stats, "arena_alignment_bytes", usage.arena_alignment);
+
+#if WITH_PYMALLOC_RADIX_TREE
+    {
+        size_t map_bytes = sizeof(arena_map_root);
+        size_t mid_nodes = 0, bot_nodes = 0;
+#ifdef USE_INTERIOR_NODES
+        mid_nodes = arena_map_mid_count;
+        bot_nodes = arena_map_bot_count;
+        map_bytes += sizeof(arena_map_mid_t) * mid_nodes;
+        map_bytes += sizeof(arena_map_bot_t) * bot_nodes;
+#endif
+        SET_SIZE_ITEM(stats, "arena_map_mid_nodes", mid_nodes);
+        SET_SIZE_ITEM(stats, "arena_map_bot_nodes", bot_nodes);
+        SET_SIZE_ITEM(stats, "arena_map_bytes", map_bytes);
+    }
+#endif
+
+    Py_DECREF(classes);
+    Py_DECREF(arena_usage);
+    return stats;
+
+error:
+    Py_XDECREF(item);
+    Py_XDECREF(classes);
+    Py_XDECREF(arena_usage);
+    Py_DECREF(stats);
+    return NULL;
+}
+
+#undef SET_SIZE_ITEM
+
 #endif /* #ifdef WITH_PYMALLOC */
@@ -254,6 +254,66 @@ STRINGLIB(utf8_decode)(const char **inptr, const char *end,
 #undef ASCII_CHAR_MASK
 
 
+#ifdef HAVE_UNICODE_SSE2
+/* Encode data[i:] to UTF-8 at *pp 8 characters at a time, for as long as
+   they are below U+10000 and not surrogates.  Return the index of the first
+   character left for the caller.  A block is only encoded if at least one
+   character follows it: utf8_encode_bmp8() writes up to 3 bytes past its
+   output, into the space reserved for that character. */
+Py_LOCAL_INLINE(Py_ssize_t)
+STRINGLIB(utf8_encode_sse2)(const STRINGLIB_CHAR *data, Py_ssize_t i,
+                            Py_ssize_t size, char **pp)
+{
+    char *p = *pp;
+
+    while (size - i > 8) {
+        __m128i v;
+#if STRINGLIB_SIZEOF_CHAR == 1
+        if (size - i >= 16) {
+            v = _mm_loadu_si128((const __m128i *)(data + i));
+            if (!_mm_movemask_epi8(v)) {
+                _mm_storeu_si128((__m128i *)p, v);
+                p += 16;
+                i += 16;
+                continue;
+            }
+        }
+        v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(data + i)),
+                              _mm_setzero_si128());
+#else
+#  if STRINGLIB_SIZEOF_CHAR == 2
+        v = _mm_loadu_si128((const __m128i *)(data + i));
+#  else
+        __m128i v0 = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i v1 = _mm_loadu_si128((const __m128i *)(data + i + 4));
+        __m128i upper = _mm_srli_epi32(_mm_or_si128(v0, v1), 16);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(upper, _mm_setzero_si128()))
+            != 0xFFFF) {
+            break;
+        }
+        /* Sign-extend the low halves so that the signed saturation of
+           _mm_packs_epi32() keeps them unchanged */
+        v0 = _mm_srai_epi32(_mm_slli_epi32(v0, 16), 16);
+        v1 = _mm_srai_epi32(_mm_slli_epi32(v1, 16), 16);
+        v = _mm_packs_epi32(v0, v1);
+#  endif
+        /* Surrogates are left to the error handler */
+        __m128i surrogates = _mm_cmpeq_epi16(
+            _mm_and_si128(v, _mm_set1_epi16((short)0xF800)),
+            _mm_set1_epi16((short)0xD800));
+        if (_mm_movemask_epi8(surrogates)) {
+            break;
+        }
+#endif
+        p = utf8_encode_bmp8(v, p);
+        i += 8;
+    }
+    *pp = p;
+    return i;
+}
+#endif
+
+
 /* UTF-8 encoder specialized for a Unicode kind to avoid the slow
    PyUnicode_READ() macro. Delete some parts of the code depending on the kind:
    UCS-1 strings don't need to handle surrogates for example. */
@@ -267,6 +327,9 @@ STRINGLIB(utf8_encoder)(_PyBytesWriter *writer,
 {
     Py_ssize_t i;                /* index into data of next input character */
     char *p;                     /* next free byte in output buffer */
+#ifdef HAVE_UNICODE_SSE2
+    Py_ssize_t simd_next = 0;    /* index where SSE2 is tried again */
+#endif
 #if STRINGLIB_SIZEOF_CHAR > 1
     PyObject *error_handler_obj = NULL;
     PyObject *exc = NULL;
@@ -293,6 +356,14 @@ STRINGLIB(utf8_encoder)(_PyBytesWriter *writer,
         return NULL;
 
     for (i = 0; i < size;) {
+#ifdef HAVE_UNICODE_SSE2
+        if (i >= simd_next) {
+            i = STRINGLIB(utf8_encode_sse2)(data, i, size, &p);
+            /* Encode the block which stopped it one character at a time */
+            simd_next = i + 8;
+            continue;
+        }
+#endif
         Py_UCS4 ch = data[i++];
 
         if (ch < 0x80) {
@@ -24,6 +24,14 @@
 #define FAST_SEARCH 1
 #define FAST_RSEARCH 2
 
+/* SSE2 is part of the x86-64 baseline, so it needs no runtime check. */
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>          // _mm_cmpeq_epi8()
+#  include "pycore_bitutils.h"    // _Py_bit_length()
+#  define HAVE_STRINGLIB_SSE2
+#endif
+
 #if LONG_BIT >= 128
 #define STRINGLIB_BLOOM_WIDTH 128
 #elif LONG_BIT >= 64
@@ -45,6 +53,32 @@
 #  define MEMCHR_CUT_OFF 40
 #endif
 
+#ifdef HAVE_STRINGLIB_SSE2
+/* SSE2_MATCH() compares the SSE2_LANES characters at ptr with the
+   character broadcast in vch, and returns a mask of STRINGLIB_SIZEOF_CHAR
+   bits per character, as _mm_movemask_epi8() does.  SSE2_FIRST() and
+   SSE2_LAST() give the index of the first and last character set in a
+   nonzero mask. */
+#  define SSE2_LANES (16 / STRINGLIB_SIZEOF_CHAR)
+#  if STRINGLIB_SIZEOF_CHAR == 1
+#    define SSE2_SET1(ch) _mm_set1_epi8((char)(ch))
+#    define SSE2_CMPEQ(a, b) _mm_cmpeq_epi8(a, b)
+#  elif STRINGLIB_SIZEOF_CHAR == 2
+#    define SSE2_SET1(ch) _mm_set1_epi16((short)(ch))
+#    define SSE2_CMPEQ(a, b) _mm_cmpeq_epi16(a, b)
+#  else
+#    define SSE2_SET1(ch) _mm_set1_epi32((int)(ch))
+#    define SSE2_CMPEQ(a, b) _mm_cmpeq_epi32(a, b)
+#  endif
+#  define SSE2_MATCH(ptr, vch) \
+    ((unsigned int)_mm_movemask_epi8( \
+        SSE2_CMPEQ(_mm_loadu_si128((const __m128i *)(ptr)), (vch))))
+#  define SSE2_FIRST(mask) \
+    ((_Py_bit_length((mask) & (0U - (mask))) - 1) / STRINGLIB_SIZEOF_CHAR)
+#  define SSE2_LAST(mask) \
+    ((_Py_bit_length(mask) - 1) / STRINGLIB_SIZEOF_CHAR)
+#endif
+
 Py_LOCAL_INLINE(Py_ssize_t)
 STRINGLIB(find_char)(const STRINGLIB_CHAR* s, Py_ssize_t n, STRINGLIB_CHAR ch)
 {
@@ -61,7 +95,7 @@ STRINGLIB(find_char)(const STRINGLIB_CHAR* s, Py_ssize_t n, STRINGLIB_CHAR ch)
 #else
         /* use memchr if we can choose a needle without too many likely
            false positives */
-        const STRINGLIB_CHAR *s1, *e1;
+        const STRINGLIB_CHAR *s1;
         unsigned char needle = ch & 0xff;
         /* If looking for a multiple of 256, we'd have too
            many false positives looking for the '\0' byte in UCS2
@@ -81,17 +115,32 @@ STRINGLIB(find_char)(const STRINGLIB_CHAR* s, Py_ssize_t n, STRINGLIB_CHAR ch)
                 p++;
                 if (p - s1 > MEMCHR_CUT_OFF)
                     continue;
+#ifdef HAVE_STRINGLIB_SSE2
+                /* too many of them: compare whole characters below */
+                break;
+#else
                 if (e - p <= MEMCHR_CUT_OFF)
                     break;
-                e1 = p + MEMCHR_CUT_OFF;
+                const STRINGLIB_CHAR *e1 = p + MEMCHR_CUT_OFF;
                 while (p != e1) {
                     if (*p == ch)
                         return (p - s);
                     p++;
                 }
+#endif
             }
             while (e - p > MEMCHR_CUT_OFF);
         }
+#ifdef HAVE_STRINGLIB_SSE2
+        const __m128i vch = SSE2_SET1(ch);
+        while (e - p >= 2 * SSE2_LANES) {
+            unsigned int mask = SSE2_MATCH(p, vch) |
+                                SSE2_MATCH(p + SSE2_LANES, vch) << 16;
+            if (mask)
+                return (p - s) + SSE2_FIRST(mask);
+            p += 2 * SSE2_LANES;
+        }
+#endif
 #endif
     }
     while (p < e) {
@@ -120,7 +169,6 @@ STRINGLIB(rfind_char)(const STRINGLIB_CHAR* s, Py_ssize_t n, STRINGLIB_CHAR ch)
 #else
         /* use memrchr if we can choose a needle without too many likely
            false positives */
-        const STRINGLIB_CHAR *s1;
         Py_ssize_t n1;
         unsigned char needle = ch & 0xff;
         /* If looking for a multiple of 256, we'd have too
@@ -141,21 +189,37 @@ STRINGLIB(rfind_char)(const STRINGLIB_CHAR* s, Py_ssize_t n, STRINGLIB_CHAR ch)
                 /* False positive */
                 if (n1 - n > MEMCHR_CUT_OFF)
                     continue;
+#ifdef HAVE_STRINGLIB_SSE2
+                /* too many of them: compare whole characters below */
+                break;
+#else
                 if (n <= MEMCHR_CUT_OFF)
                     break;
-                s1 = p - MEMCHR_CUT_OFF;
+                const STRINGLIB_CHAR *s1 = p - MEMCHR_CUT_OFF;
                 while (p > s1) {
                     p--;
                     if (*p == ch)
                         return (p - s);
                 }
                 n = p - s;
+#endif
             }
             while (n > MEMCHR_CUT_OFF);
         }
 #endif
     }
 #endif  /* HAVE_MEMRCHR */
+#if STRINGLIB_SIZEOF_CHAR > 1 && defined(HAVE_STRINGLIB_SSE2)
+    const __m128i vch = SSE2_SET1(ch);
+    while (n >= 2 * SSE2_LANES) {
+        p = s + n - 2 * SSE2_LANES;
+        unsigned int mask = SSE2_MATCH(p, vch) |
+                            SSE2_MATCH(p + SSE2_LANES, vch) << 16;
+        if (mask)
+            return (p - s) + SSE2_LAST(mask);
+        n -= 2 * SSE2_LANES;
+    }
+#endif
     p = s + n;
     while (p > s) {
         p--;
@@ -722,8 +786,29 @@ static inline Py_ssize_t
 STRINGLIB(count_char)(const STRINGLIB_CHAR *s, Py_ssize_t n,
                       const STRINGLIB_CHAR p0, Py_ssize_t maxcount)
 {
-    Py_ssize_t i, count = 0;
-    for (i = 0; i < n; i++) {
+    Py_ssize_t i = 0, count = 0;
+#ifdef HAVE_STRINGLIB_SSE2
+    /* Each match adds 1 to the STRINGLIB_SIZEOF_CHAR byte lanes of its
+       character.  The lanes are summed up before they can overflow, which
+       is also when maxcount is checked. */
+    const __m128i vch = SSE2_SET1(p0);
+    while (n - i >= SSE2_LANES) {
+        Py_ssize_t blocks = Py_MIN((n - i) / SSE2_LANES, 255);
+        __m128i acc = _mm_setzero_si128();
+        for (; blocks > 0; blocks--, i += SSE2_LANES) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+            acc = _mm_sub_epi8(acc, SSE2_CMPEQ(v, vch));
+        }
+        acc = _mm_sad_epu8(acc, _mm_setzero_si128());
+        count += (_mm_cvtsi128_si32(acc) +
+                  _mm_cvtsi128_si32(_mm_srli_si128(acc, 8)))
+                 / STRINGLIB_SIZEOF_CHAR;
+        if (count >= maxcount) {
+            return maxcount;
+        }
+    }
+#endif
+    for (; i < n; i++) {
         if (s[i] == p0) {
             count++;
             if (count == maxcount) {
@@ -735,6 +820,81 @@ STRINGLIB(count_char)(const STRINGLIB_CHAR *s, Py_ssize_t n,
 }
 
 
+#ifdef HAVE_STRINGLIB_SSE2
+/* Find or count a short needle, 2 to SSE2_MAX_NEEDLE characters, by
+   comparing the first and last characters of SSE2_LANES windows of the
+   haystack at a time; the rest of the needle is only compared where both
+   match.  This is the "generic SIMD" algorithm of Wojciech Mula's
+   "SIMD-friendly algorithms for substring searching".  The tail which is
+   too short for a full block is left to default_find().
+
+   Like adaptive_find(), switch to the two-way algorithm when the number
+   of characters compared at candidates which are not a match gets larger
+   than the haystack scanned so far, so the worst case stays linear. */
+#define SSE2_MAX_NEEDLE 32
+
+static Py_ssize_t
+STRINGLIB(sse2_find)(const STRINGLIB_CHAR* s, Py_ssize_t n,
+                     const STRINGLIB_CHAR* p, Py_ssize_t m,
+                     Py_ssize_t maxcount, int mode)
+{
+    const Py_ssize_t w = n - m;
+    const __m128i first = SSE2_SET1(p[0]);
+    const __m128i last = SSE2_SET1(p[m - 1]);
+    Py_ssize_t i = 0, count = 0, hits = 0, res;
+
+    assert(2 <= m && m <= SSE2_MAX_NEEDLE);
+    assert(mode != FAST_RSEARCH);
+    while (w - i >= SSE2_LANES - 1) {
+        unsigned int mask = SSE2_MATCH(s + i, first) &
+                            SSE2_MATCH(s + i + m - 1, last);
+        Py_ssize_t next = i + SSE2_LANES;
+        while (mask) {
+            Py_ssize_t j = i + SSE2_FIRST(mask);
+            if (memcmp(s + j + 1, p + 1,
+                       (m - 2) * sizeof(STRINGLIB_CHAR)) == 0) {
+                /* got a match! */
+                if (mode != FAST_COUNT) {
+                    return j;
+                }
+                count++;
+                if (count == maxcount) {
+                    return maxcount;
+                }
+                /* matches don't overlap */
+                next = j + m;
+                break;
+            }
+            hits += m;
+            /* clear the bits of the character at j */
+            mask &= ~(((1U << STRINGLIB_SIZEOF_CHAR) - 1)
+                      << (j - i) * STRINGLIB_SIZEOF_CHAR);
+        }
+        i = next;
+        if (hits > i + 2000 && w - i > 2000) {
+            if (mode == FAST_SEARCH) {
+                res = STRINGLIB(_two_way_find)(s + i, n - i, p, m);
+                return res == -1 ? -1 : res + i;
+            }
+            else {
+                res = STRINGLIB(_two_way_count)(s + i, n - i, p, m,
+                                                maxcount - count);
+                return res + count;
+            }
+        }
+    }
+    if (i > w) {
+        return mode == FAST_COUNT ? count : -1;
+    }
+    res = STRINGLIB(default_find)(s + i, n - i, p, m, maxcount - count, mode);
+    if (mode == FAST_COUNT) {
+        return count + res;
+    }
+    return res == -1 ? -1 : res + i;
+}
+#endif
+
+
 Py_LOCAL_INLINE(Py_ssize_t)
 FASTSEARCH(const STRINGLIB_CHAR* s, Py_ssize_t n,
            const STRINGLIB_CHAR* p, Py_ssize_t m,
@@ -760,6 +920,11 @@ FASTSEARCH(const STRINGLIB_CHAR* s, Py_ssize_t n,
     }
 
     if (mode != FAST_RSEARCH) {
+#ifdef HAVE_STRINGLIB_SSE2
+        if (m <= SSE2_MAX_NEEDLE) {
+            return STRINGLIB(sse2_find)(s, n, p, m, maxcount, mode);
+        }
+#endif
         if (n < 2500 || (m < 100 && n < 30000) || m < 6) {
             return STRINGLIB(default_find)(s, n, p, m, maxcount, mode);
         }
@@ -791,3 +956,12 @@ FASTSEARCH(const STRINGLIB_CHAR* s, Py_ssize_t n,
     }
 }
 
+#ifdef HAVE_STRINGLIB_SSE2
+#  undef SSE2_LANES
+#  undef SSE2_SET1
+#  undef SSE2_CMPEQ
+#  undef SSE2_MATCH
+#  undef SSE2_FIRST
+#  undef SSE2_LAST
+#  undef SSE2_MAX_NEEDLE
+#endif
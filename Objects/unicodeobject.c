@@ -63,6 +63,13 @@ OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include "pycore_fileutils.h"     // _Py_LocaleUsesNonUnicodeWchar()
 #endif
 
+/* SSE2 is part of the x86-64 baseline, so it needs no runtime check. */
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>          // _mm_movemask_epi8()
+#  define HAVE_UNICODE_SSE2
+#endif
+
 /* Uncomment to display statistics on interned strings at exit
    in _PyUnicode_ClearInterned(). */
 /* #define INTERNED_STATS 1 */
@@ -5060,6 +5067,69 @@ PyUnicode_DecodeUTF8(const char *s,
     return PyUnicode_DecodeUTF8Stateful(s, size, errors, NULL);
 }
 
+#ifdef HAVE_UNICODE_SSE2
+/* Encode the 8 characters in the 16-bit lanes of v, which must be below
+   U+10000 and not surrogates, to UTF-8 at p and return the end of the
+   output.  The sequence of each character is built in a 32-bit lane, and
+   the lanes are stored 4 bytes at a time, each one overwriting the unused
+   tail of the previous one.  This avoids a branch per character, but may
+   write up to 3 bytes past the returned end. */
+static inline char *
+utf8_encode_bmp8(__m128i v, char *p)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i low6 = _mm_set1_epi16(0x3F);
+    const __m128i cont = _mm_set1_epi16(0x80);
+
+    __m128i is_ascii = _mm_cmpeq_epi16(
+        _mm_and_si128(v, _mm_set1_epi16((short)0xFF80)), zero);
+    if (_mm_movemask_epi8(is_ascii) == 0xFFFF) {
+        _mm_storel_epi64((__m128i *)p, _mm_packus_epi16(v, v));
+        return p + 8;
+    }
+    __m128i is_two = _mm_cmpeq_epi16(
+        _mm_and_si128(v, _mm_set1_epi16((short)0xF800)), zero);
+
+    /* The last byte is always 0x80 | (ch & 0x3F) */
+    __m128i last = _mm_or_si128(_mm_and_si128(v, low6), cont);
+    __m128i v6 = _mm_srli_epi16(v, 6);
+    /* Below U+0800: 0xC0 | (ch >> 6), last */
+    __m128i seq2 = _mm_or_si128(_mm_or_si128(v6, _mm_set1_epi16(0xC0)),
+                                _mm_slli_epi16(last, 8));
+    if (_mm_movemask_epi8(_mm_andnot_si128(is_ascii, is_two)) == 0xFFFF) {
+        _mm_storeu_si128((__m128i *)p, seq2);
+        return p + 16;
+    }
+    /* Otherwise: 0xE0 | (ch >> 12), 0x80 | ((ch >> 6) & 0x3F), last */
+    __m128i seq3 = _mm_or_si128(
+        _mm_or_si128(_mm_srli_epi16(v, 12), _mm_set1_epi16(0xE0)),
+        _mm_slli_epi16(_mm_or_si128(_mm_and_si128(v6, low6), cont), 8));
+
+    /* First two bytes of each sequence, then the third one */
+    __m128i lo = _mm_or_si128(
+        _mm_and_si128(is_ascii, v),
+        _mm_andnot_si128(is_ascii,
+                         _mm_or_si128(_mm_and_si128(is_two, seq2),
+                                      _mm_andnot_si128(is_two, seq3))));
+    __m128i hi = _mm_andnot_si128(is_two, last);
+    /* 3 + is_ascii + is_two bytes: the masks are -1, and ASCII characters
+       are also below U+0800 */
+    __m128i len = _mm_add_epi16(_mm_set1_epi16(3),
+                                _mm_add_epi16(is_ascii, is_two));
+
+    uint32_t seqs[8];
+    uint16_t lens[8];
+    _mm_storeu_si128((__m128i *)seqs, _mm_unpacklo_epi16(lo, hi));
+    _mm_storeu_si128((__m128i *)(seqs + 4), _mm_unpackhi_epi16(lo, hi));
+    _mm_storeu_si128((__m128i *)lens, len);
+    for (int k = 0; k < 8; k++) {
+        memcpy(p, &seqs[k], 4);
+        p += lens[k];
+    }
+    return p;
+}
+#endif
+
 #include "stringlib/asciilib.h"
 #include "stringlib/codecs.h"
 #include "stringlib/undef.h"
@@ -5087,7 +5157,7 @@ PyUnicode_DecodeUTF8(const char *s,
 #endif
 
 static Py_ssize_t
-ascii_decode(const char *start, const char *end, Py_UCS1 *dest)
+ascii_decode_words(const char *start, const char *end, Py_UCS1 *dest)
 {
     const char *p = start;
 
@@ -5140,6 +5210,138 @@ ascii_decode(const char *start, const char *end, Py_UCS1 *dest)
     return p - start;
 }
 
+/* Copy the leading ASCII characters of [start, end) to dest, which must be
+   aligned like a size_t, and return how many there were. */
+static Py_ssize_t
+ascii_decode(const char *start, const char *end, Py_UCS1 *dest)
+{
+    const char *p = start;
+
+#ifdef HAVE_UNICODE_SSE2
+    while (p + 16 <= end) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        if (_mm_movemask_epi8(v)) {
+            break;
+        }
+        _mm_storeu_si128((__m128i *)dest, v);
+        p += 16;
+        dest += 16;
+    }
+#endif
+    return (p - start) + ascii_decode_words(p, end, dest);
+}
+
+/* Count the code points in the UTF-8 data [start, end), as the number of
+   bytes which are not continuation bytes, and store the largest byte in
+   *pmaxbyte.  Both are only meaningful if the data is valid UTF-8, which
+   is left to the decoder. */
+static Py_ssize_t
+utf8_count_chars(const char *start, const char *end, unsigned char *pmaxbyte)
+{
+    const unsigned char *p = (const unsigned char *)start;
+    const unsigned char *e = (const unsigned char *)end;
+    Py_ssize_t ncont = 0;
+    unsigned char maxbyte = 0;
+
+#ifdef HAVE_UNICODE_SSE2
+    if (e - p >= 16) {
+        /* Continuation bytes \x80-\xBF are the signed bytes below -64.
+           They are counted in 16 byte lanes, which are summed up before
+           they can overflow. */
+        const __m128i cont_limit = _mm_set1_epi8(-64);
+        const __m128i zero = _mm_setzero_si128();
+        __m128i vmax = zero;
+        unsigned char lanes[16];
+        int i;
+
+        while (e - p >= 16) {
+            __m128i counts = zero;
+            for (i = 0; i < 255 && e - p >= 16; i++, p += 16) {
+                __m128i v = _mm_loadu_si128((const __m128i *)p);
+                vmax = _mm_max_epu8(vmax, v);
+                counts = _mm_sub_epi8(counts, _mm_cmplt_epi8(v, cont_limit));
+            }
+            counts = _mm_sad_epu8(counts, zero);
+            ncont += _mm_cvtsi128_si32(counts) +
+                     _mm_cvtsi128_si32(_mm_srli_si128(counts, 8));
+        }
+        _mm_storeu_si128((__m128i *)lanes, vmax);
+        for (i = 0; i < 16; i++) {
+            maxbyte = Py_MAX(maxbyte, lanes[i]);
+        }
+    }
+#endif
+    for (; p < e; p++) {
+        maxbyte = Py_MAX(maxbyte, *p);
+        ncont += (*p & 0xC0) == 0x80;
+    }
+    *pmaxbyte = maxbyte;
+    return (end - start) - ncont;
+}
+
+/* Decode the UTF-8 data [s, end), which follows the `prefix` ASCII
+   characters already decoded into u, into a new string of the exact
+   length and kind.  This spares the widening copies and overallocation
+   of _PyUnicodeWriter.  Return NULL without setting an exception if the
+   data is invalid or truncated: the caller then falls back to the
+   error-handling decoder. */
+static PyObject *
+utf8_decode_exact(PyObject *u, Py_ssize_t prefix,
+                  const char *s, const char *end)
+{
+    const Py_UCS1 *src = PyUnicode_1BYTE_DATA(u);
+    unsigned char maxbyte;
+    Py_ssize_t nchars, pos = prefix;
+    Py_UCS4 maxchar, ch;
+    PyObject *v;
+
+    /* In valid UTF-8 the largest byte is the lead byte of the largest
+       character, since continuation bytes are below \xC0.  That is enough
+       to choose the kind: \xC2-\xC3 lead to Latin-1 characters, \xC4-\xEF
+       to the rest of the BMP and \xF0-\xF4 to astral characters. */
+    nchars = utf8_count_chars(s, end, &maxbyte);
+    if (maxbyte >= 0xF0) {
+        maxchar = MAX_UNICODE;
+    }
+    else if (maxbyte >= 0xC4) {
+        maxchar = 0xFFFF;
+    }
+    else {
+        maxchar = 0xFF;
+    }
+
+    v = PyUnicode_New(prefix + nchars, maxchar);
+    if (v == NULL) {
+        return NULL;
+    }
+    switch (PyUnicode_KIND(v)) {
+    case PyUnicode_1BYTE_KIND:
+        memcpy(PyUnicode_1BYTE_DATA(v), src, prefix);
+        ch = ucs1lib_utf8_decode(&s, end, PyUnicode_1BYTE_DATA(v), &pos);
+        break;
+    case PyUnicode_2BYTE_KIND:
+        _PyUnicode_CONVERT_BYTES(Py_UCS1, Py_UCS2, src, src + prefix,
+                                 PyUnicode_2BYTE_DATA(v));
+        ch = ucs2lib_utf8_decode(&s, end, PyUnicode_2BYTE_DATA(v), &pos);
+        break;
+    default:
+        assert(PyUnicode_KIND(v) == PyUnicode_4BYTE_KIND);
+        _PyUnicode_CONVERT_BYTES(Py_UCS1, Py_UCS4, src, src + prefix,
+                                 PyUnicode_4BYTE_DATA(v));
+        ch = ucs4lib_utf8_decode(&s, end, PyUnicode_4BYTE_DATA(v), &pos);
+        break;
+    }
+    /* The decoders stop at the first character that is invalid or does
+       not fit, without writing it, so they cannot overrun the string. */
+    if (ch != 0 || s != end) {
+        Py_DECREF(v);
+        return NULL;
+    }
+    assert(pos == prefix + nchars);
+    assert(_PyUnicode_CheckConsistency(v, 1));
+    return v;
+}
+
 static PyObject *
 unicode_decode_utf8(const char *s, Py_ssize_t size,
                     _Py_error_handler error_handler, const char *errors,
@@ -5172,7 +5374,17 @@ unicode_decode_utf8(const char *s, Py_ssize_t size,
         return u;
     }
 
-    // Use _PyUnicodeWriter after fast path is failed.
+    // Then try valid UTF-8, decoded without _PyUnicodeWriter.
+    PyObject *v = utf8_decode_exact(u, s - starts, s, end);
+    if (v != NULL || PyErr_Occurred()) {
+        Py_DECREF(u);
+        if (v != NULL && consumed) {
+            *consumed = size;
+        }
+        return v;
+    }
+
+    // Use _PyUnicodeWriter after fast paths have failed.
     _PyUnicodeWriter writer;
     _PyUnicodeWriter_InitWithBuffer(&writer, u);
     writer.pos = s - starts;
@@ -11381,6 +11593,20 @@ _PyUnicode_EQ(PyObject *aa, PyObject *bb)
     return unicode_eq(aa, bb);
 }
 
+int
+_PyUnicode_Equal(PyObject *str1, PyObject *str2)
+{
+    assert(PyUnicode_Check(str1));
+    assert(PyUnicode_Check(str2));
+    if (str1 == str2) {
+        return 1;
+    }
+    if (PyUnicode_READY(str1) || PyUnicode_READY(str2)) {
+        return -1;
+    }
+    return unicode_compare_eq(str1, str2);
+}
+
 int
 PyUnicode_Contains(PyObject *str, PyObject *substr)
 {
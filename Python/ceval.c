@@ -14,8 +14,10 @@
 #include "pycore_call.h"          // _PyObject_FastCallDictTstate()
 #include "pycore_ceval.h"         // _PyEval_SignalAsyncExc()
 #include "pycore_code.h"
+#include "pycore_descrobject.h"   // propertyobject
 #include "pycore_function.h"
 #include "pycore_initconfig.h"    // _PyStatus_OK()
+#include "pycore_list.h"          // _PyListIterObject
 #include "pycore_long.h"          // _PyLong_GetZero()
 #include "pycore_object.h"        // _PyObject_GC_TRACK()
 #include "pycore_moduleobject.h"  // PyModuleObject
@@ -23,8 +25,9 @@
 #include "pycore_pylifecycle.h"   // _PyErr_Print()
 #include "pycore_pymem.h"         // _PyMem_IsPtrFreed()
 #include "pycore_pystate.h"       // _PyInterpreterState_GET()
+#include "pycore_range.h"         // _PyRangeIterObject
 #include "pycore_sysmodule.h"     // _PySys_Audit()
-#include "pycore_tuple.h"         // _PyTuple_ITEMS()
+#include "pycore_tuple.h"         // _PyTuple_ITEMS(), _PyTupleIterObject
 
 #include "code.h"
 #include "pycore_dict.h"
@@ -104,6 +107,10 @@ _PyEvalFramePushAndInit(PyThreadState *tstate, PyFunctionObject *func,
                         size_t argcount, PyObject *kwnames);
 static int
 _PyEvalFrameClearAndPop(PyThreadState *tstate, InterpreterFrame * frame);
+static InterpreterFrame *
+push_kwcall_frame(PyThreadState *tstate, PyFunctionObject *func,
+                  PyObject **args, int nargs, int kwcount,
+                  const uint8_t *slots);
 
 #define NAME_ERROR_MSG \
     "name '%.200s' is not defined"
@@ -123,6 +130,55 @@ static long dxp[256];
 #endif
 #endif
 
+/* Sampled dynamic execution profile.
+ *
+ * Unlike DYNAMIC_EXECUTION_PROFILE, this is compiled into every build and
+ * is switched on at run time with sys._setdxpsampling(interval). Every
+ * interval-th instruction dispatched in an interpreter is recorded in its
+ * buffer as the code object, the opcode of the previously executed
+ * instruction of the same frame and the opcode about to be executed.
+ * Opcodes are recorded as executed, so specialized instructions appear as
+ * themselves. The state lives in the interpreter's _ceval_state, so that it
+ * is protected by the GIL of the interpreter, even if it has its own.
+ *
+ * Recording a sample never releases a reference, since that could run
+ * arbitrary code in the middle of dispatching an instruction. Once the
+ * buffer is full, sampling pauses, which also takes the countdown off the
+ * dispatch path, until sys._getdxpsamples() drains the buffer and
+ * releases the code objects. */
+
+#define DXP_MAX_SAMPLES 8192
+
+typedef struct _dxp_sample {
+    PyCodeObject *code;     /* Strong reference */
+    uint8_t prev_opcode;
+    uint8_t opcode;
+} dxp_sample;
+
+static Py_NO_INLINE void
+dxp_record_sample(struct _ceval_state *ceval, InterpreterFrame *frame,
+                  int opcode)
+{
+    if (ceval->dxp_samples == NULL
+        || ceval->dxp_nsamples >= DXP_MAX_SAMPLES)
+    {
+        ceval->dxp_sample_countdown = 0;
+        return;
+    }
+    int prev_opcode = 0;
+    if (frame->f_lasti >= 0) {
+        prev_opcode = _Py_OPCODE(frame->f_code->co_firstinstr[frame->f_lasti]);
+    }
+    dxp_sample *sample = &ceval->dxp_samples[ceval->dxp_nsamples++];
+    Py_INCREF(frame->f_code);
+    sample->code = frame->f_code;
+    sample->prev_opcode = (uint8_t)prev_opcode;
+    sample->opcode = (uint8_t)opcode;
+    if (ceval->dxp_nsamples < DXP_MAX_SAMPLES) {
+        ceval->dxp_sample_countdown = ceval->dxp_sample_interval;
+    }
+}
+
 #ifndef NDEBUG
 /* Ensure that tstate is valid: sanity check for PyEval_AcquireThread() and
    PyEval_RestoreThread(). Detect if tstate memory was freed. It can happen
@@ -258,7 +314,7 @@ _Py_FatalError_TstateNULL(const char *func)
 int
 _PyEval_ThreadsInitialized(PyInterpreterState *interp)
 {
-    return gil_created(&interp->ceval.gil);
+    return interp->ceval.gil != NULL && gil_created(interp->ceval.gil);
 }
 
 int
@@ -283,29 +339,44 @@ PyEval_ThreadsInitialized(void)
 }
 #endif
 
+/* Return the GIL of interp.  With EXPERIMENTAL_ISOLATED_SUBINTERPRETERS,
+   isolated subinterpreters have their own GIL.  Other interpreters share
+   the GIL of the main interpreter, which only the main interpreter creates
+   and destroys. */
+static struct _gil_runtime_state *
+interp_gil(PyInterpreterState *interp)
+{
+#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
+    if (!_Py_IsMainInterpreter(interp) && interp->config._isolated_interpreter) {
+        return &interp->ceval.own_gil;
+    }
+#endif
+    return &interp->runtime->ceval.gil;
+}
+
+/* Return 1 if interp creates and destroys its GIL */
+static int
+interp_owns_gil(PyInterpreterState *interp)
+{
+    return (_Py_IsMainInterpreter(interp)
+            || interp_gil(interp) != &interp->runtime->ceval.gil);
+}
+
 PyStatus
 _PyEval_InitGIL(PyThreadState *tstate)
 {
-#ifndef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
-    if (!_Py_IsMainInterpreter(tstate->interp)) {
-        /* Currently, the GIL is shared by all interpreters,
-           and only the main interpreter is responsible to create
-           and destroy it. */
+    PyInterpreterState *interp = tstate->interp;
+    struct _gil_runtime_state *gil = interp_gil(interp);
+    interp->ceval.gil = gil;
+    if (!interp_owns_gil(interp)) {
         return _PyStatus_OK();
     }
-#endif
-
-#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
-    struct _gil_runtime_state *gil = &tstate->interp->ceval.gil;
-#else
-    struct _gil_runtime_state *gil = &tstate->interp->runtime->ceval.gil;
-#endif
     assert(!gil_created(gil));
 
     PyThread_init_thread();
     create_gil(gil);
 
-    take_gil(tstate);
+    take_gil(tstate, 0);
 
     assert(gil_created(gil));
     return _PyStatus_OK();
@@ -314,20 +385,11 @@ _PyEval_InitGIL(PyThreadState *tstate)
 void
 _PyEval_FiniGIL(PyInterpreterState *interp)
 {
-#ifndef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
-    if (!_Py_IsMainInterpreter(interp)) {
-        /* Currently, the GIL is shared by all interpreters,
-           and only the main interpreter is responsible to create
-           and destroy it. */
+    if (!interp_owns_gil(interp)) {
         return;
     }
-#endif
 
-#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
-    struct _gil_runtime_state *gil = &interp->ceval.gil;
-#else
-    struct _gil_runtime_state *gil = &interp->runtime->ceval.gil;
-#endif
+    struct _gil_runtime_state *gil = interp_gil(interp);
     if (!gil_created(gil)) {
         /* First Py_InitializeFromConfig() call: the GIL doesn't exist
            yet: do nothing. */
@@ -347,9 +409,11 @@ PyEval_InitThreads(void)
 void
 _PyEval_Fini(void)
 {
-#if PRINT_SPECIALIZATION_STATS
-    _Py_PrintSpecializationStats();
-#endif
+    if (_Py_GetConfig()->specialization_stats) {
+        _Py_PrintSpecializationStats();
+    }
+    _Py_SpecializationStatsEnabled = 0;
+    _Py_ClearSpecializationStats();
 }
 
 void
@@ -359,7 +423,7 @@ PyEval_AcquireLock(void)
     PyThreadState *tstate = _PyRuntimeState_GetThreadState(runtime);
     _Py_EnsureTstateNotNULL(tstate);
 
-    take_gil(tstate);
+    take_gil(tstate, 0);
 }
 
 void
@@ -388,7 +452,7 @@ PyEval_AcquireThread(PyThreadState *tstate)
 {
     _Py_EnsureTstateNotNULL(tstate);
 
-    take_gil(tstate);
+    take_gil(tstate, 0);
 
     struct _gilstate_runtime_state *gilstate = &tstate->interp->runtime->gilstate;
 #ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
@@ -424,17 +488,13 @@ _PyEval_ReInitThreads(PyThreadState *tstate)
 {
     _PyRuntimeState *runtime = tstate->interp->runtime;
 
-#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
-    struct _gil_runtime_state *gil = &tstate->interp->ceval.gil;
-#else
-    struct _gil_runtime_state *gil = &runtime->ceval.gil;
-#endif
+    struct _gil_runtime_state *gil = tstate->interp->ceval.gil;
     if (!gil_created(gil)) {
         return _PyStatus_OK();
     }
     recreate_gil(gil);
 
-    take_gil(tstate);
+    take_gil(tstate, 0);
 
     struct _pending_calls *pending = &tstate->interp->ceval.pending;
     if (_PyThread_at_fork_reinit(&pending->lock) < 0) {
@@ -470,11 +530,7 @@ PyEval_SaveThread(void)
 
     struct _ceval_runtime_state *ceval = &runtime->ceval;
     struct _ceval_state *ceval2 = &tstate->interp->ceval;
-#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
-    assert(gil_created(&ceval2->gil));
-#else
-    assert(gil_created(&ceval->gil));
-#endif
+    assert(gil_created(ceval2->gil));
     drop_gil(ceval, ceval2, tstate);
     return tstate;
 }
@@ -484,7 +540,7 @@ PyEval_RestoreThread(PyThreadState *tstate)
 {
     _Py_EnsureTstateNotNULL(tstate);
 
-    take_gil(tstate);
+    take_gil(tstate, 1);
 
     struct _gilstate_runtime_state *gilstate = &tstate->interp->runtime->gilstate;
     _PyThreadState_Swap(gilstate, tstate);
@@ -742,9 +798,7 @@ Py_MakePendingCalls(void)
 void
 _PyEval_InitRuntimeState(struct _ceval_runtime_state *ceval)
 {
-#ifndef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
     _gil_initialize(&ceval->gil);
-#endif
 }
 
 int
@@ -761,7 +815,7 @@ _PyEval_InitState(struct _ceval_state *ceval)
     }
 
 #ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
-    _gil_initialize(&ceval->gil);
+    _gil_initialize(&ceval->own_gil);
 #endif
 
     return 0;
@@ -1197,7 +1251,7 @@ eval_frame_handle_pending(PyThreadState *tstate)
 
         /* Other threads may run now */
 
-        take_gil(tstate);
+        take_gil(tstate, 0);
 
 #ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
         (void)_PyThreadState_Swap(&runtime->gilstate, tstate);
@@ -1335,15 +1389,20 @@ eval_frame_handle_pending(PyThreadState *tstate)
 #define RECORD_DXPROFILE() ((void)0)
 #endif
 
-/* PRE_DISPATCH_GOTO() does lltrace and dxprofile if either is enabled. Normally a no-op */
-#ifndef LLTRACE
-#ifndef DYNAMIC_EXECUTION_PROFILE
-#define PRE_DISPATCH_GOTO() ((void)0)
-#endif
-#endif
-#ifndef PRE_DISPATCH_GOTO
-#define PRE_DISPATCH_GOTO() do { LLTRACE_INSTR(); RECORD_DXPROFILE(); } while (0)
-#endif
+/* RECORD_DXPSAMPLE() records a sample of the execution profile every
+   dxp_sample_interval instructions. Normally a single test of the
+   interpreter's countdown, which sits next to its eval_breaker. */
+#define RECORD_DXPSAMPLE() \
+    do { \
+        if (*dxp_sample_countdown > 0 && --*dxp_sample_countdown == 0) { \
+            dxp_record_sample(&tstate->interp->ceval, frame, opcode); \
+        } \
+    } while (0)
+
+/* PRE_DISPATCH_GOTO() does lltrace and dxprofile if either is enabled,
+   and records execution profile samples if sampling is enabled. */
+#define PRE_DISPATCH_GOTO() \
+    do { LLTRACE_INSTR(); RECORD_DXPROFILE(); RECORD_DXPSAMPLE(); } while (0)
 
 #define NOTRACE_DISPATCH() \
     { \
@@ -1608,6 +1667,8 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, InterpreterFrame *frame, int thr
     int oparg;         /* Current opcode argument, if any */
     PyObject *retval = NULL;            /* Return value */
     _Py_atomic_int * const eval_breaker = &tstate->interp->ceval.eval_breaker;
+    int * const dxp_sample_countdown =
+        &tstate->interp->ceval.dxp_sample_countdown;
 
     CFrame cframe;
 
@@ -2824,6 +2885,7 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, InterpreterFrame *frame, int thr
 
         TARGET(UNPACK_SEQUENCE) {
             PREDICTED(UNPACK_SEQUENCE);
+            STAT_INC(UNPACK_SEQUENCE, unquickened);
             PyObject *seq = POP(), *item, **items;
             if (PyTuple_CheckExact(seq) &&
                 PyTuple_GET_SIZE(seq) == oparg) {
@@ -2853,6 +2915,76 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, InterpreterFrame *frame, int thr
             DISPATCH();
         }
 
+        TARGET(UNPACK_SEQUENCE_ADAPTIVE) {
+            assert(cframe.use_tracing == 0);
+            SpecializedCacheEntry *cache = GET_CACHE();
+            if (cache->adaptive.counter == 0) {
+                PyObject *seq = TOP();
+                next_instr--;
+                _Py_Specialize_UnpackSequence(seq, next_instr, cache);
+                DISPATCH();
+            }
+            else {
+                STAT_INC(UNPACK_SEQUENCE, deferred);
+                cache->adaptive.counter--;
+                oparg = cache->adaptive.original_oparg;
+                STAT_DEC(UNPACK_SEQUENCE, unquickened);
+                JUMP_TO_INSTRUCTION(UNPACK_SEQUENCE);
+            }
+        }
+
+        TARGET(UNPACK_SEQUENCE_TWO_TUPLE) {
+            assert(cframe.use_tracing == 0);
+            PyObject *seq = TOP();
+            DEOPT_IF(!PyTuple_CheckExact(seq), UNPACK_SEQUENCE);
+            DEOPT_IF(PyTuple_GET_SIZE(seq) != 2, UNPACK_SEQUENCE);
+            STAT_INC(UNPACK_SEQUENCE, hit);
+            PyObject *first = PyTuple_GET_ITEM(seq, 0);
+            PyObject *second = PyTuple_GET_ITEM(seq, 1);
+            Py_INCREF(first);
+            Py_INCREF(second);
+            SET_TOP(second);
+            PUSH(first);
+            Py_DECREF(seq);
+            NOTRACE_DISPATCH();
+        }
+
+        TARGET(UNPACK_SEQUENCE_TUPLE) {
+            assert(cframe.use_tracing == 0);
+            PyObject *seq = TOP();
+            int len = GET_CACHE()->adaptive.original_oparg;
+            DEOPT_IF(!PyTuple_CheckExact(seq), UNPACK_SEQUENCE);
+            DEOPT_IF(PyTuple_GET_SIZE(seq) != len, UNPACK_SEQUENCE);
+            STAT_INC(UNPACK_SEQUENCE, hit);
+            STACK_SHRINK(1);
+            PyObject **items = _PyTuple_ITEMS(seq);
+            while (len--) {
+                PyObject *item = items[len];
+                Py_INCREF(item);
+                PUSH(item);
+            }
+            Py_DECREF(seq);
+            NOTRACE_DISPATCH();
+        }
+
+        TARGET(UNPACK_SEQUENCE_LIST) {
+            assert(cframe.use_tracing == 0);
+            PyObject *seq = TOP();
+            int len = GET_CACHE()->adaptive.original_oparg;
+            DEOPT_IF(!PyList_CheckExact(seq), UNPACK_SEQUENCE);
+            DEOPT_IF(PyList_GET_SIZE(seq) != len, UNPACK_SEQUENCE);
+            STAT_INC(UNPACK_SEQUENCE, hit);
+            STACK_SHRINK(1);
+            PyObject **items = _PyList_ITEMS(seq);
+            while (len--) {
+                PyObject *item = items[len];
+                Py_INCREF(item);
+                PUSH(item);
+            }
+            Py_DECREF(seq);
+            NOTRACE_DISPATCH();
+        }
+
         TARGET(UNPACK_EX) {
             int totalargs = 1 + (oparg & 0xFF) + (oparg >> 8);
             PyObject *seq = POP();
@@ -3553,6 +3685,7 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, InterpreterFrame *frame, int thr
             PyObject *name = GETITEM(names, cache0->original_oparg);
             uint32_t hint = cache1->dk_version_or_hint;
             DEOPT_IF(hint >= (size_t)dict->ma_keys->dk_nentries, LOAD_ATTR);
+            DEOPT_IF(dict->ma_keys->dk_kind == DICT_KEYS_COMPACT, LOAD_ATTR);
             PyDictKeyEntry *ep = DK_ENTRIES(dict->ma_keys) + hint;
             DEOPT_IF(ep->me_key != name, LOAD_ATTR);
             res = ep->me_value;
@@ -3584,6 +3717,70 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, InterpreterFrame *frame, int thr
             DISPATCH();
         }
 
+        TARGET(LOAD_ATTR_PROPERTY) {
+            assert(cframe.use_tracing == 0);
+            PyObject *owner = TOP();
+            PyTypeObject *tp = Py_TYPE(owner);
+            SpecializedCacheEntry *caches = GET_CACHE();
+            _PyAdaptiveEntry *cache0 = &caches[0].adaptive;
+            _PyAttrCache *cache1 = &caches[-1].attr;
+            _PyObjectCache *cache2 = &caches[-2].obj;
+            assert(cache1->tp_version != 0);
+            DEOPT_IF(tp->tp_version_tag != cache1->tp_version, LOAD_ATTR);
+            /* The property is kept alive by the type, but its getter may
+               have been replaced by property.__init__() */
+            propertyobject *prop = (propertyobject *)cache2->obj;
+            assert(Py_IS_TYPE(prop, &PyProperty_Type));
+            PyFunctionObject *fget = (PyFunctionObject *)prop->prop_get;
+            DEOPT_IF(fget == NULL || !PyFunction_Check(fget), LOAD_ATTR);
+            /* The version also pins co_argcount to 1 */
+            DEOPT_IF(fget->func_version != cache0->version, LOAD_ATTR);
+            /* PEP 523 */
+            DEOPT_IF(tstate->interp->eval_frame != NULL, LOAD_ATTR);
+            STAT_INC(LOAD_ATTR, hit);
+            PyCodeObject *code = (PyCodeObject *)fget->func_code;
+            size_t size = code->co_nlocalsplus + code->co_stacksize + FRAME_SPECIALS_SIZE;
+            InterpreterFrame *new_frame = _PyThreadState_BumpFramePointer(tstate, size);
+            if (new_frame == NULL) {
+                goto error;
+            }
+            _PyFrame_InitializeSpecials(new_frame, fget,
+                                        NULL, code->co_nlocalsplus);
+            /* The owner is passed as self, taking over the stack's reference */
+            new_frame->localsplus[0] = owner;
+            for (int i = 1; i < code->co_nlocalsplus; i++) {
+                new_frame->localsplus[i] = NULL;
+            }
+            STACK_SHRINK(1);
+            _PyFrame_SetStackPointer(frame, stack_pointer);
+            new_frame->previous = frame;
+            new_frame->depth = frame->depth + 1;
+            frame = cframe.current_frame = new_frame;
+            goto start_frame;
+        }
+
+        TARGET(LOAD_ATTR_CLASS) {
+            /* LOAD_ATTR, for attributes of classes */
+            assert(cframe.use_tracing == 0);
+            SpecializedCacheEntry *caches = GET_CACHE();
+            _PyAdaptiveEntry *cache0 = &caches[0].adaptive;
+            _PyAttrCache *cache1 = &caches[-1].attr;
+            _PyObjectCache *cache2 = &caches[-2].obj;
+            PyObject *cls = TOP();
+            DEOPT_IF(!PyType_Check(cls), LOAD_ATTR);
+            assert(cache1->tp_version != 0);
+            DEOPT_IF(((PyTypeObject *)cls)->tp_version_tag != cache1->tp_version,
+                LOAD_ATTR);
+            DEOPT_IF(Py_TYPE(cls)->tp_version_tag != cache0->version, LOAD_ATTR);
+            STAT_INC(LOAD_ATTR, hit);
+            PyObject *res = cache2->obj;
+            assert(res != NULL);
+            Py_INCREF(res);
+            SET_TOP(res);
+            Py_DECREF(cls);
+            DISPATCH();
+        }
+
         TARGET(STORE_ATTR_ADAPTIVE) {
             assert(cframe.use_tracing == 0);
             SpecializedCacheEntry *cache = GET_CACHE();
@@ -3651,6 +3848,7 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, InterpreterFrame *frame, int thr
             PyObject *name = GETITEM(names, cache0->original_oparg);
             uint32_t hint = cache1->dk_version_or_hint;
             DEOPT_IF(hint >= (size_t)dict->ma_keys->dk_nentries, STORE_ATTR);
+            DEOPT_IF(dict->ma_keys->dk_kind == DICT_KEYS_COMPACT, STORE_ATTR);
             PyDictKeyEntry *ep = DK_ENTRIES(dict->ma_keys) + hint;
             DEOPT_IF(ep->me_key != name, STORE_ATTR);
             PyObject *old_value = ep->me_value;
@@ -3691,6 +3889,8 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, InterpreterFrame *frame, int thr
         }
 
         TARGET(COMPARE_OP) {
+            PREDICTED(COMPARE_OP);
+            STAT_INC(COMPARE_OP, unquickened);
             assert(oparg <= Py_GE);
             PyObject *right = POP();
             PyObject *left = TOP();
@@ -3705,6 +3905,126 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, InterpreterFrame *frame, int thr
             DISPATCH();
         }
 
+        TARGET(COMPARE_OP_ADAPTIVE) {
+            assert(cframe.use_tracing == 0);
+            SpecializedCacheEntry *cache = GET_CACHE();
+            if (cache->adaptive.counter == 0) {
+                PyObject *right = TOP();
+                PyObject *left = SECOND();
+                next_instr--;
+                _Py_Specialize_CompareOp(left, right, next_instr, cache);
+                DISPATCH();
+            }
+            else {
+                STAT_INC(COMPARE_OP, deferred);
+                cache->adaptive.counter--;
+                oparg = cache->adaptive.original_oparg;
+                STAT_DEC(COMPARE_OP, unquickened);
+                JUMP_TO_INSTRUCTION(COMPARE_OP);
+            }
+        }
+
+        TARGET(COMPARE_OP_FLOAT_JUMP) {
+            assert(cframe.use_tracing == 0);
+            // Combined: COMPARE_OP (float ? float) + POP_JUMP_IF_(true/false)
+            SpecializedCacheEntry *caches = GET_CACHE();
+            int when_to_jump_mask = caches[0].adaptive.index;
+            PyObject *right = TOP();
+            PyObject *left = SECOND();
+            DEOPT_IF(!PyFloat_CheckExact(left), COMPARE_OP);
+            DEOPT_IF(!PyFloat_CheckExact(right), COMPARE_OP);
+            double dleft = PyFloat_AS_DOUBLE(left);
+            double dright = PyFloat_AS_DOUBLE(right);
+            // NaN compares unordered; leave that to the generic path.
+            DEOPT_IF(Py_IS_NAN(dleft), COMPARE_OP);
+            DEOPT_IF(Py_IS_NAN(dright), COMPARE_OP);
+            int sign = (dleft > dright) - (dleft < dright);
+            STAT_INC(COMPARE_OP, hit);
+            NEXTOPARG();
+            STACK_SHRINK(2);
+            Py_DECREF(left);
+            Py_DECREF(right);
+            assert(opcode == POP_JUMP_IF_TRUE || opcode == POP_JUMP_IF_FALSE);
+            int jump = (1 << (sign + 1)) & when_to_jump_mask;
+            if (!jump) {
+                next_instr++;
+                NOTRACE_DISPATCH();
+            }
+            else {
+                JUMPTO(oparg);
+                CHECK_EVAL_BREAKER();
+                NOTRACE_DISPATCH();
+            }
+        }
+
+        TARGET(COMPARE_OP_INT_JUMP) {
+            assert(cframe.use_tracing == 0);
+            // Combined: COMPARE_OP (int ? int) + POP_JUMP_IF_(true/false)
+            SpecializedCacheEntry *caches = GET_CACHE();
+            int when_to_jump_mask = caches[0].adaptive.index;
+            PyObject *right = TOP();
+            PyObject *left = SECOND();
+            DEOPT_IF(!PyLong_CheckExact(left), COMPARE_OP);
+            DEOPT_IF(!PyLong_CheckExact(right), COMPARE_OP);
+            DEOPT_IF((size_t)(Py_SIZE(left) + 1) > 2, COMPARE_OP);
+            DEOPT_IF((size_t)(Py_SIZE(right) + 1) > 2, COMPARE_OP);
+            STAT_INC(COMPARE_OP, hit);
+            assert(Py_ABS(Py_SIZE(left)) <= 1 && Py_ABS(Py_SIZE(right)) <= 1);
+            Py_ssize_t ileft = Py_SIZE(left) * ((PyLongObject *)left)->ob_digit[0];
+            Py_ssize_t iright = Py_SIZE(right) * ((PyLongObject *)right)->ob_digit[0];
+            int sign = (ileft > iright) - (ileft < iright);
+            NEXTOPARG();
+            STACK_SHRINK(2);
+            Py_DECREF(left);
+            Py_DECREF(right);
+            assert(opcode == POP_JUMP_IF_TRUE || opcode == POP_JUMP_IF_FALSE);
+            int jump = (1 << (sign + 1)) & when_to_jump_mask;
+            if (!jump) {
+                next_instr++;
+                NOTRACE_DISPATCH();
+            }
+            else {
+                JUMPTO(oparg);
+                CHECK_EVAL_BREAKER();
+                NOTRACE_DISPATCH();
+            }
+        }
+
+        TARGET(COMPARE_OP_STR_JUMP) {
+            assert(cframe.use_tracing == 0);
+            // Combined: COMPARE_OP (str == str or str != str) + POP_JUMP_IF_(true/false)
+            SpecializedCacheEntry *caches = GET_CACHE();
+            int invert = caches[0].adaptive.index;
+            PyObject *right = TOP();
+            PyObject *left = SECOND();
+            DEOPT_IF(!PyUnicode_CheckExact(left), COMPARE_OP);
+            DEOPT_IF(!PyUnicode_CheckExact(right), COMPARE_OP);
+            STAT_INC(COMPARE_OP, hit);
+            int res = _PyUnicode_Equal(left, right);
+            if (res < 0) {
+                goto error;
+            }
+            assert(caches[0].adaptive.original_oparg == Py_EQ ||
+                   caches[0].adaptive.original_oparg == Py_NE);
+            NEXTOPARG();
+            assert(opcode == POP_JUMP_IF_TRUE || opcode == POP_JUMP_IF_FALSE);
+            STACK_SHRINK(2);
+            Py_DECREF(left);
+            Py_DECREF(right);
+            assert(res == 0 || res == 1);
+            assert(invert == 0 || invert == 1);
+            int jump = res ^ invert;
+            if (!jump) {
+                next_instr++;
+                NOTRACE_DISPATCH();
+            }
+            else {
+                JUMPTO(oparg);
+                CHECK_EVAL_BREAKER();
+                NOTRACE_DISPATCH();
+            }
+        }
+
         TARGET(IS_OP) {
             PyObject *right = POP();
             PyObject *left = TOP();
@@ -4061,6 +4381,7 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, InterpreterFrame *frame, int thr
 
         TARGET(FOR_ITER) {
             PREDICTED(FOR_ITER);
+            STAT_INC(FOR_ITER, unquickened);
             /* before: [iter]; after: [iter, iter()] *or* [] */
             PyObject *iter = TOP();
             PyObject *next = (*Py_TYPE(iter)->tp_iternext)(iter);
@@ -4086,6 +4407,122 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, InterpreterFrame *frame, int thr
             DISPATCH();
         }
 
+        TARGET(FOR_ITER_ADAPTIVE) {
+            assert(cframe.use_tracing == 0);
+            SpecializedCacheEntry *cache = GET_CACHE();
+            if (cache->adaptive.counter == 0) {
+                next_instr--;
+                _Py_Specialize_ForIter(TOP(), next_instr, cache);
+                DISPATCH();
+            }
+            else {
+                STAT_INC(FOR_ITER, deferred);
+                cache->adaptive.counter--;
+                oparg = cache->adaptive.original_oparg;
+                STAT_DEC(FOR_ITER, unquickened);
+                JUMP_TO_INSTRUCTION(FOR_ITER);
+            }
+        }
+
+        TARGET(FOR_ITER_LIST) {
+            assert(cframe.use_tracing == 0);
+            _PyListIterObject *it = (_PyListIterObject *)TOP();
+            DEOPT_IF(Py_TYPE(it) != &PyListIter_Type, FOR_ITER);
+            STAT_INC(FOR_ITER, hit);
+            PyListObject *seq = it->it_seq;
+            if (seq != NULL) {
+                if (it->it_index < PyList_GET_SIZE(seq)) {
+                    PyObject *next = PyList_GET_ITEM(seq, it->it_index++);
+                    Py_INCREF(next);
+                    PUSH(next);
+                    NOTRACE_DISPATCH();
+                }
+                it->it_seq = NULL;
+                Py_DECREF(seq);
+            }
+            /* iterator ended normally */
+            STACK_SHRINK(1);
+            Py_DECREF(it);
+            JUMPBY(GET_CACHE()->adaptive.original_oparg);
+            NOTRACE_DISPATCH();
+        }
+
+        TARGET(FOR_ITER_TUPLE) {
+            assert(cframe.use_tracing == 0);
+            _PyTupleIterObject *it = (_PyTupleIterObject *)TOP();
+            DEOPT_IF(Py_TYPE(it) != &PyTupleIter_Type, FOR_ITER);
+            STAT_INC(FOR_ITER, hit);
+            PyTupleObject *seq = it->it_seq;
+            if (seq != NULL) {
+                if (it->it_index < PyTuple_GET_SIZE(seq)) {
+                    PyObject *next = PyTuple_GET_ITEM(seq, it->it_index++);
+                    Py_INCREF(next);
+                    PUSH(next);
+                    NOTRACE_DISPATCH();
+                }
+                it->it_seq = NULL;
+                Py_DECREF(seq);
+            }
+            /* iterator ended normally */
+            STACK_SHRINK(1);
+            Py_DECREF(it);
+            JUMPBY(GET_CACHE()->adaptive.original_oparg);
+            NOTRACE_DISPATCH();
+        }
+
+        TARGET(FOR_ITER_RANGE) {
+            assert(cframe.use_tracing == 0);
+            // Combined: FOR_ITER (range iterator) + STORE_FAST
+            _PyRangeIterObject *r = (_PyRangeIterObject *)TOP();
+            DEOPT_IF(Py_TYPE(r) != &PyRangeIter_Type, FOR_ITER);
+            STAT_INC(FOR_ITER, hit);
+            _Py_CODEUNIT store = *next_instr;
+            assert(_Py_OPCODE(store) == STORE_FAST ||
+                   _Py_OPCODE(store) == STORE_FAST__LOAD_FAST);
+            if (r->index < r->len) {
+                /* cast to unsigned to avoid possible signed overflow
+                   in intermediate calculations. */
+                long value = (long)(r->start +
+                                    (unsigned long)(r->index++) * r->step);
+                if (_PyLong_AssignValue(&GETLOCAL(_Py_OPARG(store)), value) < 0) {
+                    goto error;
+                }
+                // The STORE_FAST is already done.
+                next_instr++;
+                NOTRACE_DISPATCH();
+            }
+            /* iterator ended normally */
+            STACK_SHRINK(1);
+            Py_DECREF(r);
+            JUMPBY(GET_CACHE()->adaptive.original_oparg);
+            NOTRACE_DISPATCH();
+        }
+
+        TARGET(FOR_ITER_DICT_ITEMS) {
+            assert(cframe.use_tracing == 0);
+            // Combined: FOR_ITER (dict items iterator) + UNPACK_SEQUENCE 2
+            PyObject *it = TOP();
+            DEOPT_IF(Py_TYPE(it) != &PyDictIterItem_Type, FOR_ITER);
+            STAT_INC(FOR_ITER, hit);
+            PyObject *key, *value;
+            int found = _PyDictIter_NextItem(it, &key, &value);
+            if (found < 0) {
+                goto error;
+            }
+            if (found) {
+                PUSH(value);
+                PUSH(key);
+                // The UNPACK_SEQUENCE is already done.
+                next_instr++;
+                NOTRACE_DISPATCH();
+            }
+            /* iterator ended normally */
+            STACK_SHRINK(1);
+            Py_DECREF(it);
+            JUMPBY(GET_CACHE()->adaptive.original_oparg);
+            NOTRACE_DISPATCH();
+        }
+
         TARGET(BEFORE_ASYNC_WITH) {
             _Py_IDENTIFIER(__aenter__);
             _Py_IDENTIFIER(__aexit__);
@@ -4396,6 +4833,8 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, InterpreterFrame *frame, int thr
                We'll be passing `oparg + 1` to call_function, to
                make it accept the `self` as a first argument.
             */
+            PREDICTED(CALL_METHOD);
+            STAT_INC(CALL_METHOD, unquickened);
             int is_method = (PEEK(oparg + 2) != NULL);
             oparg += is_method;
             nargs = oparg;
@@ -4404,9 +4843,69 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, InterpreterFrame *frame, int thr
             goto call_function;
         }
 
+        TARGET(CALL_METHOD_ADAPTIVE) {
+            SpecializedCacheEntry *cache = GET_CACHE();
+            if (cache->adaptive.counter == 0) {
+                int nargs = cache->adaptive.original_oparg;
+                next_instr--;
+                if (_Py_Specialize_CallMethod(
+                    PEEK(nargs + 2), next_instr, nargs, cache) < 0) {
+                    goto error;
+                }
+                DISPATCH();
+            }
+            else {
+                STAT_INC(CALL_METHOD, deferred);
+                cache->adaptive.counter--;
+                oparg = cache->adaptive.original_oparg;
+                STAT_DEC(CALL_METHOD, unquickened);
+                JUMP_TO_INSTRUCTION(CALL_METHOD);
+            }
+        }
+
+        TARGET(CALL_METHOD_PY_EXACT_ARGS) {
+            assert(cframe.use_tracing == 0);
+            _PyAdaptiveEntry *cache0 = &GET_CACHE()->adaptive;
+            /* self is the first argument */
+            int argcount = cache0->original_oparg + 1;
+            PyObject *meth = PEEK(argcount + 1);
+            DEOPT_IF(meth == NULL, CALL_METHOD);
+            DEOPT_IF(!PyFunction_Check(meth), CALL_METHOD);
+            PyFunctionObject *func = (PyFunctionObject *)meth;
+            /* The version also pins co_argcount to argcount */
+            DEOPT_IF(func->func_version != cache0->version, CALL_METHOD);
+            /* PEP 523 */
+            DEOPT_IF(tstate->interp->eval_frame != NULL, CALL_METHOD);
+            STAT_INC(CALL_METHOD, hit);
+            PyCodeObject *code = (PyCodeObject *)func->func_code;
+            size_t size = code->co_nlocalsplus + code->co_stacksize + FRAME_SPECIALS_SIZE;
+            InterpreterFrame *new_frame = _PyThreadState_BumpFramePointer(tstate, size);
+            if (new_frame == NULL) {
+                goto error;
+            }
+            _PyFrame_InitializeSpecials(new_frame, func,
+                                        NULL, code->co_nlocalsplus);
+            STACK_SHRINK(argcount);
+            for (int i = 0; i < argcount; i++) {
+                new_frame->localsplus[i] = stack_pointer[i];
+            }
+            for (int i = argcount; i < code->co_nlocalsplus; i++) {
+                new_frame->localsplus[i] = NULL;
+            }
+            STACK_SHRINK(1);
+            Py_DECREF(func);
+            _PyFrame_SetStackPointer(frame, stack_pointer);
+            new_frame->previous = frame;
+            frame = cframe.current_frame = new_frame;
+            new_frame->depth = frame->depth + 1;
+            goto start_frame;
+        }
+
         TARGET(CALL_METHOD_KW) {
             /* Designed to work in tandem with LOAD_METHOD. Same as CALL_METHOD
             but pops TOS to get a tuple of keyword names. */
+            PREDICTED(CALL_METHOD_KW);
+            STAT_INC(CALL_METHOD_KW, unquickened);
             kwnames = POP();
             int is_method = (PEEK(oparg + 2) != NULL);
             oparg += is_method;
@@ -4416,6 +4915,8 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, InterpreterFrame *frame, int thr
         }
 
         TARGET(CALL_FUNCTION_KW) {
+            PREDICTED(CALL_FUNCTION_KW);
+            STAT_INC(CALL_FUNCTION_KW, unquickened);
             kwnames = POP();
             nargs = oparg - (int)PyTuple_GET_SIZE(kwnames);
             postcall_shrink = 1;
@@ -4559,6 +5060,205 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, InterpreterFrame *frame, int thr
             goto start_frame;
         }
 
+        TARGET(CALL_FUNCTION_KW_ADAPTIVE) {
+            SpecializedCacheEntry *cache = GET_CACHE();
+            if (cache->adaptive.counter == 0) {
+                PyObject *names = TOP();
+                int argcount = cache->adaptive.original_oparg;
+                int nargs = argcount - (int)PyTuple_GET_SIZE(names);
+                next_instr--;
+                if (_Py_Specialize_CallFunctionKw(
+                    PEEK(argcount + 2), names, next_instr, nargs, cache,
+                    consts) < 0) {
+                    goto error;
+                }
+                DISPATCH();
+            }
+            else {
+                STAT_INC(CALL_FUNCTION_KW, deferred);
+                cache->adaptive.counter--;
+                oparg = cache->adaptive.original_oparg;
+                STAT_DEC(CALL_FUNCTION_KW, unquickened);
+                JUMP_TO_INSTRUCTION(CALL_FUNCTION_KW);
+            }
+        }
+
+        TARGET(CALL_FUNCTION_KW_PY) {
+            assert(cframe.use_tracing == 0);
+            SpecializedCacheEntry *caches = GET_CACHE();
+            _PyAdaptiveEntry *cache0 = &caches[0].adaptive;
+            int argcount = cache0->original_oparg;
+            PyObject *names = TOP();
+            DEOPT_IF(names != caches[-1].obj.obj, CALL_FUNCTION_KW);
+            PyObject *callable = PEEK(argcount + 2);
+            DEOPT_IF(!PyFunction_Check(callable), CALL_FUNCTION_KW);
+            PyFunctionObject *func = (PyFunctionObject *)callable;
+            DEOPT_IF(func->func_version != cache0->version, CALL_FUNCTION_KW);
+            /* PEP 523 */
+            DEOPT_IF(tstate->interp->eval_frame != NULL, CALL_FUNCTION_KW);
+            STAT_INC(CALL_FUNCTION_KW, hit);
+            int kwcount = (int)PyTuple_GET_SIZE(names);
+            STACK_SHRINK(1);
+            Py_DECREF(names);
+            STACK_SHRINK(argcount);
+            InterpreterFrame *new_frame = push_kwcall_frame(
+                tstate, func, stack_pointer, argcount - kwcount, kwcount,
+                caches[-2].kwcall.slots);
+            STACK_SHRINK(1);
+            Py_DECREF(func);
+            if (new_frame == NULL) {
+                goto error;
+            }
+            _PyFrame_SetStackPointer(frame, stack_pointer);
+            new_frame->previous = frame;
+            frame = cframe.current_frame = new_frame;
+            new_frame->depth = frame->depth + 1;
+            goto start_frame;
+        }
+
+        TARGET(CALL_FUNCTION_KW_BUILTIN) {
+            assert(cframe.use_tracing == 0);
+            /* Builtin METH_FASTCALL | METH_KEYWORDS functions */
+            SpecializedCacheEntry *caches = GET_CACHE();
+            int argcount = caches[0].adaptive.original_oparg;
+            PyObject **pfunc = &PEEK(argcount + 2);
+            PyObject *callable = *pfunc;
+            DEOPT_IF(!PyCFunction_CheckExact(callable), CALL_FUNCTION_KW);
+            DEOPT_IF(PyCFunction_GET_FLAGS(callable) !=
+                     (METH_FASTCALL | METH_KEYWORDS), CALL_FUNCTION_KW);
+            STAT_INC(CALL_FUNCTION_KW, hit);
+
+            PyObject *names = TOP();
+            int nargs = argcount - (int)PyTuple_GET_SIZE(names);
+            PyCFunction cfunc = PyCFunction_GET_FUNCTION(callable);
+            /* res = func(self, args, nargs, kwnames) */
+            PyObject *res = ((_PyCFunctionFastWithKeywords)(void(*)(void))cfunc)(
+                PyCFunction_GET_SELF(callable),
+                &PEEK(argcount + 1),
+                nargs, names);
+            assert((res != NULL) ^ (_PyErr_Occurred(tstate) != NULL));
+
+            /* Clear the stack of the function object. */
+            while (stack_pointer > pfunc) {
+                PyObject *x = POP();
+                Py_DECREF(x);
+            }
+            PUSH(res);
+            if (res == NULL) {
+                goto error;
+            }
+            DISPATCH();
+        }
+
+        TARGET(CALL_METHOD_KW_ADAPTIVE) {
+            SpecializedCacheEntry *cache = GET_CACHE();
+            if (cache->adaptive.counter == 0) {
+                PyObject *names = TOP();
+                int argcount = cache->adaptive.original_oparg;
+                int nargs = argcount - (int)PyTuple_GET_SIZE(names);
+                next_instr--;
+                if (_Py_Specialize_CallMethodKw(
+                    PEEK(argcount + 3), PEEK(argcount + 2), names, next_instr,
+                    nargs, cache, consts) < 0) {
+                    goto error;
+                }
+                DISPATCH();
+            }
+            else {
+                STAT_INC(CALL_METHOD_KW, deferred);
+                cache->adaptive.counter--;
+                oparg = cache->adaptive.original_oparg;
+                STAT_DEC(CALL_METHOD_KW, unquickened);
+                JUMP_TO_INSTRUCTION(CALL_METHOD_KW);
+            }
+        }
+
+        TARGET(CALL_METHOD_KW_PY) {
+            assert(cframe.use_tracing == 0);
+            SpecializedCacheEntry *caches = GET_CACHE();
+            _PyAdaptiveEntry *cache0 = &caches[0].adaptive;
+            int argcount = cache0->original_oparg;
+            PyObject *names = TOP();
+            DEOPT_IF(names != caches[-1].obj.obj, CALL_METHOD_KW);
+            int is_method = (PEEK(argcount + 3) != NULL);
+            DEOPT_IF(is_method != cache0->index, CALL_METHOD_KW);
+            PyObject *callable = PEEK(argcount + 2 + is_method);
+            DEOPT_IF(!PyFunction_Check(callable), CALL_METHOD_KW);
+            PyFunctionObject *func = (PyFunctionObject *)callable;
+            DEOPT_IF(func->func_version != cache0->version, CALL_METHOD_KW);
+            /* PEP 523 */
+            DEOPT_IF(tstate->interp->eval_frame != NULL, CALL_METHOD_KW);
+            STAT_INC(CALL_METHOD_KW, hit);
+            int kwcount = (int)PyTuple_GET_SIZE(names);
+            STACK_SHRINK(1);
+            Py_DECREF(names);
+            /* self, if any, becomes the first positional argument */
+            argcount += is_method;
+            STACK_SHRINK(argcount);
+            InterpreterFrame *new_frame = push_kwcall_frame(
+                tstate, func, stack_pointer, argcount - kwcount, kwcount,
+                caches[-2].kwcall.slots);
+            STACK_SHRINK(2 - is_method);
+            Py_DECREF(func);
+            if (new_frame == NULL) {
+                goto error;
+            }
+            _PyFrame_SetStackPointer(frame, stack_pointer);
+            new_frame->previous = frame;
+            frame = cframe.current_frame = new_frame;
+            new_frame->depth = frame->depth + 1;
+            goto start_frame;
+        }
+
+        TARGET(CALL_METHOD_KW_BUILTIN) {
+            assert(cframe.use_tracing == 0);
+            /* Builtin METH_FASTCALL | METH_KEYWORDS functions, either a
+               method descriptor and its self, or NULL and a builtin function */
+            SpecializedCacheEntry *caches = GET_CACHE();
+            _PyAdaptiveEntry *cache0 = &caches[0].adaptive;
+            int argcount = cache0->original_oparg;
+            PyObject **pmeth = &PEEK(argcount + 3);
+            int is_method = (*pmeth != NULL);
+            DEOPT_IF(is_method != cache0->index, CALL_METHOD_KW);
+            PyObject *self = PEEK(argcount + 2);
+            PyCFunction cfunc;
+            if (is_method) {
+                PyObject *meth = *pmeth;
+                DEOPT_IF(!Py_IS_TYPE(meth, &PyMethodDescr_Type), CALL_METHOD_KW);
+                PyMethodDef *ml = ((PyMethodDescrObject *)meth)->d_method;
+                DEOPT_IF(ml->ml_flags != (METH_FASTCALL | METH_KEYWORDS),
+                         CALL_METHOD_KW);
+                DEOPT_IF(!Py_IS_TYPE(self, PyDescr_TYPE(meth)), CALL_METHOD_KW);
+                cfunc = ml->ml_meth;
+            }
+            else {
+                DEOPT_IF(!PyCFunction_CheckExact(self), CALL_METHOD_KW);
+                DEOPT_IF(PyCFunction_GET_FLAGS(self) !=
+                         (METH_FASTCALL | METH_KEYWORDS), CALL_METHOD_KW);
+                cfunc = PyCFunction_GET_FUNCTION(self);
+                self = PyCFunction_GET_SELF(self);
+            }
+            STAT_INC(CALL_METHOD_KW, hit);
+
+            PyObject *names = TOP();
+            int nargs = argcount - (int)PyTuple_GET_SIZE(names);
+            /* res = func(self, args, nargs, kwnames) */
+            PyObject *res = ((_PyCFunctionFastWithKeywords)(void(*)(void))cfunc)(
+                self, &PEEK(argcount + 1), nargs, names);
+            assert((res != NULL) ^ (_PyErr_Occurred(tstate) != NULL));
+
+            /* Clear the stack of the callable, self and the NULL, if any. */
+            while (stack_pointer > pmeth) {
+                PyObject *x = POP();
+                Py_XDECREF(x);
+            }
+            PUSH(res);
+            if (res == NULL) {
+                goto error;
+            }
+            DISPATCH();
+        }
+
         TARGET(CALL_FUNCTION_BUILTIN_O) {
             assert(cframe.use_tracing == 0);
             /* Builtin METH_O functions */
@@ -4965,6 +5665,7 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, InterpreterFrame *frame, int thr
 opname ## _miss: \
     { \
         STAT_INC(opname, miss); \
+        CODE_STAT_MISS(frame->f_code); \
         _PyAdaptiveEntry *cache = &GET_CACHE()->adaptive; \
         cache->counter--; \
         if (cache->counter == 0) { \
@@ -4981,6 +5682,7 @@ opname ## _miss: \
 opname ## _miss: \
     { \
         STAT_INC(opname, miss); \
+        CODE_STAT_MISS(frame->f_code); \
         uint8_t oparg = _Py_OPARG(next_instr[-1])-1; \
         UPDATE_PREV_INSTR_OPARG(next_instr, oparg); \
         assert(_Py_OPARG(next_instr[-1]) == oparg); \
@@ -4998,8 +5700,14 @@ MISS_WITH_CACHE(STORE_ATTR)
 MISS_WITH_CACHE(LOAD_GLOBAL)
 MISS_WITH_CACHE(LOAD_METHOD)
 MISS_WITH_CACHE(CALL_FUNCTION)
+MISS_WITH_CACHE(CALL_METHOD)
+MISS_WITH_CACHE(CALL_FUNCTION_KW)
+MISS_WITH_CACHE(CALL_METHOD_KW)
 MISS_WITH_CACHE(BINARY_OP)
 MISS_WITH_CACHE(BINARY_SUBSCR)
+MISS_WITH_CACHE(COMPARE_OP)
+MISS_WITH_CACHE(FOR_ITER)
+MISS_WITH_CACHE(UNPACK_SEQUENCE)
 MISS_WITH_OPARG_COUNTER(STORE_SUBSCR)
 
 binary_subscr_dict_error:
@@ -5783,6 +6491,85 @@ _PyEvalFrameClearAndPop(PyThreadState *tstate, InterpreterFrame * frame)
     return 0;
 }
 
+/* Push a frame for CALL_FUNCTION_KW_PY and CALL_METHOD_KW_PY.
+   The specializer has already resolved each keyword to the slot of the
+   parameter it binds, and checked that every other parameter either is
+   passed positionally or has a default.
+   Consumes all the references to the args */
+static InterpreterFrame *
+push_kwcall_frame(PyThreadState *tstate, PyFunctionObject *func,
+                  PyObject **args, int nargs, int kwcount,
+                  const uint8_t *slots)
+{
+    PyCodeObject *code = (PyCodeObject *)func->func_code;
+    size_t size = code->co_nlocalsplus + code->co_stacksize + FRAME_SPECIALS_SIZE;
+    InterpreterFrame *frame = _PyThreadState_BumpFramePointer(tstate, size);
+    if (frame == NULL) {
+        for (int i = 0; i < nargs + kwcount; i++) {
+            Py_DECREF(args[i]);
+        }
+        PyErr_NoMemory();
+        return NULL;
+    }
+    _PyFrame_InitializeSpecials(frame, func, NULL, code->co_nlocalsplus);
+    PyObject **localsplus = &frame->localsplus[0];
+    for (int i = 0; i < nargs; i++) {
+        localsplus[i] = args[i];
+    }
+    for (int i = nargs; i < code->co_nlocalsplus; i++) {
+        localsplus[i] = NULL;
+    }
+    for (int i = 0; i < kwcount; i++) {
+        assert(slots[i] >= nargs && localsplus[slots[i]] == NULL);
+        localsplus[slots[i]] = args[nargs + i];
+    }
+    /* func_defaults cannot change without changing func_version */
+    int argcount = code->co_argcount;
+    if (nargs < argcount) {
+        PyObject *defaults = func->func_defaults;
+        int defstart = argcount -
+            (defaults == NULL ? 0 : (int)PyTuple_GET_SIZE(defaults));
+        for (int i = nargs; i < argcount; i++) {
+            if (localsplus[i] == NULL) {
+                assert(i >= defstart);
+                PyObject *def = PyTuple_GET_ITEM(defaults, i - defstart);
+                Py_INCREF(def);
+                localsplus[i] = def;
+            }
+        }
+    }
+    /* but __kwdefaults__ can be mutated in place */
+    int total_args = argcount + code->co_kwonlyargcount;
+    Py_ssize_t missing = 0;
+    for (int i = argcount; i < total_args; i++) {
+        if (localsplus[i] != NULL) {
+            continue;
+        }
+        if (func->func_kwdefaults != NULL) {
+            PyObject *varname = PyTuple_GET_ITEM(code->co_localsplusnames, i);
+            PyObject *def = PyDict_GetItemWithError(func->func_kwdefaults, varname);
+            if (def) {
+                Py_INCREF(def);
+                localsplus[i] = def;
+                continue;
+            }
+            else if (_PyErr_Occurred(tstate)) {
+                goto fail;
+            }
+        }
+        missing++;
+    }
+    if (missing) {
+        missing_arguments(tstate, code, missing, -1, localsplus,
+                          func->func_qualname);
+        goto fail;
+    }
+    return frame;
+fail:
+    _PyEvalFrameClearAndPop(tstate, frame);
+    return NULL;
+}
+
 PyObject *
 _PyEval_Vector(PyThreadState *tstate, PyFunctionObject *func,
                PyObject *locals,
@@ -7106,6 +7893,80 @@ _Py_GetDXProfile(PyObject *self, PyObject *args)
 
 #endif
 
+int
+_PyEval_SetDXPSampling(int interval)
+{
+    if (interval < 0) {
+        PyErr_SetString(PyExc_ValueError,
+                        "sampling interval must be greater than or equal to 0");
+        return -1;
+    }
+    struct _ceval_state *ceval = &_PyInterpreterState_GET()->ceval;
+    if (interval > 0 && ceval->dxp_samples == NULL) {
+        ceval->dxp_samples = PyMem_RawMalloc(DXP_MAX_SAMPLES
+                                             * sizeof(dxp_sample));
+        if (ceval->dxp_samples == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+    int old = ceval->dxp_sample_interval;
+    ceval->dxp_sample_interval = interval;
+    ceval->dxp_sample_countdown =
+        ceval->dxp_nsamples < DXP_MAX_SAMPLES ? interval : 0;
+    return old;
+}
+
+PyObject *
+_PyEval_GetDXPSamples(void)
+{
+    /* Take the samples out of the buffer and resume sampling if a full
+       buffer paused it. Building the list and releasing the code objects
+       can run arbitrary code, which may record or take samples too. */
+    struct _ceval_state *ceval = &_PyInterpreterState_GET()->ceval;
+    int n = ceval->dxp_nsamples;
+    dxp_sample *samples = PyMem_RawMalloc(Py_MAX(n, 1) * sizeof(dxp_sample));
+    if (samples == NULL) {
+        return PyErr_NoMemory();
+    }
+    if (n > 0) {
+        memcpy(samples, ceval->dxp_samples, n * sizeof(dxp_sample));
+    }
+    ceval->dxp_nsamples = 0;
+    ceval->dxp_sample_countdown = ceval->dxp_sample_interval;
+
+    PyObject *res = PyList_New(n);
+    for (int i = 0; i < n && res != NULL; i++) {
+        PyObject *item = Py_BuildValue("(Oii)", samples[i].code,
+                                       samples[i].prev_opcode,
+                                       samples[i].opcode);
+        if (item == NULL) {
+            Py_CLEAR(res);
+            break;
+        }
+        PyList_SET_ITEM(res, i, item);
+    }
+    for (int i = 0; i < n; i++) {
+        Py_DECREF(samples[i].code);
+    }
+    PyMem_RawFree(samples);
+    return res;
+}
+
+void
+_PyEval_FiniDXPSampling(PyInterpreterState *interp)
+{
+    struct _ceval_state *ceval = &interp->ceval;
+    ceval->dxp_sample_interval = ceval->dxp_sample_countdown = 0;
+    if (ceval->dxp_samples != NULL) {
+        while (ceval->dxp_nsamples > 0) {
+            Py_DECREF(ceval->dxp_samples[--ceval->dxp_nsamples].code);
+        }
+        PyMem_RawFree(ceval->dxp_samples);
+        ceval->dxp_samples = NULL;
+    }
+}
+
 Py_ssize_t
 _PyEval_RequestCodeExtraIndex(freefunc free)
 {
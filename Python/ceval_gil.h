@@ -6,6 +6,7 @@
 #include <errno.h>
 
 #include "pycore_atomic.h"
+#include "pycore_bitutils.h"      // _Py_bit_length()
 
 
 /*
@@ -47,6 +48,25 @@
      run and end up being the first to re-acquire it, making the "timeslices"
      much longer than expected.
      (Note: this mechanism is enabled with FORCE_SWITCHING above)
+
+   - With the default policy, a thread coming back from a blocking call
+     (Py_END_ALLOW_THREADS) competes for the GIL like any other thread: it
+     waits `interval` microseconds before asking for the GIL, and then may
+     lose the race against the CPU-bound thread which just dropped it (the
+     "convoy effect").  With the "io" policy (`sys._setswitchpolicy()`),
+     such a thread sets gil_drop_request at once and waits on a separate
+     condition variable (prio_cond); drop_gil() wakes prioritized threads
+     first, and other threads don't take the GIL while one is waiting.
+
+   - The time a thread spends waiting in take_gil() is accumulated in
+     tstate->gil_wait_time, see `sys._getgilwaittime()`.
+
+   - take_gil() and drop_gil() also keep statistics in gil->stats (and
+     per thread in the tstate): wait and hold times, a histogram of the
+     wait times, drop requests and forced or voluntary drops.  They are
+     updated with the mutex held, which these functions take anyway, and
+     cost a monotonic clock read per GIL acquisition and release; see
+     `sys._getgilstats()`.
 */
 
 #include "condvar.h"
@@ -95,6 +115,7 @@ static void _gil_initialize(struct _gil_runtime_state *gil)
     _Py_atomic_int uninitialized = {-1};
     gil->locked = uninitialized;
     gil->interval = DEFAULT_INTERVAL;
+    gil->policy = _Py_GIL_POLICY_INTERVAL;
 }
 
 static int gil_created(struct _gil_runtime_state *gil)
@@ -109,9 +130,13 @@ static void create_gil(struct _gil_runtime_state *gil)
     MUTEX_INIT(gil->switch_mutex);
 #endif
     COND_INIT(gil->cond);
+    COND_INIT(gil->prio_cond);
 #ifdef FORCE_SWITCHING
     COND_INIT(gil->switch_cond);
 #endif
+    gil->prio_waiters = 0;
+    gil->hold_start = 0;
+    memset(&gil->stats, 0, sizeof(gil->stats));
     _Py_atomic_store_relaxed(&gil->last_holder, 0);
     _Py_ANNOTATE_RWLOCK_CREATE(&gil->locked);
     _Py_atomic_store_explicit(&gil->locked, 0, _Py_memory_order_release);
@@ -123,6 +148,7 @@ static void destroy_gil(struct _gil_runtime_state *gil)
      * and must have the cond destroyed first.
      */
     COND_FINI(gil->cond);
+    COND_FINI(gil->prio_cond);
     MUTEX_FINI(gil->mutex);
 #ifdef FORCE_SWITCHING
     COND_FINI(gil->switch_cond);
@@ -140,15 +166,30 @@ static void recreate_gil(struct _gil_runtime_state *gil)
     create_gil(gil);
 }
 
+/* Check if a Python thread must exit immediately, rather than taking the GIL
+   if Py_Finalize() has been called.
+
+   When this function is called by a daemon thread after Py_Finalize() has been
+   called, the GIL does no longer exist.
+
+   tstate must be non-NULL. */
+static inline int
+tstate_must_exit(PyThreadState *tstate)
+{
+    /* bpo-39877: Access _PyRuntime directly rather than using
+       tstate->interp->runtime to support calls from Python daemon threads.
+       After Py_Finalize() has been called, tstate can be a dangling pointer:
+       point to PyThreadState freed memory. */
+    PyThreadState *finalizing = _PyRuntimeState_GetFinalizing(&_PyRuntime);
+    return (finalizing != NULL && finalizing != tstate);
+}
+
+
 static void
 drop_gil(struct _ceval_runtime_state *ceval, struct _ceval_state *ceval2,
          PyThreadState *tstate)
 {
-#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
-    struct _gil_runtime_state *gil = &ceval2->gil;
-#else
-    struct _gil_runtime_state *gil = &ceval->gil;
-#endif
+    struct _gil_runtime_state *gil = ceval2->gil;
     if (!_Py_atomic_load_relaxed(&gil->locked)) {
         Py_FatalError("drop_gil: GIL is not locked");
     }
@@ -162,9 +203,31 @@ drop_gil(struct _ceval_runtime_state *ceval, struct _ceval_state *ceval2,
     }
 
     MUTEX_LOCK(gil->mutex);
+    _PyTime_t held = _PyTime_GetMonotonicClock() - gil->hold_start;
+    int forced = _Py_atomic_load_relaxed(&ceval2->gil_drop_request);
+    gil->stats.hold_time += held;
+    if (forced) {
+        gil->stats.forced_drops++;
+    }
+    else {
+        gil->stats.voluntary_drops++;
+    }
+    /* Don't access tstate if the thread must exit: see take_gil() */
+    if (tstate != NULL && !tstate_must_exit(tstate)) {
+        tstate->gil_hold_time += held;
+        if (forced) {
+            tstate->gil_forced_drops++;
+        }
+    }
+
     _Py_ANNOTATE_RWLOCK_RELEASED(&gil->locked, /*is_write=*/1);
     _Py_atomic_store_relaxed(&gil->locked, 0);
-    COND_SIGNAL(gil->cond);
+    if (gil->prio_waiters) {
+        COND_SIGNAL(gil->prio_cond);
+    }
+    else {
+        COND_SIGNAL(gil->cond);
+    }
     MUTEX_UNLOCK(gil->mutex);
 
 #ifdef FORCE_SWITCHING
@@ -187,32 +250,16 @@ drop_gil(struct _ceval_runtime_state *ceval, struct _ceval_state *ceval2,
 }
 
 
-/* Check if a Python thread must exit immediately, rather than taking the GIL
-   if Py_Finalize() has been called.
-
-   When this function is called by a daemon thread after Py_Finalize() has been
-   called, the GIL does no longer exist.
-
-   tstate must be non-NULL. */
-static inline int
-tstate_must_exit(PyThreadState *tstate)
-{
-    /* bpo-39877: Access _PyRuntime directly rather than using
-       tstate->interp->runtime to support calls from Python daemon threads.
-       After Py_Finalize() has been called, tstate can be a dangling pointer:
-       point to PyThreadState freed memory. */
-    PyThreadState *finalizing = _PyRuntimeState_GetFinalizing(&_PyRuntime);
-    return (finalizing != NULL && finalizing != tstate);
-}
-
-
 /* Take the GIL.
 
+   after_io is non-zero if the thread is coming back from a blocking call
+   (PyEval_RestoreThread()): it gets priority with the "io" policy.
+
    The function saves errno at entry and restores its value at exit.
 
    tstate must be non-NULL. */
 static void
-take_gil(PyThreadState *tstate)
+take_gil(PyThreadState *tstate, int after_io)
 {
     int err = errno;
 
@@ -232,27 +279,45 @@ take_gil(PyThreadState *tstate)
     PyInterpreterState *interp = tstate->interp;
     struct _ceval_runtime_state *ceval = &interp->runtime->ceval;
     struct _ceval_state *ceval2 = &interp->ceval;
-#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
-    struct _gil_runtime_state *gil = &ceval2->gil;
-#else
-    struct _gil_runtime_state *gil = &ceval->gil;
-#endif
+    struct _gil_runtime_state *gil = ceval2->gil;
 
     /* Check that _PyEval_InitThreads() was called to create the lock */
     assert(gil_created(gil));
 
     MUTEX_LOCK(gil->mutex);
 
-    if (!_Py_atomic_load_relaxed(&gil->locked)) {
+    int prio = (after_io && gil->policy == _Py_GIL_POLICY_IO);
+    _PyTime_t wait_start = 0;
+    if (!_Py_atomic_load_relaxed(&gil->locked) &&
+        (prio || gil->prio_waiters == 0))
+    {
         goto _ready;
     }
 
-    while (_Py_atomic_load_relaxed(&gil->locked)) {
+    wait_start = _PyTime_GetMonotonicClock();
+    if (prio) {
+        /* Don't wait for the interval to elapse before asking the holder
+           to drop the GIL. */
+        gil->prio_waiters++;
+        if (_Py_atomic_load_relaxed(&gil->locked)) {
+            SET_GIL_DROP_REQUEST(interp);
+            gil->stats.priority_requests++;
+        }
+    }
+
+    while (_Py_atomic_load_relaxed(&gil->locked) ||
+           (!prio && gil->prio_waiters))
+    {
         unsigned long saved_switchnum = gil->switch_number;
 
         unsigned long interval = (gil->interval >= 1 ? gil->interval : 1);
         int timed_out = 0;
-        COND_TIMED_WAIT(gil->cond, gil->mutex, interval, timed_out);
+        if (prio) {
+            COND_TIMED_WAIT(gil->prio_cond, gil->mutex, interval, timed_out);
+        }
+        else {
+            COND_TIMED_WAIT(gil->cond, gil->mutex, interval, timed_out);
+        }
 
         /* If we timed out and no switch occurred in the meantime, it is time
            to ask the GIL-holding thread to drop it. */
@@ -261,15 +326,23 @@ take_gil(PyThreadState *tstate)
             gil->switch_number == saved_switchnum)
         {
             if (tstate_must_exit(tstate)) {
+                if (prio) {
+                    gil->prio_waiters--;
+                }
                 MUTEX_UNLOCK(gil->mutex);
                 PyThread_exit_thread();
             }
             assert(is_tstate_valid(tstate));
 
             SET_GIL_DROP_REQUEST(interp);
+            gil->stats.timeout_requests++;
         }
     }
 
+    if (prio) {
+        gil->prio_waiters--;
+    }
+
 _ready:
 #ifdef FORCE_SWITCHING
     /* This mutex must be taken before modifying gil->last_holder:
@@ -279,6 +352,8 @@ take_gil(PyThreadState *tstate)
     /* We now hold the GIL */
     _Py_atomic_store_relaxed(&gil->locked, 1);
     _Py_ANNOTATE_RWLOCK_ACQUIRED(&gil->locked, /*is_write=*/1);
+    _PyTime_t now = _PyTime_GetMonotonicClock();
+    gil->hold_start = now;
 
     if (tstate != (PyThreadState*)_Py_atomic_load_relaxed(&gil->last_holder)) {
         _Py_atomic_store_relaxed(&gil->last_holder, (uintptr_t)tstate);
@@ -304,6 +379,18 @@ take_gil(PyThreadState *tstate)
     }
     assert(is_tstate_valid(tstate));
 
+    if (wait_start != 0) {
+        _PyTime_t waited = now - wait_start;
+        tstate->gil_wait_time += waited;
+        gil->stats.contended++;
+        gil->stats.wait_time += waited;
+        int bucket = _Py_bit_length((unsigned long)(waited / 1000));
+        if (bucket >= _Py_GIL_WAIT_BUCKETS) {
+            bucket = _Py_GIL_WAIT_BUCKETS - 1;
+        }
+        gil->stats.wait_histogram[bucket]++;
+    }
+
     if (_Py_atomic_load_relaxed(&ceval2->gil_drop_request)) {
         RESET_GIL_DROP_REQUEST(interp);
     }
@@ -328,22 +415,75 @@ take_gil(PyThreadState *tstate)
 
 void _PyEval_SetSwitchInterval(unsigned long microseconds)
 {
-#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
-    PyInterpreterState *interp = PyInterpreterState_Get();
-    struct _gil_runtime_state *gil = &interp->ceval.gil;
-#else
-    struct _gil_runtime_state *gil = &_PyRuntime.ceval.gil;
-#endif
+    struct _gil_runtime_state *gil = PyInterpreterState_Get()->ceval.gil;
     gil->interval = microseconds;
 }
 
 unsigned long _PyEval_GetSwitchInterval()
 {
-#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
-    PyInterpreterState *interp = PyInterpreterState_Get();
-    struct _gil_runtime_state *gil = &interp->ceval.gil;
-#else
-    struct _gil_runtime_state *gil = &_PyRuntime.ceval.gil;
-#endif
+    struct _gil_runtime_state *gil = PyInterpreterState_Get()->ceval.gil;
     return gil->interval;
 }
+
+void _PyEval_SetSwitchPolicy(int policy)
+{
+    struct _gil_runtime_state *gil = PyInterpreterState_Get()->ceval.gil;
+    assert(policy == _Py_GIL_POLICY_INTERVAL || policy == _Py_GIL_POLICY_IO);
+    /* Threads already waiting keep the policy they started with:
+       prio_waiters stays consistent. */
+    gil->policy = policy;
+}
+
+int _PyEval_GetSwitchPolicy(void)
+{
+    struct _gil_runtime_state *gil = PyInterpreterState_Get()->ceval.gil;
+    return gil->policy;
+}
+
+/* Return a dict of the GIL statistics, with the statistics of tstate, which
+   must hold the GIL, in the "thread" item. */
+PyObject *
+_PyEval_GetGILStats(PyThreadState *tstate)
+{
+    struct _gil_runtime_state *gil = tstate->interp->ceval.gil;
+    MUTEX_LOCK(gil->mutex);
+    struct _gil_stats stats = gil->stats;
+    unsigned long switches = gil->switch_number;
+    /* Count the current hold, which is not over yet */
+    _PyTime_t held = _PyTime_GetMonotonicClock() - gil->hold_start;
+    MUTEX_UNLOCK(gil->mutex);
+
+    PyObject *histogram = PyTuple_New(_Py_GIL_WAIT_BUCKETS);
+    if (histogram == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < _Py_GIL_WAIT_BUCKETS; i++) {
+        PyObject *count = PyLong_FromUnsignedLongLong(stats.wait_histogram[i]);
+        if (count == NULL) {
+            Py_DECREF(histogram);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(histogram, i, count);
+    }
+    PyObject *thread = Py_BuildValue(
+        "{sdsdsK}",
+        "wait_time", _PyTime_AsSecondsDouble(tstate->gil_wait_time),
+        "hold_time", _PyTime_AsSecondsDouble(tstate->gil_hold_time + held),
+        "forced_drops", (unsigned long long)tstate->gil_forced_drops);
+    if (thread == NULL) {
+        Py_DECREF(histogram);
+        return NULL;
+    }
+    return Py_BuildValue(
+        "{sksKsKsKsKsKsdsdsNsN}",
+        "switches", switches,
+        "contended", stats.contended,
+        "timeout_requests", stats.timeout_requests,
+        "priority_requests", stats.priority_requests,
+        "forced_drops", stats.forced_drops,
+        "voluntary_drops", stats.voluntary_drops,
+        "wait_time", _PyTime_AsSecondsDouble(stats.wait_time),
+        "hold_time", _PyTime_AsSecondsDouble(stats.hold_time + held),
+        "wait_histogram", histogram,
+        "thread", thread);
+}
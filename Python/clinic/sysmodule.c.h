@@ -350,6 +350,134 @@ sys_getswitchinterval(PyObject *module, PyObject *Py_UNUSED(ignored))
     return return_value;
 }
 
+PyDoc_STRVAR(sys__setswitchpolicy__doc__,
+"_setswitchpolicy($module, policy, /)\n"
+"--\n"
+"\n"
+"Set the policy used to hand the GIL over between threads.\n"
+"\n"
+"\"interval\" (the default): a thread waiting for the GIL asks the thread\n"
+"holding it to release it after the switch interval has elapsed.\n"
+"\n"
+"\"io\": a thread coming back from a blocking call (I/O, sleep, lock, etc.)\n"
+"asks for the GIL at once and takes it before other waiting threads.\n"
+"This lowers the latency of I/O-bound threads sharing the interpreter\n"
+"with CPU-bound threads.");
+
+#define SYS__SETSWITCHPOLICY_METHODDEF    \
+    {"_setswitchpolicy", (PyCFunction)sys__setswitchpolicy, METH_O, sys__setswitchpolicy__doc__},
+
+static PyObject *
+sys__setswitchpolicy_impl(PyObject *module, const char *policy);
+
+static PyObject *
+sys__setswitchpolicy(PyObject *module, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    const char *policy;
+
+    if (!PyUnicode_Check(arg)) {
+        _PyArg_BadArgument("_setswitchpolicy", "argument", "str", arg);
+        goto exit;
+    }
+    Py_ssize_t policy_length;
+    policy = PyUnicode_AsUTF8AndSize(arg, &policy_length);
+    if (policy == NULL) {
+        goto exit;
+    }
+    if (strlen(policy) != (size_t)policy_length) {
+        PyErr_SetString(PyExc_ValueError, "embedded null character");
+        goto exit;
+    }
+    return_value = sys__setswitchpolicy_impl(module, policy);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(sys__getswitchpolicy__doc__,
+"_getswitchpolicy($module, /)\n"
+"--\n"
+"\n"
+"Return the current GIL switch policy; see sys._setswitchpolicy().");
+
+#define SYS__GETSWITCHPOLICY_METHODDEF    \
+    {"_getswitchpolicy", (PyCFunction)sys__getswitchpolicy, METH_NOARGS, sys__getswitchpolicy__doc__},
+
+static PyObject *
+sys__getswitchpolicy_impl(PyObject *module);
+
+static PyObject *
+sys__getswitchpolicy(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    return sys__getswitchpolicy_impl(module);
+}
+
+PyDoc_STRVAR(sys__getgilwaittime__doc__,
+"_getgilwaittime($module, /)\n"
+"--\n"
+"\n"
+"Return the time in seconds the current thread spent waiting for the GIL.");
+
+#define SYS__GETGILWAITTIME_METHODDEF    \
+    {"_getgilwaittime", (PyCFunction)sys__getgilwaittime, METH_NOARGS, sys__getgilwaittime__doc__},
+
+static double
+sys__getgilwaittime_impl(PyObject *module);
+
+static PyObject *
+sys__getgilwaittime(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    PyObject *return_value = NULL;
+    double _return_value;
+
+    _return_value = sys__getgilwaittime_impl(module);
+    if ((_return_value == -1.0) && PyErr_Occurred()) {
+        goto exit;
+    }
+    return_value = PyFloat_FromDouble(_return_value);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(sys__getgilstats__doc__,
+"_getgilstats($module, /)\n"
+"--\n"
+"\n"
+"Return a dict of statistics about the contention of the GIL.\n"
+"\n"
+"Times are in seconds and counts since the start of the process:\n"
+"\n"
+"switches: number of times the GIL passed from one thread to another.\n"
+"contended: number of times a thread had to wait to take the GIL.\n"
+"timeout_requests: number of times a waiting thread asked the holder\n"
+"  to drop the GIL after the switch interval elapsed.\n"
+"priority_requests: same, by a thread returning from a blocking call\n"
+"  with the \"io\" switch policy.\n"
+"forced_drops: number of times the GIL was dropped on request.\n"
+"voluntary_drops: number of times the GIL was dropped by a thread\n"
+"  entering a blocking call or exiting.\n"
+"wait_time, hold_time: total time threads spent waiting for and holding\n"
+"  the GIL.\n"
+"wait_histogram: tuple of counts of waits shorter than 1 microsecond,\n"
+"  then in [2**(i-1), 2**i) microseconds; the last one counts longer\n"
+"  waits.\n"
+"thread: dict of the wait_time, hold_time and forced_drops of the\n"
+"  current thread.");
+
+#define SYS__GETGILSTATS_METHODDEF    \
+    {"_getgilstats", (PyCFunction)sys__getgilstats, METH_NOARGS, sys__getgilstats__doc__},
+
+static PyObject *
+sys__getgilstats_impl(PyObject *module);
+
+static PyObject *
+sys__getgilstats(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    return sys__getgilstats_impl(module);
+}
+
 PyDoc_STRVAR(sys_setrecursionlimit__doc__,
 "setrecursionlimit($module, limit, /)\n"
 "--\n"
@@ -737,6 +865,68 @@ sys__getquickenedcount(PyObject *module, PyObject *Py_UNUSED(ignored))
     return return_value;
 }
 
+PyDoc_STRVAR(sys__setdxpsampling__doc__,
+"_setdxpsampling($module, interval, /)\n"
+"--\n"
+"\n"
+"Sample the execution profile every interval instructions.\n"
+"\n"
+"Every interval-th instruction executed by the current interpreter is\n"
+"recorded as its code object, the opcode of the instruction executed\n"
+"before it in the same frame, and its own opcode. Specialized instructions\n"
+"are recorded as themselves. An interval of 0 disables sampling.\n"
+"\n"
+"Return the previous interval.");
+
+#define SYS__SETDXPSAMPLING_METHODDEF    \
+    {"_setdxpsampling", (PyCFunction)sys__setdxpsampling, METH_O, sys__setdxpsampling__doc__},
+
+static int
+sys__setdxpsampling_impl(PyObject *module, int interval);
+
+static PyObject *
+sys__setdxpsampling(PyObject *module, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    int interval;
+    int _return_value;
+
+    interval = _PyLong_AsInt(arg);
+    if (interval == -1 && PyErr_Occurred()) {
+        goto exit;
+    }
+    _return_value = sys__setdxpsampling_impl(module, interval);
+    if ((_return_value == -1) && PyErr_Occurred()) {
+        goto exit;
+    }
+    return_value = PyLong_FromLong((long)_return_value);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(sys__getdxpsamples__doc__,
+"_getdxpsamples($module, /)\n"
+"--\n"
+"\n"
+"Return and clear the execution profile samples.\n"
+"\n"
+"Return a list of (code, previous opcode, opcode) tuples, oldest first.\n"
+"Sampling pauses once the buffer of samples is full and resumes when it\n"
+"is drained, so this should be called regularly while sampling.");
+
+#define SYS__GETDXPSAMPLES_METHODDEF    \
+    {"_getdxpsamples", (PyCFunction)sys__getdxpsamples, METH_NOARGS, sys__getdxpsamples__doc__},
+
+static PyObject *
+sys__getdxpsamples_impl(PyObject *module);
+
+static PyObject *
+sys__getdxpsamples(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    return sys__getdxpsamples_impl(module);
+}
+
 PyDoc_STRVAR(sys_getallocatedblocks__doc__,
 "getallocatedblocks($module, /)\n"
 "--\n"
@@ -907,6 +1097,112 @@ sys__debugmallocstats(PyObject *module, PyObject *Py_UNUSED(ignored))
     return sys__debugmallocstats_impl(module);
 }
 
+PyDoc_STRVAR(sys__obmalloc_stats__doc__,
+"_obmalloc_stats($module, /)\n"
+"--\n"
+"\n"
+"Return a dict describing the occupancy of pymalloc\'s structures.\n"
+"\n"
+"The dict has these keys:\n"
+"\n"
+"  size_classes -- a list of dicts, one per size class with pools,\n"
+"    holding the class index, its block size, and the number of pools,\n"
+"    full pools, blocks in use and free blocks;\n"
+"  arena_usage -- a list whose item k is the number of arenas with k\n"
+"    pools in use, which shows how fragmented the arenas are;\n"
+"  arenas, arenas_allocated_total, arenas_reclaimed, arenas_highwater\n"
+"    -- arena counts;\n"
+"  free_pools -- pools that are not in use, in any arena;\n"
+"  trimmed_pools -- free pools whose memory was handed back to the OS,\n"
+"    see _obmalloc_trim();\n"
+"  trim_interval -- see _set_obmalloc_trim_interval();\n"
+"  allocated_bytes, available_bytes, free_pool_bytes, pool_header_bytes,\n"
+"    quantization_bytes, arena_alignment_bytes -- how the bytes of all\n"
+"    arenas are used, adding up to arenas * arena_size;\n"
+"  arena_map_mid_nodes, arena_map_bot_nodes, arena_map_bytes -- the\n"
+"    size of the radix tree mapping addresses to arenas, if it is used;\n"
+"  arena_size, pool_size, small_block_threshold -- constants.\n"
+"\n"
+"Return None if pymalloc is not in use.");
+
+#define SYS__OBMALLOC_STATS_METHODDEF    \
+    {"_obmalloc_stats", (PyCFunction)sys__obmalloc_stats, METH_NOARGS, sys__obmalloc_stats__doc__},
+
+static PyObject *
+sys__obmalloc_stats_impl(PyObject *module);
+
+static PyObject *
+sys__obmalloc_stats(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    return sys__obmalloc_stats_impl(module);
+}
+
+PyDoc_STRVAR(sys__obmalloc_trim__doc__,
+"_obmalloc_trim($module, /)\n"
+"--\n"
+"\n"
+"Hand the memory of pymalloc\'s empty pools and arenas back to the OS.\n"
+"\n"
+"The pages of empty pools in arenas which are still in use are discarded,\n"
+"and arenas all of whose pools are empty are released.");
+
+#define SYS__OBMALLOC_TRIM_METHODDEF    \
+    {"_obmalloc_trim", (PyCFunction)sys__obmalloc_trim, METH_NOARGS, sys__obmalloc_trim__doc__},
+
+static PyObject *
+sys__obmalloc_trim_impl(PyObject *module);
+
+static PyObject *
+sys__obmalloc_trim(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    return sys__obmalloc_trim_impl(module);
+}
+
+PyDoc_STRVAR(sys__set_obmalloc_trim_interval__doc__,
+"_set_obmalloc_trim_interval($module, interval, /)\n"
+"--\n"
+"\n"
+"Trim pymalloc\'s empty pools every interval times a pool becomes empty.\n"
+"\n"
+"Only the pools and arenas which stayed empty since the previous time are\n"
+"handed back to the OS.  0 disables automatic trimming.  Return the\n"
+"previous interval.");
+
+#define SYS__SET_OBMALLOC_TRIM_INTERVAL_METHODDEF    \
+    {"_set_obmalloc_trim_interval", (PyCFunction)sys__set_obmalloc_trim_interval, METH_O, sys__set_obmalloc_trim_interval__doc__},
+
+static Py_ssize_t
+sys__set_obmalloc_trim_interval_impl(PyObject *module, Py_ssize_t interval);
+
+static PyObject *
+sys__set_obmalloc_trim_interval(PyObject *module, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    Py_ssize_t interval;
+    Py_ssize_t _return_value;
+
+    {
+        Py_ssize_t ival = -1;
+        PyObject *iobj = _PyNumber_Index(arg);
+        if (iobj != NULL) {
+            ival = PyLong_AsSsize_t(iobj);
+            Py_DECREF(iobj);
+        }
+        if (ival == -1 && PyErr_Occurred()) {
+            goto exit;
+        }
+        interval = ival;
+    }
+    _return_value = sys__set_obmalloc_trim_interval_impl(module, interval);
+    if ((_return_value == -1) && PyErr_Occurred()) {
+        goto exit;
+    }
+    return_value = PyLong_FromSsize_t(_return_value);
+
+exit:
+    return return_value;
+}
+
 PyDoc_STRVAR(sys__clear_type_cache__doc__,
 "_clear_type_cache($module, /)\n"
 "--\n"
@@ -992,4 +1288,4 @@ sys_getandroidapilevel(PyObject *module, PyObject *Py_UNUSED(ignored))
 #ifndef SYS_GETANDROIDAPILEVEL_METHODDEF
     #define SYS_GETANDROIDAPILEVEL_METHODDEF
 #endif /* !defined(SYS_GETANDROIDAPILEVEL_METHODDEF) */
-/*[clinic end generated code: output=855fc93b2347710b input=a9049054013a1b77]*/
+/*[clinic end generated code: output=e7cdfd6319e16488 input=a9049054013a1b77]*/
@@ -104,6 +104,8 @@ static const char usage_3[] = "\
             when the interpreter displays tracebacks.\n\
          -X frozen_modules=[on|off]: whether or not frozen modules should be used.\n\
             The default is \"on\" (or \"off\" if you are running a local build).\n\
+         -X specialization_stats: collect statistics about the specializing \n\
+            interpreter and print them to stderr at exit\n\
 \n\
 --check-hash-based-pycs always|default|never:\n\
     control how Python invalidates hash-based .pyc files\n\
@@ -145,7 +147,9 @@ static const char usage_6[] =
 "   tables mapping extra location information (end line, start column offset \n"
 "   and end column offset) to every instruction in code objects. This is useful \n"
 "   when smaller cothe de objects and pyc files are desired as well as suppressing the \n"
-"   extra visual location indicators when the interpreter displays tracebacks.\n";
+"   extra visual location indicators when the interpreter displays tracebacks.\n"
+"PYTHONSPECIALIZATIONSTATS: collect statistics about the specializing interpreter\n"
+"   and print them to stderr at exit.\n";
 
 #if defined(MS_WINDOWS)
 #  define PYTHONHOMEHELP "<prefix>\\python{major}{minor}"
@@ -615,6 +619,7 @@ config_check_consistency(const PyConfig *config)
     assert(config->tracemalloc >= 0);
     assert(config->import_time >= 0);
     assert(config->no_debug_ranges >= 0);
+    assert(config->specialization_stats >= 0);
     assert(config->show_ref_count >= 0);
     assert(config->dump_refs >= 0);
     assert(config->malloc_stats >= 0);
@@ -905,6 +910,7 @@ _PyConfig_Copy(PyConfig *config, const PyConfig *config2)
     COPY_ATTR(tracemalloc);
     COPY_ATTR(import_time);
     COPY_ATTR(no_debug_ranges);
+    COPY_ATTR(specialization_stats);
     COPY_ATTR(show_ref_count);
     COPY_ATTR(dump_refs);
     COPY_ATTR(dump_refs_file);
@@ -1013,6 +1019,7 @@ _PyConfig_AsDict(const PyConfig *config)
     SET_ITEM_INT(tracemalloc);
     SET_ITEM_INT(import_time);
     SET_ITEM_INT(no_debug_ranges);
+    SET_ITEM_INT(specialization_stats);
     SET_ITEM_INT(show_ref_count);
     SET_ITEM_INT(dump_refs);
     SET_ITEM_INT(malloc_stats);
@@ -1292,6 +1299,7 @@ _PyConfig_FromDict(PyConfig *config, PyObject *dict)
     GET_UINT(tracemalloc);
     GET_UINT(import_time);
     GET_UINT(no_debug_ranges);
+    GET_UINT(specialization_stats);
     GET_UINT(show_ref_count);
     GET_UINT(dump_refs);
     GET_UINT(malloc_stats);
@@ -1867,6 +1875,11 @@ config_read_complex_options(PyConfig *config)
         config->no_debug_ranges = 1;
     }
 
+    if (config_get_env(config, "PYTHONSPECIALIZATIONSTATS")
+       || config_get_xoption(config, L"specialization_stats")) {
+        config->specialization_stats = 1;
+    }
+
     PyStatus status;
     if (config->tracemalloc < 0) {
         status = config_init_tracemalloc(config);
@@ -2203,6 +2216,7 @@ const wchar_t* known_xoptions[] = {
     L"warn_default_encoding",
     L"no_debug_ranges",
     L"frozen_modules",
+    L"specialization_stats",
     NULL,
 };
 
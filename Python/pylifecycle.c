@@ -3,6 +3,7 @@
 #include "Python.h"
 
 #include "pycore_ceval.h"         // _PyEval_FiniGIL()
+#include "pycore_code.h"          // _Py_SpecializationStatsEnabled
 #include "pycore_context.h"       // _PyContext_Init()
 #include "pycore_fileutils.h"     // _Py_ResetForceASCII()
 #include "pycore_import.h"        // _PyImport_BootstrapImp()
@@ -1180,6 +1181,8 @@ init_interp_main(PyThreadState *tstate)
         if (_PyTraceMalloc_Init(config->tracemalloc) < 0) {
             return _PyStatus_ERR("can't initialize tracemalloc");
         }
+
+        _Py_SpecializationStatsEnabled = config->specialization_stats;
     }
 
     // 初始化创建 `sys` 模块的 stdin/stdout/stderr  对象
@@ -1230,7 +1233,7 @@ init_interp_main(PyThreadState *tstate)
 
     if (is_main_interp) {
 #ifndef MS_WINDOWS
-        emit_stderr_warning_for_legacy_locale(interp->runtime);-
+        emit_stderr_warning_for_legacy_locale(interp->runtime);
 #endif
     }
 
@@ -1807,7 +1810,11 @@ finalize_interp_delete(PyInterpreterState *interp)
        fail when it is being awaited by another running daemon thread (see
        bpo-9901). Instead pycore_create_interpreter() destroys the previously
        created GIL, which ensures that Py_Initialize / Py_FinalizeEx can be
-       called multiple times. */
+       called multiple times.  Isolated subinterpreters, which can't run
+       threads, destroy their own GIL, if they have one, right away. */
+    if (!_Py_IsMainInterpreter(interp)) {
+        _PyEval_FiniGIL(interp);
+    }
 
     PyInterpreterState_Delete(interp);
 }
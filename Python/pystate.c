@@ -321,6 +321,7 @@ interpreter_clear(PyInterpreterState *interp, PyThreadState *tstate)
     _PyAST_Fini(interp);
     _PyWarnings_Fini(interp);
     _PyAtExit_Fini(interp);
+    _PyEval_FiniDXPSampling(interp);
 
     // All Python types must be destroyed before the last GC collection. Python
     // types create a reference cycle to themselves in their in their
@@ -695,6 +696,10 @@ new_threadstate(PyInterpreterState *interp, int init)
     /* Mark trace_info as uninitialized */
     tstate->trace_info.code = NULL;
 
+    tstate->gil_wait_time = 0;
+    tstate->gil_hold_time = 0;
+    tstate->gil_forced_drops = 0;
+
     if (init) {
         _PyThreadState_Init(tstate);
     }
@@ -1094,6 +1099,40 @@ PyThreadState_Swap(PyThreadState *newts)
     return _PyThreadState_Swap(&_PyRuntime.gilstate, newts);
 }
 
+/* Make tstate, a thread state of another interpreter, the current thread
+   state and return the previous one, which must not be NULL.  If the two
+   interpreters don't share their GIL, release the GIL of the current
+   interpreter and take the one of the other interpreter: *switch_gil is
+   then set to 1.  Switch back with _PyThreadState_SwapBack(). */
+PyThreadState *
+_PyThreadState_SwapInterpreter(PyThreadState *tstate, int *switch_gil)
+{
+    PyThreadState *save_tstate = _PyThreadState_GET();
+    assert(save_tstate != NULL);
+    *switch_gil = (tstate->interp->ceval.gil != save_tstate->interp->ceval.gil);
+    if (!*switch_gil) {
+        return _PyThreadState_Swap(&_PyRuntime.gilstate, tstate);
+    }
+    PyEval_SaveThread();
+    PyEval_RestoreThread(tstate);
+    return save_tstate;
+}
+
+void
+_PyThreadState_SwapBack(PyThreadState *save_tstate, int switch_gil)
+{
+    if (!switch_gil) {
+        _PyThreadState_Swap(&_PyRuntime.gilstate, save_tstate);
+        return;
+    }
+    /* There is no current thread state if Py_EndInterpreter() deleted the
+       interpreter, and its GIL with it. */
+    if (_PyThreadState_GET() != NULL) {
+        PyEval_SaveThread();
+    }
+    PyEval_RestoreThread(save_tstate);
+}
+
 /* An extension mechanism to store arbitrary additional per-thread state.
    PyThreadState_GetDict() returns a dictionary that can be used to hold such
    state; the caller should pick a unique key and store its state there.  If
@@ -1416,7 +1455,14 @@ _PyGILState_SetTstate(PyThreadState *tstate)
     struct _gilstate_runtime_state *gilstate = &tstate->interp->runtime->gilstate;
 
     gilstate->autoInterpreterState = tstate->interp;
+#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
+    /* autoTSSkey also holds the current thread state, see
+       _PyThreadState_Swap() */
+    assert(PyThread_tss_get(&gilstate->autoTSSkey) == NULL
+           || PyThread_tss_get(&gilstate->autoTSSkey) == tstate);
+#else
     assert(PyThread_tss_get(&gilstate->autoTSSkey) == NULL);
+#endif
     assert(tstate->gilstate_counter == 0);
 
     _PyGILState_NoteThreadState(gilstate, tstate);
@@ -1740,18 +1786,19 @@ _call_in_interpreter(struct _gilstate_runtime_state *gilstate,
      * naive approach.
      */
     PyThreadState *save_tstate = NULL;
+    int switch_gil = 0;
     if (interp != _PyRuntimeGILState_GetThreadState(gilstate)->interp) {
         // XXX Using the "head" thread isn't strictly correct.
         PyThreadState *tstate = PyInterpreterState_ThreadHead(interp);
         // XXX Possible GILState issues?
-        save_tstate = _PyThreadState_Swap(gilstate, tstate);
+        save_tstate = _PyThreadState_SwapInterpreter(tstate, &switch_gil);
     }
 
     func(arg);
 
     // Switch back.
     if (save_tstate != NULL) {
-        _PyThreadState_Swap(gilstate, save_tstate);
+        _PyThreadState_SwapBack(save_tstate, switch_gil);
     }
 }
 
@@ -1,9 +1,11 @@
 #include "Python.h"
 #include "pycore_code.h"
+#include "pycore_descrobject.h"   // propertyobject
 #include "pycore_dict.h"
 #include "pycore_long.h"
 #include "pycore_moduleobject.h"
 #include "pycore_object.h"
+#include "pycore_pystate.h"        // _PyInterpreterState_GET()
 #include "opcode.h"
 #include "structmember.h"         // struct PyMemberDef, T_OFFSET_EX
 
@@ -39,9 +41,110 @@
 */
 
 Py_ssize_t _Py_QuickenedCount = 0;
-#if COLLECT_SPECIALIZATION_STATS
+int _Py_SpecializationStatsEnabled = 0;
 SpecializationStats _specialization_stats[256] = { 0 };
 
+/* Code objects that have had specialization misses since the stats were
+ * last cleared, each holding a strong reference. A code object is added
+ * when its miss_count goes from zero to one, so it appears only once.
+ * Only the main interpreter records, reads or clears them: the references
+ * belong to its objects and are released during its finalization. */
+static PyCodeObject **miss_codes = NULL;
+static Py_ssize_t miss_codes_len = 0;
+static Py_ssize_t miss_codes_alloc = 0;
+
+void
+_Py_RecordSpecializationMiss(PyCodeObject *code)
+{
+    assert(code->co_quickened != NULL);
+    _PyEntryZero *zero = &code->co_quickened[0].entry.zero;
+    if (zero->miss_count == UINT32_MAX) {
+        return;
+    }
+    if (zero->miss_count++ != 0) {
+        return;
+    }
+    if (!_Py_IsMainInterpreter(_PyInterpreterState_GET())) {
+        return;
+    }
+    if (miss_codes_len == miss_codes_alloc) {
+        Py_ssize_t alloc = miss_codes_alloc ? miss_codes_alloc * 2 : 64;
+        PyCodeObject **codes = PyMem_RawRealloc(miss_codes,
+                                                alloc * sizeof(PyCodeObject *));
+        if (codes == NULL) {
+            /* The code object is just not reported */
+            return;
+        }
+        miss_codes = codes;
+        miss_codes_alloc = alloc;
+    }
+    Py_INCREF(code);
+    miss_codes[miss_codes_len++] = code;
+}
+
+static uint32_t
+code_miss_count(PyCodeObject *code)
+{
+    return code->co_quickened[0].entry.zero.miss_count;
+}
+
+static int
+compare_miss_count(const void *a, const void *b)
+{
+    uint32_t ma = code_miss_count(*(PyCodeObject **)a);
+    uint32_t mb = code_miss_count(*(PyCodeObject **)b);
+    return (ma < mb) - (ma > mb);
+}
+
+void
+_Py_ClearSpecializationStats(void)
+{
+    memset(_specialization_stats, 0, sizeof(_specialization_stats));
+    if (!_Py_IsMainInterpreter(_PyInterpreterState_GET())) {
+        return;
+    }
+    PyCodeObject **codes = miss_codes;
+    Py_ssize_t len = miss_codes_len;
+    miss_codes = NULL;
+    miss_codes_len = miss_codes_alloc = 0;
+    for (Py_ssize_t i = 0; i < len; i++) {
+        codes[i]->co_quickened[0].entry.zero.miss_count = 0;
+    }
+    for (Py_ssize_t i = 0; i < len; i++) {
+        Py_DECREF(codes[i]);
+    }
+    PyMem_RawFree(codes);
+}
+
+/* Return a list of (code, misses) pairs, most misses first. Other
+   interpreters get an empty list. */
+PyObject *
+_Py_GetSpecializationHotspots(void)
+{
+    if (!_Py_IsMainInterpreter(_PyInterpreterState_GET())) {
+        return PyList_New(0);
+    }
+    if (miss_codes_len > 1) {
+        qsort(miss_codes, miss_codes_len, sizeof(PyCodeObject *),
+              compare_miss_count);
+    }
+    PyObject *res = PyList_New(miss_codes_len);
+    if (res == NULL) {
+        return NULL;
+    }
+    for (Py_ssize_t i = 0; i < miss_codes_len; i++) {
+        PyCodeObject *code = miss_codes[i];
+        PyObject *item = Py_BuildValue("(Ok)", code,
+                                       (unsigned long)code_miss_count(code));
+        if (item == NULL) {
+            Py_DECREF(res);
+            return NULL;
+        }
+        PyList_SET_ITEM(res, i, item);
+    }
+    return res;
+}
+
 #define ADD_STAT_TO_DICT(res, field) \
     do { \
         PyObject *val = PyLong_FromUnsignedLongLong(stats->field); \
@@ -71,7 +174,6 @@ stats_to_dict(SpecializationStats *stats)
     ADD_STAT_TO_DICT(res, miss);
     ADD_STAT_TO_DICT(res, deopt);
     ADD_STAT_TO_DICT(res, unquickened);
-#if COLLECT_SPECIALIZATION_STATS_DETAILED
     PyObject *failure_kinds = PyTuple_New(SPECIALIZATION_FAILURE_KINDS);
     if (failure_kinds == NULL) {
         Py_DECREF(res);
@@ -92,7 +194,6 @@ stats_to_dict(SpecializationStats *stats)
         return NULL;
     }
     Py_DECREF(failure_kinds);
-#endif
     return res;
 }
 #undef ADD_STAT_TO_DICT
@@ -113,7 +214,6 @@ add_stat_dict(
     return err;
 }
 
-#if COLLECT_SPECIALIZATION_STATS
 PyObject*
 _Py_GetSpecializationStats(void) {
     PyObject *stats = PyDict_New();
@@ -128,14 +228,19 @@ _Py_GetSpecializationStats(void) {
     err += add_stat_dict(stats, STORE_SUBSCR, "store_subscr");
     err += add_stat_dict(stats, STORE_ATTR, "store_attr");
     err += add_stat_dict(stats, CALL_FUNCTION, "call_function");
+    err += add_stat_dict(stats, CALL_METHOD, "call_method");
+    err += add_stat_dict(stats, CALL_FUNCTION_KW, "call_function_kw");
+    err += add_stat_dict(stats, CALL_METHOD_KW, "call_method_kw");
     err += add_stat_dict(stats, BINARY_OP, "binary_op");
+    err += add_stat_dict(stats, COMPARE_OP, "compare_op");
+    err += add_stat_dict(stats, FOR_ITER, "for_iter");
+    err += add_stat_dict(stats, UNPACK_SEQUENCE, "unpack_sequence");
     if (err < 0) {
         Py_DECREF(stats);
         return NULL;
     }
     return stats;
 }
-#endif
 
 
 #define PRINT_STAT(name, field) fprintf(out, "    %s." #field " : %" PRIu64 "\n", name, stats->field);
@@ -150,15 +255,40 @@ print_stats(FILE *out, SpecializationStats *stats, const char *name)
     PRINT_STAT(name, miss);
     PRINT_STAT(name, deopt);
     PRINT_STAT(name, unquickened);
-#if PRINT_SPECIALIZATION_STATS_DETAILED
     for (int i = 0; i < SPECIALIZATION_FAILURE_KINDS; i++) {
+        if (stats->specialization_failure_kinds[i] == 0) {
+            continue;
+        }
         fprintf(out, "    %s.specialization_failure_kinds[%d] : %" PRIu64 "\n",
             name, i, stats->specialization_failure_kinds[i]);
     }
-#endif
 }
 #undef PRINT_STAT
 
+/* Maximum number of code objects listed by _Py_PrintSpecializationStats() */
+#define PRINT_HOTSPOTS 20
+
+static void
+print_hotspots(FILE *out)
+{
+    if (miss_codes_len > 1) {
+        qsort(miss_codes, miss_codes_len, sizeof(PyCodeObject *),
+              compare_miss_count);
+    }
+    for (Py_ssize_t i = 0; i < miss_codes_len && i < PRINT_HOTSPOTS; i++) {
+        PyCodeObject *code = miss_codes[i];
+        const char *qualname = PyUnicode_AsUTF8(code->co_qualname);
+        const char *filename = qualname ? PyUnicode_AsUTF8(code->co_filename) : NULL;
+        if (filename == NULL) {
+            PyErr_Clear();
+            continue;
+        }
+        fprintf(out, "    hotspot : %" PRIu32 " %s (%s:%d)\n",
+                code_miss_count(code), qualname, filename,
+                code->co_firstlineno);
+    }
+}
+
 void
 _Py_PrintSpecializationStats(void)
 {
@@ -186,23 +316,25 @@ _Py_PrintSpecializationStats(void)
     print_stats(out, &_specialization_stats[STORE_SUBSCR], "store_subscr");
     print_stats(out, &_specialization_stats[STORE_ATTR], "store_attr");
     print_stats(out, &_specialization_stats[CALL_FUNCTION], "call_function");
+    print_stats(out, &_specialization_stats[CALL_METHOD], "call_method");
+    print_stats(out, &_specialization_stats[CALL_FUNCTION_KW], "call_function_kw");
+    print_stats(out, &_specialization_stats[CALL_METHOD_KW], "call_method_kw");
     print_stats(out, &_specialization_stats[BINARY_OP], "binary_op");
+    print_stats(out, &_specialization_stats[COMPARE_OP], "compare_op");
+    print_stats(out, &_specialization_stats[FOR_ITER], "for_iter");
+    print_stats(out, &_specialization_stats[UNPACK_SEQUENCE], "unpack_sequence");
+    print_hotspots(out);
     if (out != stderr) {
         fclose(out);
     }
 }
 
-#if COLLECT_SPECIALIZATION_STATS_DETAILED
-
-#define SPECIALIZATION_FAIL(opcode, kind) _specialization_stats[opcode].specialization_failure_kinds[kind]++
-
-
-#endif
-#endif
-
-#ifndef SPECIALIZATION_FAIL
-#define SPECIALIZATION_FAIL(opcode, kind) ((void)0)
-#endif
+#define SPECIALIZATION_FAIL(opcode, kind) \
+    do { \
+        if (_Py_SpecializationStatsEnabled) { \
+            _specialization_stats[opcode].specialization_failure_kinds[kind]++; \
+        } \
+    } while (0)
 
 static SpecializedCacheOrInstruction *
 allocate(int cache_count, int instruction_count)
@@ -220,6 +352,7 @@ allocate(int cache_count, int instruction_count)
     }
     _Py_QuickenedCount++;
     array[0].entry.zero.cache_count = cache_count;
+    array[0].entry.zero.miss_count = 0;
     return array;
 }
 
@@ -237,20 +370,32 @@ static uint8_t adaptive_opcodes[256] = {
     [BINARY_SUBSCR] = BINARY_SUBSCR_ADAPTIVE,
     [STORE_SUBSCR] = STORE_SUBSCR_ADAPTIVE,
     [CALL_FUNCTION] = CALL_FUNCTION_ADAPTIVE,
+    [CALL_METHOD] = CALL_METHOD_ADAPTIVE,
+    [CALL_FUNCTION_KW] = CALL_FUNCTION_KW_ADAPTIVE,
+    [CALL_METHOD_KW] = CALL_METHOD_KW_ADAPTIVE,
     [STORE_ATTR] = STORE_ATTR_ADAPTIVE,
     [BINARY_OP] = BINARY_OP_ADAPTIVE,
+    [COMPARE_OP] = COMPARE_OP_ADAPTIVE,
+    [FOR_ITER] = FOR_ITER_ADAPTIVE,
+    [UNPACK_SEQUENCE] = UNPACK_SEQUENCE_ADAPTIVE,
 };
 
 /* The number of cache entries required for a "family" of instructions. */
 static uint8_t cache_requirements[256] = {
-    [LOAD_ATTR] = 2, /* _PyAdaptiveEntry and _PyAttrCache */
+    [LOAD_ATTR] = 3, /* _PyAdaptiveEntry, _PyAttrCache and _PyObjectCache */
     [LOAD_GLOBAL] = 2, /* _PyAdaptiveEntry and _PyLoadGlobalCache */
     [LOAD_METHOD] = 3, /* _PyAdaptiveEntry, _PyAttrCache and _PyObjectCache */
     [BINARY_SUBSCR] = 2, /* _PyAdaptiveEntry, _PyObjectCache */
     [STORE_SUBSCR] = 0,
     [CALL_FUNCTION] = 2, /* _PyAdaptiveEntry and _PyObjectCache/_PyCallCache */
+    [CALL_METHOD] = 1, /* _PyAdaptiveEntry */
+    [CALL_FUNCTION_KW] = 3, /* _PyAdaptiveEntry, _PyObjectCache and _PyKwCallCache */
+    [CALL_METHOD_KW] = 3, /* _PyAdaptiveEntry, _PyObjectCache and _PyKwCallCache */
     [STORE_ATTR] = 2, /* _PyAdaptiveEntry and _PyAttrCache */
     [BINARY_OP] = 1,  // _PyAdaptiveEntry
+    [COMPARE_OP] = 1, /* _PyAdaptiveEntry */
+    [FOR_ITER] = 1, /* _PyAdaptiveEntry */
+    [UNPACK_SEQUENCE] = 1, /* _PyAdaptiveEntry */
 };
 
 /* Return the oparg for the cache_offset and instruction index.
@@ -447,6 +592,8 @@ initial_counter_value(void) {
 #define SPEC_FAIL_NON_OBJECT_SLOT 14
 #define SPEC_FAIL_READ_ONLY 15
 #define SPEC_FAIL_AUDITED_SLOT 16
+#define SPEC_FAIL_METACLASS_ATTRIBUTE 17
+#define SPEC_FAIL_CLASS_ATTR_DESCRIPTOR 18
 
 /* Methods */
 
@@ -487,6 +634,34 @@ initial_counter_value(void) {
 #define SPEC_FAIL_BAD_CALL_FLAGS 17
 #define SPEC_FAIL_CLASS 18
 
+/* CALL_METHOD */
+#define SPEC_FAIL_NOT_METHOD 19
+
+/* CALL_FUNCTION_KW and CALL_METHOD_KW */
+#define SPEC_FAIL_KW_UNKNOWN_KEYWORD 12
+#define SPEC_FAIL_KW_MISSING_ARGUMENT 19
+
+/* COMPARE_OP */
+#define SPEC_FAIL_STRING_COMPARE 13
+#define SPEC_FAIL_NOT_FOLLOWED_BY_COND_JUMP 14
+#define SPEC_FAIL_BIG_INT 15
+#define SPEC_FAIL_COMPARE_DIFFERENT_TYPES 16
+#define SPEC_FAIL_COMPARE_OP_FLOAT_LONG 17
+#define SPEC_FAIL_COMPARE_OP_LONG_FLOAT 18
+
+/* FOR_ITER */
+#define SPEC_FAIL_FOR_ITER_GENERATOR 10
+#define SPEC_FAIL_FOR_ITER_SET 11
+#define SPEC_FAIL_FOR_ITER_DICT_KEYS 12
+#define SPEC_FAIL_FOR_ITER_DICT_VALUES 13
+#define SPEC_FAIL_FOR_ITER_DICT_ITEMS 14
+#define SPEC_FAIL_FOR_ITER_RANGE 15
+#define SPEC_FAIL_FOR_ITER_ENUMERATE 16
+
+/* UNPACK_SEQUENCE */
+#define SPEC_FAIL_UNPACK_SEQUENCE_ITERATOR 8
+#define SPEC_FAIL_UNPACK_SEQUENCE_SEQUENCE 9
+
 
 static int
 specialize_module_load_attr(
@@ -688,11 +863,117 @@ specialize_dict_access(
     }
 }
 
+#define SIMPLE_FUNCTION 0
+
+static int
+function_kind(PyCodeObject *code) {
+    int flags = code->co_flags;
+    if (flags & (CO_GENERATOR | CO_COROUTINE | CO_ASYNC_GENERATOR)) {
+        return SPEC_FAIL_GENERATOR;
+    }
+    if ((flags & (CO_VARKEYWORDS | CO_VARARGS)) || code->co_kwonlyargcount) {
+        return SPEC_FAIL_COMPLEX_PARAMETERS;
+    }
+    if ((flags & CO_OPTIMIZED) == 0) {
+        return SPEC_FAIL_CO_NOT_OPTIMIZED;
+    }
+    return SIMPLE_FUNCTION;
+}
+
+/* Specialize loading a property whose getter is a simple Python function.
+ * The getter is called inline, by pushing a frame for it.
+ * The property is kept alive by the type for as long as the type version is
+ * unchanged, but property.__init__() can replace its getter: the cache holds
+ * the property, and the getter is checked against the function version. */
+static int
+specialize_property_load_attr(PyTypeObject *type, PyObject *descr,
+                              _Py_CODEUNIT *instr, _PyAdaptiveEntry *cache0,
+                              _PyAttrCache *cache1, _PyObjectCache *cache2)
+{
+    assert(Py_IS_TYPE(descr, &PyProperty_Type));
+    PyObject *fget = ((propertyobject *)descr)->prop_get;
+    if (fget == NULL || !PyFunction_Check(fget)) {
+        SPECIALIZATION_FAIL(LOAD_ATTR, SPEC_FAIL_PROPERTY);
+        return 0;
+    }
+    PyFunctionObject *func = (PyFunctionObject *)fget;
+    PyCodeObject *code = (PyCodeObject *)func->func_code;
+    if (function_kind(code) != SIMPLE_FUNCTION || code->co_argcount != 1) {
+        SPECIALIZATION_FAIL(LOAD_ATTR, SPEC_FAIL_PROPERTY);
+        return 0;
+    }
+    if ((type->tp_flags & Py_TPFLAGS_VALID_VERSION_TAG) == 0) {
+        SPECIALIZATION_FAIL(LOAD_ATTR, SPEC_FAIL_OUT_OF_VERSIONS);
+        return 0;
+    }
+    uint32_t version = _PyFunction_GetVersionForCurrentState(func);
+    if (version == 0) {
+        SPECIALIZATION_FAIL(LOAD_ATTR, SPEC_FAIL_OUT_OF_VERSIONS);
+        return 0;
+    }
+    cache0->version = version;
+    cache1->tp_version = type->tp_version_tag;
+    cache2->obj = descr;
+    *instr = _Py_MAKECODEUNIT(LOAD_ATTR_PROPERTY, _Py_OPARG(*instr));
+    return 1;
+}
+
+/* Specialize loading an attribute of a class, such as a constant or a
+ * function defined in the class body. The class version guards the class
+ * and its bases; the metaclass version guards against the attribute being
+ * shadowed by a descriptor defined on the metaclass. */
+static int
+specialize_class_load_attr(PyObject *owner, _Py_CODEUNIT *instr,
+                           PyObject *name, _PyAdaptiveEntry *cache0,
+                           _PyAttrCache *cache1, _PyObjectCache *cache2)
+{
+    PyTypeObject *cls = (PyTypeObject *)owner;
+    PyTypeObject *metaclass = Py_TYPE(owner);
+    if (metaclass->tp_getattro != PyType_Type.tp_getattro) {
+        SPECIALIZATION_FAIL(LOAD_ATTR, SPEC_FAIL_OVERRIDDEN);
+        return -1;
+    }
+    if (_PyType_Lookup(metaclass, name) != NULL) {
+        SPECIALIZATION_FAIL(LOAD_ATTR, SPEC_FAIL_METACLASS_ATTRIBUTE);
+        return -1;
+    }
+    PyObject *descr = _PyType_Lookup(cls, name);
+    if (descr == NULL) {
+        SPECIALIZATION_FAIL(LOAD_ATTR, SPEC_FAIL_EXPECTED_ERROR);
+        return -1;
+    }
+    PyTypeObject *desc_cls = Py_TYPE(descr);
+    if (!(desc_cls->tp_flags & Py_TPFLAGS_IMMUTABLETYPE)) {
+        SPECIALIZATION_FAIL(LOAD_ATTR, SPEC_FAIL_MUTABLE_CLASS);
+        return -1;
+    }
+    /* Functions and method descriptors return themselves when
+       looked up on a class */
+    if (desc_cls->tp_descr_get != NULL &&
+        desc_cls != &PyFunction_Type && desc_cls != &PyMethodDescr_Type)
+    {
+        SPECIALIZATION_FAIL(LOAD_ATTR, SPEC_FAIL_CLASS_ATTR_DESCRIPTOR);
+        return -1;
+    }
+    if ((cls->tp_flags & Py_TPFLAGS_VALID_VERSION_TAG) == 0 ||
+        (metaclass->tp_flags & Py_TPFLAGS_VALID_VERSION_TAG) == 0)
+    {
+        SPECIALIZATION_FAIL(LOAD_ATTR, SPEC_FAIL_OUT_OF_VERSIONS);
+        return -1;
+    }
+    cache0->version = metaclass->tp_version_tag;
+    cache1->tp_version = cls->tp_version_tag;
+    cache2->obj = descr;
+    *instr = _Py_MAKECODEUNIT(LOAD_ATTR_CLASS, _Py_OPARG(*instr));
+    return 0;
+}
+
 int
 _Py_Specialize_LoadAttr(PyObject *owner, _Py_CODEUNIT *instr, PyObject *name, SpecializedCacheEntry *cache)
 {
     _PyAdaptiveEntry *cache0 = &cache->adaptive;
     _PyAttrCache *cache1 = &cache[-1].attr;
+    _PyObjectCache *cache2 = &cache[-2].obj;
     if (PyModule_CheckExact(owner)) {
         int err = specialize_module_load_attr(owner, instr, name, cache0, cache1,
             LOAD_ATTR, LOAD_ATTR_MODULE);
@@ -701,6 +982,13 @@ _Py_Specialize_LoadAttr(PyObject *owner, _Py_CODEUNIT *instr, PyObject *name, Sp
         }
         goto success;
     }
+    if (PyType_Check(owner)) {
+        if (specialize_class_load_attr(owner, instr, name,
+                                       cache0, cache1, cache2)) {
+            goto fail;
+        }
+        goto success;
+    }
     PyTypeObject *type = Py_TYPE(owner);
     if (type->tp_dict == NULL) {
         if (PyType_Ready(type) < 0) {
@@ -717,8 +1005,13 @@ _Py_Specialize_LoadAttr(PyObject *owner, _Py_CODEUNIT *instr, PyObject *name, Sp
             SPECIALIZATION_FAIL(LOAD_ATTR, SPEC_FAIL_METHOD);
             goto fail;
         case PROPERTY:
-            SPECIALIZATION_FAIL(LOAD_ATTR, SPEC_FAIL_PROPERTY);
+        {
+            if (specialize_property_load_attr(type, descr, instr,
+                                              cache0, cache1, cache2)) {
+                goto success;
+            }
             goto fail;
+        }
         case OBJECT_SLOT:
         {
             PyMemberDescrObject *member = (PyMemberDescrObject *)descr;
@@ -869,7 +1162,6 @@ _Py_Specialize_StoreAttr(PyObject *owner, _Py_CODEUNIT *instr, PyObject *name, S
 }
 
 
-#if COLLECT_SPECIALIZATION_STATS_DETAILED
 static int
 load_method_fail_kind(DesciptorClassification kind)
 {
@@ -903,7 +1195,6 @@ load_method_fail_kind(DesciptorClassification kind)
     }
     Py_UNREACHABLE();
 }
-#endif
 
 static int
 specialize_class_load_method(PyObject *owner, _Py_CODEUNIT *instr, PyObject *name,
@@ -1102,7 +1393,6 @@ _Py_Specialize_LoadGlobal(
     return 0;
 }
 
-#if COLLECT_SPECIALIZATION_STATS_DETAILED
 static int
 binary_subscr_fail_kind(PyTypeObject *container_type, PyObject *sub)
 {
@@ -1140,27 +1430,9 @@ binary_subscr_fail_kind(PyTypeObject *container_type, PyObject *sub)
     }
     return SPEC_FAIL_OTHER;
 }
-#endif
 
 _Py_IDENTIFIER(__getitem__);
 
-#define SIMPLE_FUNCTION 0
-
-static int
-function_kind(PyCodeObject *code) {
-    int flags = code->co_flags;
-    if (flags & (CO_GENERATOR | CO_COROUTINE | CO_ASYNC_GENERATOR)) {
-        return SPEC_FAIL_GENERATOR;
-    }
-    if ((flags & (CO_VARKEYWORDS | CO_VARARGS)) || code->co_kwonlyargcount) {
-        return SPEC_FAIL_COMPLEX_PARAMETERS;
-    }
-    if ((flags & CO_OPTIMIZED) == 0) {
-        return SPEC_FAIL_CO_NOT_OPTIMIZED;
-    }
-    return SIMPLE_FUNCTION;
-}
-
 int
 _Py_Specialize_BinarySubscr(
      PyObject *container, PyObject *sub, _Py_CODEUNIT *instr, SpecializedCacheEntry *cache)
@@ -1326,7 +1598,6 @@ specialize_py_call(
     return 0;
 }
 
-#if COLLECT_SPECIALIZATION_STATS_DETAILED
 static int
 builtin_call_fail_kind(int ml_flags)
 {
@@ -1348,7 +1619,6 @@ builtin_call_fail_kind(int ml_flags)
             return SPEC_FAIL_BAD_CALL_FLAGS;
     }
 }
-#endif
 
 static int
 specialize_c_call(PyObject *callable, _Py_CODEUNIT *instr, int nargs,
@@ -1401,7 +1671,6 @@ specialize_c_call(PyObject *callable, _Py_CODEUNIT *instr, int nargs,
     }
 }
 
-#if COLLECT_SPECIALIZATION_STATS_DETAILED
 static int
 call_fail_kind(PyObject *callable)
 {
@@ -1420,7 +1689,6 @@ call_fail_kind(PyObject *callable)
     }
     return SPEC_FAIL_OTHER;
 }
-#endif
 
 /* TODO:
     - Specialize calling classes.
@@ -1459,6 +1727,257 @@ _Py_Specialize_CallFunction(
     return 0;
 }
 
+/* meth is NULL if LOAD_METHOD did not find a method, in which case the
+ * call is an ordinary function call and is left to the generic path. */
+int
+_Py_Specialize_CallMethod(
+    PyObject *meth, _Py_CODEUNIT *instr,
+    int nargs, SpecializedCacheEntry *cache)
+{
+    _PyAdaptiveEntry *cache0 = &cache->adaptive;
+    if (meth == NULL) {
+        SPECIALIZATION_FAIL(CALL_METHOD, SPEC_FAIL_NOT_METHOD);
+        goto fail;
+    }
+    if (!PyFunction_Check(meth)) {
+        SPECIALIZATION_FAIL(CALL_METHOD, call_fail_kind(meth));
+        goto fail;
+    }
+    PyFunctionObject *func = (PyFunctionObject *)meth;
+    PyCodeObject *code = (PyCodeObject *)func->func_code;
+    int kind = function_kind(code);
+    if (kind != SIMPLE_FUNCTION) {
+        SPECIALIZATION_FAIL(CALL_METHOD, kind);
+        goto fail;
+    }
+    /* self is passed as the first argument */
+    if (code->co_argcount != nargs + 1) {
+        SPECIALIZATION_FAIL(CALL_METHOD, SPEC_FAIL_WRONG_NUMBER_ARGUMENTS);
+        goto fail;
+    }
+    int version = _PyFunction_GetVersionForCurrentState(func);
+    if (version == 0) {
+        SPECIALIZATION_FAIL(CALL_METHOD, SPEC_FAIL_OUT_OF_VERSIONS);
+        goto fail;
+    }
+    cache0->version = version;
+    *instr = _Py_MAKECODEUNIT(CALL_METHOD_PY_EXACT_ARGS, _Py_OPARG(*instr));
+    STAT_INC(CALL_METHOD, specialization_success);
+    assert(!PyErr_Occurred());
+    cache0->counter = initial_counter_value();
+    return 0;
+fail:
+    STAT_INC(CALL_METHOD, specialization_failure);
+    assert(!PyErr_Occurred());
+    cache_backoff(cache0);
+    return 0;
+}
+
+/* The kwnames tuple is cached as a borrowed reference, so only accept it
+ * if it is one of the code object's constants (which is always the case
+ * for compiler generated code) and will thus outlive the cache. */
+static int
+kwnames_is_constant(PyObject *kwnames, PyObject *consts)
+{
+    Py_ssize_t n = PyTuple_GET_SIZE(consts);
+    for (Py_ssize_t i = 0; i < n; i++) {
+        if (PyTuple_GET_ITEM(consts, i) == kwnames) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Resolve each keyword in kwnames to the index of the parameter it binds,
+ * so that the specialized instruction can store the arguments straight into
+ * the new frame. nargs is the number of positional arguments, including
+ * self for method calls. */
+static int
+specialize_py_kwcall(
+    PyFunctionObject *func, PyObject *kwnames, int nargs,
+    SpecializedCacheEntry *cache, PyObject *consts, int base_op)
+{
+    PyCodeObject *code = (PyCodeObject *)func->func_code;
+    int flags = code->co_flags;
+    if (flags & (CO_GENERATOR | CO_COROUTINE | CO_ASYNC_GENERATOR)) {
+        SPECIALIZATION_FAIL(base_op, SPEC_FAIL_GENERATOR);
+        return -1;
+    }
+    if (flags & (CO_VARKEYWORDS | CO_VARARGS)) {
+        SPECIALIZATION_FAIL(base_op, SPEC_FAIL_COMPLEX_PARAMETERS);
+        return -1;
+    }
+    if ((flags & CO_OPTIMIZED) == 0) {
+        SPECIALIZATION_FAIL(base_op, SPEC_FAIL_CO_NOT_OPTIMIZED);
+        return -1;
+    }
+    if (!kwnames_is_constant(kwnames, consts)) {
+        SPECIALIZATION_FAIL(base_op, SPEC_FAIL_OTHER);
+        return -1;
+    }
+    int kwcount = (int)PyTuple_GET_SIZE(kwnames);
+    int argcount = code->co_argcount;
+    int total_args = argcount + code->co_kwonlyargcount;
+    if (kwcount > KWCALL_MAX_KEYWORDS || total_args > 256) {
+        SPECIALIZATION_FAIL(base_op, SPEC_FAIL_OUT_OF_RANGE);
+        return -1;
+    }
+    if (nargs > argcount) {
+        SPECIALIZATION_FAIL(base_op, SPEC_FAIL_WRONG_NUMBER_ARGUMENTS);
+        return -1;
+    }
+    _PyKwCallCache *cache2 = &cache[-2].kwcall;
+    PyObject **varnames = &PyTuple_GET_ITEM(code->co_localsplusnames, 0);
+    char bound[256] = {0};
+    for (int i = 0; i < kwcount; i++) {
+        PyObject *keyword = PyTuple_GET_ITEM(kwnames, i);
+        /* Keywords and parameter names are interned, so a pointer
+           comparison is enough; anything else takes the generic path. */
+        int slot = -1;
+        for (int j = code->co_posonlyargcount; j < total_args; j++) {
+            if (varnames[j] == keyword) {
+                slot = j;
+                break;
+            }
+        }
+        if (slot < nargs || bound[slot]) {
+            SPECIALIZATION_FAIL(base_op, SPEC_FAIL_KW_UNKNOWN_KEYWORD);
+            return -1;
+        }
+        bound[slot] = 1;
+        cache2->slots[i] = (uint8_t)slot;
+    }
+    /* Every parameter left unbound must have a default. The positional
+       defaults are covered by the function version; __kwdefaults__ is
+       mutable and is looked up again on each call. */
+    int defcount = func->func_defaults == NULL ? 0 : (int)PyTuple_GET_SIZE(func->func_defaults);
+    for (int j = nargs; j < argcount - defcount; j++) {
+        if (!bound[j]) {
+            SPECIALIZATION_FAIL(base_op, SPEC_FAIL_KW_MISSING_ARGUMENT);
+            return -1;
+        }
+    }
+    for (int j = argcount; j < total_args; j++) {
+        if (!bound[j] && (func->func_kwdefaults == NULL ||
+            PyDict_GetItem(func->func_kwdefaults, varnames[j]) == NULL))
+        {
+            SPECIALIZATION_FAIL(base_op, SPEC_FAIL_KW_MISSING_ARGUMENT);
+            return -1;
+        }
+    }
+    int version = _PyFunction_GetVersionForCurrentState(func);
+    if (version == 0) {
+        SPECIALIZATION_FAIL(base_op, SPEC_FAIL_OUT_OF_VERSIONS);
+        return -1;
+    }
+    cache[0].adaptive.version = version;
+    cache[-1].obj.obj = kwnames;  // borrowed
+    return 0;
+}
+
+static int
+specialize_c_kwcall(PyObject *callable, int base_op)
+{
+    int ml_flags;
+    if (PyCFunction_CheckExact(callable)) {
+        if (PyCFunction_GET_FUNCTION(callable) == NULL) {
+            return 1;
+        }
+        ml_flags = PyCFunction_GET_FLAGS(callable);
+    }
+    else {
+        assert(Py_IS_TYPE(callable, &PyMethodDescr_Type));
+        ml_flags = ((PyMethodDescrObject *)callable)->d_method->ml_flags;
+    }
+    if ((ml_flags & (METH_VARARGS | METH_FASTCALL | METH_NOARGS | METH_O |
+        METH_KEYWORDS | METH_METHOD)) != (METH_FASTCALL | METH_KEYWORDS))
+    {
+        SPECIALIZATION_FAIL(base_op, builtin_call_fail_kind(ml_flags));
+        return 1;
+    }
+    return 0;
+}
+
+static void
+kwcall_specialization_done(int fail, int base_op, SpecializedCacheEntry *cache)
+{
+    _PyAdaptiveEntry *cache0 = &cache->adaptive;
+    if (fail) {
+        STAT_INC(base_op, specialization_failure);
+        assert(!PyErr_Occurred());
+        cache_backoff(cache0);
+    }
+    else {
+        STAT_INC(base_op, specialization_success);
+        assert(!PyErr_Occurred());
+        cache0->counter = initial_counter_value();
+    }
+}
+
+int
+_Py_Specialize_CallFunctionKw(
+    PyObject *callable, PyObject *kwnames, _Py_CODEUNIT *instr,
+    int nargs, SpecializedCacheEntry *cache, PyObject *consts)
+{
+    int fail;
+    if (PyCFunction_CheckExact(callable)) {
+        fail = specialize_c_kwcall(callable, CALL_FUNCTION_KW);
+        if (!fail) {
+            *instr = _Py_MAKECODEUNIT(CALL_FUNCTION_KW_BUILTIN, _Py_OPARG(*instr));
+        }
+    }
+    else if (PyFunction_Check(callable)) {
+        fail = specialize_py_kwcall((PyFunctionObject *)callable, kwnames,
+                                    nargs, cache, consts, CALL_FUNCTION_KW);
+        if (!fail) {
+            *instr = _Py_MAKECODEUNIT(CALL_FUNCTION_KW_PY, _Py_OPARG(*instr));
+        }
+    }
+    else {
+        SPECIALIZATION_FAIL(CALL_FUNCTION_KW, call_fail_kind(callable));
+        fail = -1;
+    }
+    kwcall_specialization_done(fail, CALL_FUNCTION_KW, cache);
+    return 0;
+}
+
+/* meth is NULL if LOAD_METHOD did not find a method, in which case self is
+ * the callable itself. The cached index records which of the two layouts
+ * was specialized for. */
+int
+_Py_Specialize_CallMethodKw(
+    PyObject *meth, PyObject *self, PyObject *kwnames, _Py_CODEUNIT *instr,
+    int nargs, SpecializedCacheEntry *cache, PyObject *consts)
+{
+    int is_method = (meth != NULL);
+    PyObject *callable = is_method ? meth : self;
+    int fail;
+    if ((is_method && Py_IS_TYPE(callable, &PyMethodDescr_Type) &&
+         Py_IS_TYPE(self, PyDescr_TYPE(callable))) ||
+        (!is_method && PyCFunction_CheckExact(callable)))
+    {
+        fail = specialize_c_kwcall(callable, CALL_METHOD_KW);
+        if (!fail) {
+            *instr = _Py_MAKECODEUNIT(CALL_METHOD_KW_BUILTIN, _Py_OPARG(*instr));
+        }
+    }
+    else if (PyFunction_Check(callable)) {
+        fail = specialize_py_kwcall((PyFunctionObject *)callable, kwnames,
+                                    nargs + is_method, cache, consts,
+                                    CALL_METHOD_KW);
+        if (!fail) {
+            *instr = _Py_MAKECODEUNIT(CALL_METHOD_KW_PY, _Py_OPARG(*instr));
+        }
+    }
+    else {
+        SPECIALIZATION_FAIL(CALL_METHOD_KW, call_fail_kind(callable));
+        fail = -1;
+    }
+    cache->adaptive.index = is_method;
+    kwcall_specialization_done(fail, CALL_METHOD_KW, cache);
+    return 0;
+}
+
 void
 _Py_Specialize_BinaryOp(PyObject *lhs, PyObject *rhs, _Py_CODEUNIT *instr,
                         SpecializedCacheEntry *cache)
@@ -1536,3 +2055,217 @@ _Py_Specialize_BinaryOp(PyObject *lhs, PyObject *rhs, _Py_CODEUNIT *instr,
     STAT_INC(BINARY_OP, specialization_success);
     adaptive->counter = initial_counter_value();
 }
+
+static int
+compare_op_fail_kind(PyObject *lhs, PyObject *rhs)
+{
+    if (Py_TYPE(lhs) != Py_TYPE(rhs)) {
+        if (PyFloat_CheckExact(lhs) && PyLong_CheckExact(rhs)) {
+            return SPEC_FAIL_COMPARE_OP_FLOAT_LONG;
+        }
+        if (PyLong_CheckExact(lhs) && PyFloat_CheckExact(rhs)) {
+            return SPEC_FAIL_COMPARE_OP_LONG_FLOAT;
+        }
+        return SPEC_FAIL_COMPARE_DIFFERENT_TYPES;
+    }
+    return SPEC_FAIL_OTHER;
+}
+
+/* The specialized forms of COMPARE_OP consume the following
+ * POP_JUMP_IF_FALSE/POP_JUMP_IF_TRUE, so that the intermediate bool is
+ * never created. The outcome of the comparison is encoded as
+ * (1 << (sign + 1)), where sign is -1, 0 or 1, and tested against a mask
+ * of the outcomes for which the jump is taken.
+ */
+static int compare_masks[] = {
+    // 1-bit: jump if less than
+    // 2-bit: jump if equal
+    // 4-bit: jump if greater
+    [Py_LT] = 1 | 0 | 0,
+    [Py_LE] = 1 | 2 | 0,
+    [Py_EQ] = 0 | 2 | 0,
+    [Py_NE] = 1 | 0 | 4,
+    [Py_GT] = 0 | 0 | 4,
+    [Py_GE] = 0 | 2 | 4,
+};
+
+void
+_Py_Specialize_CompareOp(PyObject *lhs, PyObject *rhs,
+                         _Py_CODEUNIT *instr, SpecializedCacheEntry *cache)
+{
+    _PyAdaptiveEntry *adaptive = &cache->adaptive;
+    int op = adaptive->original_oparg;
+    int next_opcode = _Py_OPCODE(instr[1]);
+    if (next_opcode != POP_JUMP_IF_FALSE && next_opcode != POP_JUMP_IF_TRUE) {
+        // Can't ever combine, so don't bother being adaptive.
+        SPECIALIZATION_FAIL(COMPARE_OP, SPEC_FAIL_NOT_FOLLOWED_BY_COND_JUMP);
+        *instr = _Py_MAKECODEUNIT(COMPARE_OP, adaptive->original_oparg);
+        goto failure;
+    }
+    assert(op <= Py_GE);
+    int when_to_jump_mask = compare_masks[op];
+    if (next_opcode == POP_JUMP_IF_FALSE) {
+        when_to_jump_mask = (1 | 2 | 4) & ~when_to_jump_mask;
+    }
+    if (Py_TYPE(lhs) != Py_TYPE(rhs)) {
+        SPECIALIZATION_FAIL(COMPARE_OP, compare_op_fail_kind(lhs, rhs));
+        goto failure;
+    }
+    if (PyFloat_CheckExact(lhs)) {
+        *instr = _Py_MAKECODEUNIT(COMPARE_OP_FLOAT_JUMP, _Py_OPARG(*instr));
+        adaptive->index = when_to_jump_mask;
+        goto success;
+    }
+    if (PyLong_CheckExact(lhs)) {
+        if (Py_ABS(Py_SIZE(lhs)) <= 1 && Py_ABS(Py_SIZE(rhs)) <= 1) {
+            *instr = _Py_MAKECODEUNIT(COMPARE_OP_INT_JUMP, _Py_OPARG(*instr));
+            adaptive->index = when_to_jump_mask;
+            goto success;
+        }
+        SPECIALIZATION_FAIL(COMPARE_OP, SPEC_FAIL_BIG_INT);
+        goto failure;
+    }
+    if (PyUnicode_CheckExact(lhs)) {
+        if (op != Py_EQ && op != Py_NE) {
+            SPECIALIZATION_FAIL(COMPARE_OP, SPEC_FAIL_STRING_COMPARE);
+            goto failure;
+        }
+        *instr = _Py_MAKECODEUNIT(COMPARE_OP_STR_JUMP, _Py_OPARG(*instr));
+        // 1 if the jump is taken when the strings are not equal
+        adaptive->index = (when_to_jump_mask & 2) == 0;
+        goto success;
+    }
+    SPECIALIZATION_FAIL(COMPARE_OP, compare_op_fail_kind(lhs, rhs));
+failure:
+    STAT_INC(COMPARE_OP, specialization_failure);
+    cache_backoff(adaptive);
+    return;
+success:
+    STAT_INC(COMPARE_OP, specialization_success);
+    adaptive->counter = initial_counter_value();
+}
+
+static int
+for_iter_fail_kind(PyTypeObject *type)
+{
+    if (type == &PyGen_Type) {
+        return SPEC_FAIL_FOR_ITER_GENERATOR;
+    }
+    if (type == &PySetIter_Type) {
+        return SPEC_FAIL_FOR_ITER_SET;
+    }
+    if (type == &PyDictIterKey_Type) {
+        return SPEC_FAIL_FOR_ITER_DICT_KEYS;
+    }
+    if (type == &PyDictIterValue_Type) {
+        return SPEC_FAIL_FOR_ITER_DICT_VALUES;
+    }
+    if (type == &PyDictIterItem_Type) {
+        return SPEC_FAIL_FOR_ITER_DICT_ITEMS;
+    }
+    if (type == &PyRangeIter_Type) {
+        return SPEC_FAIL_FOR_ITER_RANGE;
+    }
+    if (type == &PyEnum_Type) {
+        return SPEC_FAIL_FOR_ITER_ENUMERATE;
+    }
+    return SPEC_FAIL_OTHER;
+}
+
+void
+_Py_Specialize_ForIter(PyObject *iter, _Py_CODEUNIT *instr,
+                       SpecializedCacheEntry *cache)
+{
+    _PyAdaptiveEntry *adaptive = &cache->adaptive;
+    PyTypeObject *tp = Py_TYPE(iter);
+    int next_opcode = _Py_OPCODE(instr[1]);
+    if (tp == &PyListIter_Type) {
+        *instr = _Py_MAKECODEUNIT(FOR_ITER_LIST, _Py_OPARG(*instr));
+        goto success;
+    }
+    if (tp == &PyTupleIter_Type) {
+        *instr = _Py_MAKECODEUNIT(FOR_ITER_TUPLE, _Py_OPARG(*instr));
+        goto success;
+    }
+    if (tp == &PyRangeIter_Type) {
+        /* FOR_ITER_RANGE stores the value directly into the loop variable,
+         * and skips the store. The superinstruction leaves the following
+         * LOAD_FAST in place, so it can be skipped just the same. */
+        if (next_opcode == STORE_FAST || next_opcode == STORE_FAST__LOAD_FAST) {
+            *instr = _Py_MAKECODEUNIT(FOR_ITER_RANGE, _Py_OPARG(*instr));
+            goto success;
+        }
+        SPECIALIZATION_FAIL(FOR_ITER, SPEC_FAIL_FOR_ITER_RANGE);
+        goto failure;
+    }
+    if (tp == &PyDictIterItem_Type) {
+        /* FOR_ITER_DICT_ITEMS pushes the key and value directly, in place
+         * of the following UNPACK_SEQUENCE, so no tuple is needed.
+         * Once quickened, the oparg of UNPACK_SEQUENCE is no longer the
+         * number of items, so wait until it has specialized for 2-tuples. */
+        if (next_opcode == UNPACK_SEQUENCE_TWO_TUPLE ||
+            (next_opcode == UNPACK_SEQUENCE && _Py_OPARG(instr[1]) == 2))
+        {
+            *instr = _Py_MAKECODEUNIT(FOR_ITER_DICT_ITEMS, _Py_OPARG(*instr));
+            goto success;
+        }
+        SPECIALIZATION_FAIL(FOR_ITER, SPEC_FAIL_FOR_ITER_DICT_ITEMS);
+        goto failure;
+    }
+    SPECIALIZATION_FAIL(FOR_ITER, for_iter_fail_kind(tp));
+failure:
+    STAT_INC(FOR_ITER, specialization_failure);
+    cache_backoff(adaptive);
+    return;
+success:
+    STAT_INC(FOR_ITER, specialization_success);
+    adaptive->counter = initial_counter_value();
+}
+
+static int
+unpack_sequence_fail_kind(PyObject *seq)
+{
+    if (PySequence_Check(seq)) {
+        return SPEC_FAIL_UNPACK_SEQUENCE_SEQUENCE;
+    }
+    if (PyIter_Check(seq)) {
+        return SPEC_FAIL_UNPACK_SEQUENCE_ITERATOR;
+    }
+    return SPEC_FAIL_OTHER;
+}
+
+void
+_Py_Specialize_UnpackSequence(PyObject *seq, _Py_CODEUNIT *instr,
+                              SpecializedCacheEntry *cache)
+{
+    _PyAdaptiveEntry *adaptive = &cache->adaptive;
+    if (PyTuple_CheckExact(seq)) {
+        if (PyTuple_GET_SIZE(seq) != adaptive->original_oparg) {
+            SPECIALIZATION_FAIL(UNPACK_SEQUENCE, SPEC_FAIL_EXPECTED_ERROR);
+            goto failure;
+        }
+        if (PyTuple_GET_SIZE(seq) == 2) {
+            *instr = _Py_MAKECODEUNIT(UNPACK_SEQUENCE_TWO_TUPLE,
+                                      _Py_OPARG(*instr));
+            goto success;
+        }
+        *instr = _Py_MAKECODEUNIT(UNPACK_SEQUENCE_TUPLE, _Py_OPARG(*instr));
+        goto success;
+    }
+    if (PyList_CheckExact(seq)) {
+        if (PyList_GET_SIZE(seq) != adaptive->original_oparg) {
+            SPECIALIZATION_FAIL(UNPACK_SEQUENCE, SPEC_FAIL_EXPECTED_ERROR);
+            goto failure;
+        }
+        *instr = _Py_MAKECODEUNIT(UNPACK_SEQUENCE_LIST, _Py_OPARG(*instr));
+        goto success;
+    }
+    SPECIALIZATION_FAIL(UNPACK_SEQUENCE, unpack_sequence_fail_kind(seq));
+failure:
+    STAT_INC(UNPACK_SEQUENCE, specialization_failure);
+    cache_backoff(adaptive);
+    return;
+success:
+    STAT_INC(UNPACK_SEQUENCE, specialization_success);
+    adaptive->counter = initial_counter_value();
+}
@@ -1160,6 +1160,107 @@ sys_getswitchinterval_impl(PyObject *module)
     return 1e-6 * _PyEval_GetSwitchInterval();
 }
 
+/*[clinic input]
+sys._setswitchpolicy
+
+    policy: str
+    /
+
+Set the policy used to hand the GIL over between threads.
+
+"interval" (the default): a thread waiting for the GIL asks the thread
+holding it to release it after the switch interval has elapsed.
+
+"io": a thread coming back from a blocking call (I/O, sleep, lock, etc.)
+asks for the GIL at once and takes it before other waiting threads.
+This lowers the latency of I/O-bound threads sharing the interpreter
+with CPU-bound threads.
+[clinic start generated code]*/
+
+static PyObject *
+sys__setswitchpolicy_impl(PyObject *module, const char *policy)
+/*[clinic end generated code: output=cde7421f8214caf2 input=923454bafc4d5b67]*/
+{
+    if (strcmp(policy, "interval") == 0) {
+        _PyEval_SetSwitchPolicy(_Py_GIL_POLICY_INTERVAL);
+    }
+    else if (strcmp(policy, "io") == 0) {
+        _PyEval_SetSwitchPolicy(_Py_GIL_POLICY_IO);
+    }
+    else {
+        PyErr_Format(PyExc_ValueError,
+                     "unknown switch policy '%s', expected 'interval' or 'io'",
+                     policy);
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+
+/*[clinic input]
+sys._getswitchpolicy
+
+Return the current GIL switch policy; see sys._setswitchpolicy().
+[clinic start generated code]*/
+
+static PyObject *
+sys__getswitchpolicy_impl(PyObject *module)
+/*[clinic end generated code: output=97c67d197b6c4d95 input=a93eefc23026139f]*/
+{
+    if (_PyEval_GetSwitchPolicy() == _Py_GIL_POLICY_IO) {
+        return PyUnicode_FromString("io");
+    }
+    return PyUnicode_FromString("interval");
+}
+
+
+/*[clinic input]
+sys._getgilwaittime -> double
+
+Return the time in seconds the current thread spent waiting for the GIL.
+[clinic start generated code]*/
+
+static double
+sys__getgilwaittime_impl(PyObject *module)
+/*[clinic end generated code: output=0f03d65993c5acce input=7438ab27ac668b5a]*/
+{
+    PyThreadState *tstate = _PyThreadState_GET();
+    return _PyTime_AsSecondsDouble(tstate->gil_wait_time);
+}
+
+
+/*[clinic input]
+sys._getgilstats
+
+Return a dict of statistics about the contention of the GIL.
+
+Times are in seconds and counts since the start of the process:
+
+switches: number of times the GIL passed from one thread to another.
+contended: number of times a thread had to wait to take the GIL.
+timeout_requests: number of times a waiting thread asked the holder
+  to drop the GIL after the switch interval elapsed.
+priority_requests: same, by a thread returning from a blocking call
+  with the "io" switch policy.
+forced_drops: number of times the GIL was dropped on request.
+voluntary_drops: number of times the GIL was dropped by a thread
+  entering a blocking call or exiting.
+wait_time, hold_time: total time threads spent waiting for and holding
+  the GIL.
+wait_histogram: tuple of counts of waits shorter than 1 microsecond,
+  then in [2**(i-1), 2**i) microseconds; the last one counts longer
+  waits.
+thread: dict of the wait_time, hold_time and forced_drops of the
+  current thread.
+[clinic start generated code]*/
+
+static PyObject *
+sys__getgilstats_impl(PyObject *module)
+/*[clinic end generated code: output=6cfe4e3b51e0e160 input=568853bba8c4b231]*/
+{
+    return _PyEval_GetGILStats(_PyThreadState_GET());
+}
+
 /*[clinic input]
 sys.setrecursionlimit
 
@@ -1769,6 +1870,46 @@ sys__getquickenedcount_impl(PyObject *module)
     return _Py_QuickenedCount;
 }
 
+/*[clinic input]
+sys._setdxpsampling -> int
+
+    interval: int
+    /
+
+Sample the execution profile every interval instructions.
+
+Every interval-th instruction executed by the current interpreter is
+recorded as its code object, the opcode of the instruction executed
+before it in the same frame, and its own opcode. Specialized instructions
+are recorded as themselves. An interval of 0 disables sampling.
+
+Return the previous interval.
+[clinic start generated code]*/
+
+static int
+sys__setdxpsampling_impl(PyObject *module, int interval)
+/*[clinic end generated code: output=a347af2fc3e4bb55 input=b23afdfaecb42586]*/
+{
+    return _PyEval_SetDXPSampling(interval);
+}
+
+/*[clinic input]
+sys._getdxpsamples
+
+Return and clear the execution profile samples.
+
+Return a list of (code, previous opcode, opcode) tuples, oldest first.
+Sampling pauses once the buffer of samples is full and resumes when it
+is drained, so this should be called regularly while sampling.
+[clinic start generated code]*/
+
+static PyObject *
+sys__getdxpsamples_impl(PyObject *module)
+/*[clinic end generated code: output=c68310b0118ae277 input=f038719d90ecd3fb]*/
+{
+    return _PyEval_GetDXPSamples();
+}
+
 /*[clinic input]
 sys.getallocatedblocks -> Py_ssize_t
 
@@ -1902,6 +2043,92 @@ sys__debugmallocstats_impl(PyObject *module)
     Py_RETURN_NONE;
 }
 
+/*[clinic input]
+sys._obmalloc_stats
+
+Return a dict describing the occupancy of pymalloc's structures.
+
+The dict has these keys:
+
+  size_classes -- a list of dicts, one per size class with pools,
+    holding the class index, its block size, and the number of pools,
+    full pools, blocks in use and free blocks;
+  arena_usage -- a list whose item k is the number of arenas with k
+    pools in use, which shows how fragmented the arenas are;
+  arenas, arenas_allocated_total, arenas_reclaimed, arenas_highwater
+    -- arena counts;
+  free_pools -- pools that are not in use, in any arena;
+  trimmed_pools -- free pools whose memory was handed back to the OS,
+    see _obmalloc_trim();
+  trim_interval -- see _set_obmalloc_trim_interval();
+  allocated_bytes, available_bytes, free_pool_bytes, pool_header_bytes,
+    quantization_bytes, arena_alignment_bytes -- how the bytes of all
+    arenas are used, adding up to arenas * arena_size;
+  arena_map_mid_nodes, arena_map_bot_nodes, arena_map_bytes -- the
+    size of the radix tree mapping addresses to arenas, if it is used;
+  arena_size, pool_size, small_block_threshold -- constants.
+
+Return None if pymalloc is not in use.
+[clinic start generated code]*/
+
+static PyObject *
+sys__obmalloc_stats_impl(PyObject *module)
+/*[clinic end generated code: output=ad05fe3e93fbf945 input=1774dee650e48595]*/
+{
+#ifdef WITH_PYMALLOC
+    return _PyObject_GetMallocStats();
+#else
+    Py_RETURN_NONE;
+#endif
+}
+
+/*[clinic input]
+sys._obmalloc_trim
+
+Hand the memory of pymalloc's empty pools and arenas back to the OS.
+
+The pages of empty pools in arenas which are still in use are discarded,
+and arenas all of whose pools are empty are released.
+[clinic start generated code]*/
+
+static PyObject *
+sys__obmalloc_trim_impl(PyObject *module)
+/*[clinic end generated code: output=60f5ac90e7664fe1 input=8039a22067719710]*/
+{
+#ifdef WITH_PYMALLOC
+    _PyObject_TrimMalloc();
+#endif
+    Py_RETURN_NONE;
+}
+
+/*[clinic input]
+sys._set_obmalloc_trim_interval -> Py_ssize_t
+
+    interval: Py_ssize_t
+    /
+
+Trim pymalloc's empty pools every interval times a pool becomes empty.
+
+Only the pools and arenas which stayed empty since the previous time are
+handed back to the OS.  0 disables automatic trimming.  Return the
+previous interval.
+[clinic start generated code]*/
+
+static Py_ssize_t
+sys__set_obmalloc_trim_interval_impl(PyObject *module, Py_ssize_t interval)
+/*[clinic end generated code: output=10db9990671583e8 input=269a10f9da83cc12]*/
+{
+    if (interval < 0) {
+        PyErr_SetString(PyExc_ValueError, "interval must be >= 0");
+        return -1;
+    }
+#ifdef WITH_PYMALLOC
+    return _PyObject_SetMallocTrimInterval(interval);
+#else
+    return 0;
+#endif
+}
+
 #ifdef Py_TRACE_REFS
 /* Defined in objects.c because it uses static globals in that file */
 extern PyObject *_Py_GetObjects(PyObject *, PyObject *);
@@ -1981,6 +2208,7 @@ static PyMethodDef sys_methods[] = {
     SYS_GETFILESYSTEMENCODING_METHODDEF
     SYS_GETFILESYSTEMENCODEERRORS_METHODDEF
     SYS__GETQUICKENEDCOUNT_METHODDEF
+    SYS__GETDXPSAMPLES_METHODDEF
 #ifdef Py_TRACE_REFS
     {"getobjects",      _Py_GetObjects, METH_VARARGS},
 #endif
@@ -1996,7 +2224,12 @@ static PyMethodDef sys_methods[] = {
     SYS_IS_FINALIZING_METHODDEF
     SYS_MDEBUG_METHODDEF
     SYS_SETSWITCHINTERVAL_METHODDEF
+    SYS__SETDXPSAMPLING_METHODDEF
     SYS_GETSWITCHINTERVAL_METHODDEF
+    SYS__SETSWITCHPOLICY_METHODDEF
+    SYS__GETSWITCHPOLICY_METHODDEF
+    SYS__GETGILWAITTIME_METHODDEF
+    SYS__GETGILSTATS_METHODDEF
     SYS_SETDLOPENFLAGS_METHODDEF
     {"setprofile",      sys_setprofile, METH_O, setprofile_doc},
     SYS_GETPROFILE_METHODDEF
@@ -2005,6 +2238,9 @@ static PyMethodDef sys_methods[] = {
     SYS_GETTRACE_METHODDEF
     SYS_CALL_TRACING_METHODDEF
     SYS__DEBUGMALLOCSTATS_METHODDEF
+    SYS__OBMALLOC_STATS_METHODDEF
+    SYS__OBMALLOC_TRIM_METHODDEF
+    SYS__SET_OBMALLOC_TRIM_INTERVAL_METHODDEF
     SYS_SET_COROUTINE_ORIGIN_TRACKING_DEPTH_METHODDEF
     SYS_GET_COROUTINE_ORIGIN_TRACKING_DEPTH_METHODDEF
     {"set_asyncgen_hooks", (PyCFunction)(void(*)(void))sys_set_asyncgen_hooks,
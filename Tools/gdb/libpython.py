@@ -803,10 +803,19 @@ def _get_entries(keys):
             offset = 4 * dk_size
         else:
             offset = 8 * dk_size
+        try:
+            # >= Python 3.11: control bytes of grouped tables
+            offset += int(keys['dk_grouped']) * dk_size
+        except RuntimeError:
+            pass
 
         ent_addr = keys['dk_indices'].address
         ent_addr = ent_addr.cast(_type_unsigned_char_ptr()) + offset
-        ent_ptr_t = gdb.lookup_type('PyDictKeyEntry').pointer()
+        if int(keys['dk_kind']) == 3:
+            # >= Python 3.11: DICT_KEYS_COMPACT
+            ent_ptr_t = gdb.lookup_type('PyDictCompactEntry').pointer()
+        else:
+            ent_ptr_t = gdb.lookup_type('PyDictKeyEntry').pointer()
         ent_addr = ent_addr.cast(ent_ptr_t)
 
         return ent_addr, dk_nentries
@@ -1,16 +1,29 @@
 """
-Some helper functions to analyze the output of sys.getdxp() (which is
-only available if Python was built with -DDYNAMIC_EXECUTION_PROFILE).
-These will tell you which opcodes have been executed most frequently
-in the current process, and, if Python was also built with -DDXPAIRS,
-will tell you which instruction _pairs_ were executed most frequently,
-which may help in choosing new instructions.
+Some helper functions to analyze the dynamic execution profile of the
+interpreter. These will tell you which opcodes have been executed most
+frequently in the current process, and which instruction _pairs_ were
+executed most frequently, which may help in choosing new instructions.
 
-If Python was built without -DDYNAMIC_EXECUTION_PROFILE, importing
-this module will raise a RuntimeError.
+There are two sources of profiles:
 
-If you're running a script you want to profile, a simple way to get
-the common pairs is:
+* Sampling, available in every build (see sys._setdxpsampling()).
+  Every N-th instruction is recorded together with the instruction
+  executed before it and its code object, so profiles can also be
+  broken down per code object. Specialized instructions are recorded
+  as themselves. Sampling can be switched on and off in a running
+  process, for example from a signal handler installed by
+  install_signal_handler().
+
+* sys.getdxp(), which counts every instruction but is only available
+  if Python was built with -DDYNAMIC_EXECUTION_PROFILE. Pairs are only
+  counted if Python was also built with -DDXPAIRS.
+
+To sample a script and print a report at exit:
+
+$ ./python Tools/scripts/analyze_dxp.py [-i INTERVAL] the_script.py --args
+
+If you're running a script you want to profile with sys.getdxp(), a
+simple way to get the common pairs is:
 
 $ PYTHONPATH=$PYTHONPATH:<python_srcdir>/Tools/scripts \
 ./python -i -O the_script.py --args
@@ -20,19 +33,41 @@
 > open('/tmp/some_file', 'w').write(s)
 """
 
+import collections
 import copy
 import opcode
 import operator
 import sys
 import threading
 
-if not hasattr(sys, "getdxp"):
-    raise RuntimeError("Can't import analyze_dxp: Python built without"
-                       " -DDYNAMIC_EXECUTION_PROFILE.")
+
+def _make_opnames():
+    # Specialized instructions are numbered like
+    # Tools/scripts/generate_opcode_h.py does.
+    names = list(opcode.opname)
+    used = set(opcode.opmap.values())
+    next_op = 1
+    for name in getattr(opcode, "_specialized_instructions", ()):
+        while next_op in used:
+            next_op += 1
+        names[next_op] = name
+        used.add(next_op)
+    return names
+
+opnames = _make_opnames()
 
 
 _profile_lock = threading.RLock()
-_cumulative_profile = sys.getdxp()
+if hasattr(sys, "getdxp"):
+    _cumulative_profile = sys.getdxp()
+else:
+    _cumulative_profile = None
+
+
+def _check_getdxp():
+    if _cumulative_profile is None:
+        raise RuntimeError("sys.getdxp() is not available: Python built"
+                           " without -DDYNAMIC_EXECUTION_PROFILE.")
 
 # If Python was built with -DDXPAIRS, sys.getdxp() returns a list of
 # lists of ints.  Otherwise it returns just a list of ints.
@@ -45,6 +80,7 @@ def has_pairs(profile):
 
 def reset_profile():
     """Forgets any execution profile that has been gathered so far."""
+    _check_getdxp()
     with _profile_lock:
         sys.getdxp()  # Resets the internal profile
         global _cumulative_profile
@@ -56,6 +92,7 @@ def merge_profile():
 
     We need this because sys.getdxp() 0s itself every time it's called."""
 
+    _check_getdxp()
     with _profile_lock:
         new_profile = sys.getdxp()
         if has_pairs(new_profile):
@@ -86,7 +123,7 @@ def common_instructions(profile):
         inst_list = profile[-1]
     else:
         inst_list = profile
-    result = [(op, opcode.opname[op], count)
+    result = [(op, opnames[op], count)
               for op, count in enumerate(inst_list)
               if count > 0]
     result.sort(key=operator.itemgetter(2), reverse=True)
@@ -104,7 +141,7 @@ def common_pairs(profile):
     """
     if not has_pairs(profile):
         return []
-    result = [((op1, op2), (opcode.opname[op1], opcode.opname[op2]), count)
+    result = [((op1, op2), (opnames[op1], opnames[op2]), count)
               # Drop the row of single-op profiles with [:-1]
               for op1, op1profile in enumerate(profile[:-1])
               for op2, count in enumerate(op1profile)
@@ -127,3 +164,214 @@ def seq():
         for _, ops, count in common_pairs(profile):
             yield "%s: %s\n" % (count, ops)
     return ''.join(seq())
+
+
+# Sampling
+
+DEFAULT_SAMPLE_INTERVAL = 1009   # A prime, to avoid aliasing with loops
+DEFAULT_DRAIN_INTERVAL = 0.5     # Seconds between reads of the samples
+
+# Maps code objects to Counters of (previous opcode, opcode) pairs
+_sampled_profile = {}
+_drain_thread = None
+_drain_stop = None
+
+
+def merge_samples():
+    """Reads sys._getdxpsamples() and merges it into this module's
+    sampled profile.
+
+    The interpreter pauses sampling once its buffer of samples is full,
+    so this must be called regularly while sampling. start_sampling() does it from a
+    background thread."""
+
+    with _profile_lock:
+        for code, prev_op, op in sys._getdxpsamples():
+            counts = _sampled_profile.get(code)
+            if counts is None:
+                counts = _sampled_profile[code] = collections.Counter()
+            counts[prev_op, op] += 1
+
+
+def _drain(stop, drain_interval):
+    while not stop.wait(drain_interval):
+        merge_samples()
+
+
+def start_sampling(interval=DEFAULT_SAMPLE_INTERVAL,
+                   drain_interval=DEFAULT_DRAIN_INTERVAL):
+    """Starts recording every interval-th instruction executed.
+
+    Samples are merged into the sampled profile every drain_interval
+    seconds by a daemon thread."""
+
+    global _drain_thread, _drain_stop
+    with _profile_lock:
+        if interval <= 0:
+            raise ValueError("interval must be positive")
+        sys._setdxpsampling(interval)
+        if _drain_thread is None:
+            _drain_stop = threading.Event()
+            _drain_thread = threading.Thread(
+                target=_drain, args=(_drain_stop, drain_interval),
+                name="analyze_dxp", daemon=True)
+            _drain_thread.start()
+
+
+def stop_sampling():
+    """Stops sampling and merges the remaining samples."""
+    global _drain_thread, _drain_stop
+    with _profile_lock:
+        sys._setdxpsampling(0)
+        thread = _drain_thread
+        if thread is not None:
+            _drain_stop.set()
+            _drain_thread = _drain_stop = None
+    if thread is not None and thread is not threading.current_thread():
+        thread.join()
+    merge_samples()
+
+
+def reset_samples():
+    """Forgets any samples that have been gathered so far."""
+    with _profile_lock:
+        sys._getdxpsamples()
+        _sampled_profile.clear()
+
+
+def sampled_code_profile():
+    """Returns the sampled profile broken down by code object.
+
+    The result maps code objects to Counters of
+    (previous opcode, opcode) pairs."""
+
+    with _profile_lock:
+        merge_samples()
+        return {code: counts.copy()
+                for code, counts in _sampled_profile.items()}
+
+
+def sampled_profile(code_profile=None):
+    """Returns the sampled profile in the format of sys.getdxp() built
+    with -DDXPAIRS, so that it can be passed to common_instructions(),
+    common_pairs() and render_common_pairs()."""
+
+    if code_profile is None:
+        code_profile = sampled_code_profile()
+    profile = [[0] * 256 for _ in range(257)]
+    for counts in code_profile.values():
+        for (prev_op, op), count in counts.items():
+            profile[prev_op][op] += count
+            profile[256][op] += count
+    return profile
+
+
+def hot_code_objects(code_profile=None):
+    """Returns the code objects in order of descending number of samples.
+
+    The result is a list of tuples of the form
+      (code object, # of samples)
+
+    """
+    if code_profile is None:
+        code_profile = sampled_code_profile()
+    result = [(code, sum(counts.values()))
+              for code, counts in code_profile.items()]
+    result.sort(key=operator.itemgetter(1), reverse=True)
+    return result
+
+
+def _code_location(code):
+    return "%s (%s:%d)" % (code.co_qualname, code.co_filename,
+                           code.co_firstlineno)
+
+
+def render_sampled_profile(code_profile=None, limit=20):
+    """Renders a report of the sampled profile to a string: the most
+    common instructions and pairs, then the code objects with the most
+    samples and their most common instructions."""
+
+    if code_profile is None:
+        code_profile = sampled_code_profile()
+    profile = sampled_profile(code_profile)
+    total = sum(profile[256])
+    lines = ["%d samples" % total]
+    if not total:
+        return lines[0] + "\n"
+    lines.append("")
+    lines.append("Most common instructions:")
+    for _, name, count in common_instructions(profile)[:limit]:
+        lines.append("%8d %5.1f%%  %s" % (count, 100 * count / total, name))
+    lines.append("")
+    lines.append("Most common pairs:")
+    for _, names, count in common_pairs(profile)[:limit]:
+        lines.append("%8d %5.1f%%  %s -> %s" %
+                     ((count, 100 * count / total) + names))
+    lines.append("")
+    lines.append("Hottest code objects:")
+    for code, count in hot_code_objects(code_profile)[:limit]:
+        lines.append("%8d %5.1f%%  %s" %
+                     (count, 100 * count / total, _code_location(code)))
+        ops = collections.Counter()
+        for (_, op), op_count in code_profile[code].items():
+            ops[op] += op_count
+        for op, op_count in ops.most_common(3):
+            lines.append("%16d  %s" % (op_count, opnames[op]))
+    return "\n".join(lines) + "\n"
+
+
+def install_signal_handler(signum=None, interval=DEFAULT_SAMPLE_INTERVAL,
+                           file=None):
+    """Installs a handler that switches sampling on and off in a running
+    process. SIGUSR2 is used by default.
+
+    The first signal starts sampling. The next one stops it, writes
+    render_sampled_profile() to file (sys.stderr by default) and
+    forgets the samples."""
+
+    import signal
+    if signum is None:
+        signum = signal.SIGUSR2
+
+    def handler(signum, frame):
+        if _drain_thread is None:
+            start_sampling(interval)
+            return
+        stop_sampling()
+        out = file if file is not None else sys.stderr
+        out.write(render_sampled_profile())
+        out.flush()
+        reset_samples()
+
+    return signal.signal(signum, handler)
+
+
+def main(args=None):
+    import argparse
+    import runpy
+
+    parser = argparse.ArgumentParser(
+        description="Run a script and report its sampled dynamic"
+                    " execution profile.")
+    parser.add_argument("-i", "--interval", type=int,
+                        default=DEFAULT_SAMPLE_INTERVAL,
+                        help="sample every INTERVAL instructions"
+                             " (default: %(default)s)")
+    parser.add_argument("-n", "--limit", type=int, default=20,
+                        help="number of entries in each section"
+                             " (default: %(default)s)")
+    parser.add_argument("script")
+    parser.add_argument("args", nargs=argparse.REMAINDER)
+    ns = parser.parse_args(args)
+
+    sys.argv = [ns.script] + ns.args
+    start_sampling(ns.interval)
+    try:
+        runpy.run_path(ns.script, run_name="__main__")
+    finally:
+        stop_sampling()
+        sys.stderr.write(render_sampled_profile(limit=ns.limit))
+
+
+if __name__ == "__main__":
+    main()
@@ -40,6 +40,8 @@ def main():
     stats = collections.defaultdict(collections.Counter)
     for filename in os.listdir(DEFAULT_DIR):
         for line in open(os.path.join(DEFAULT_DIR, filename)):
+            if line.lstrip().startswith("hotspot"):
+                continue
             key, value = line.split(":")
             key = key.strip()
             family, stat = key.split(".")